@@ -0,0 +1,34 @@
+#include <benchmark/benchmark.h>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "csvio/csvio.hpp"
+
+static void BM_SyncWrite(benchmark::State& state) {
+  std::ofstream outfile("data/CSV_WRITER_BENCHMARK_003.csv");
+  csvio::util::CSVLineWriter csv_line_writer(outfile);
+  csvio::CSVWriter<std::vector> csv_writer(csv_line_writer);
+
+  for (auto _ : state) {
+    csv_writer.write(std::vector<std::string>{"sometext", "sometext", "sometext", "sometext"});
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_AsyncWrite(benchmark::State& state) {
+  std::ofstream outfile("data/CSV_WRITER_BENCHMARK_004.csv");
+  csvio::util::CSVLineWriter csv_line_writer(outfile);
+  csvio::CSVAsyncWriter<std::vector> csv_writer(csv_line_writer, ',', true, "\r\n",
+                                                csvio::util::GROW);
+
+  for (auto _ : state) {
+    csv_writer.write(std::vector<std::string>{"sometext", "sometext", "sometext", "sometext"});
+  }
+  csv_writer.close();
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_SyncWrite);
+BENCHMARK(BM_AsyncWrite);
+
+BENCHMARK_MAIN();
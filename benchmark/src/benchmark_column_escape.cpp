@@ -0,0 +1,43 @@
+#include <benchmark/benchmark.h>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "csvio/csvio.hpp"
+
+static std::vector<std::vector<std::string>> make_rows(std::size_t rows) {
+  std::vector<std::vector<std::string>> out;
+  out.reserve(rows);
+  for (std::size_t i = 0; i < rows; i++) {
+    out.push_back({std::to_string(i), std::to_string(1000000 + i * 7), std::to_string(i % 977),
+                   std::to_string(static_cast<double>(i) * 0.25),
+                   "description " + std::to_string(i)});
+  }
+  return out;
+}
+
+static void write_rows(benchmark::State& state, std::vector<csvio::util::EscapePolicy> policy) {
+  const auto rows = make_rows(static_cast<std::size_t>(state.range(0)));
+  for (auto _ : state) {
+    std::ostringstream outstream;
+    csvio::util::CSVBufferedLineWriter csv_line_writer(outstream);
+    csvio::CSVWriter<std::vector, csvio::util::CSVBufferedLineWriter> csv_writer(
+        csv_line_writer);
+    csv_writer.set_column_escape(policy);
+    csv_writer.write_batch(rows);
+    csv_line_writer.flush();
+    benchmark::DoNotOptimize(outstream.str().size());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_WriteScanAllColumns(benchmark::State& state) { write_rows(state, {}); }
+
+static void BM_WriteTrustedNumericColumns(benchmark::State& state) {
+  using csvio::util::NEVER;
+  write_rows(state, {NEVER, NEVER, NEVER, NEVER, csvio::util::SCAN});
+}
+
+BENCHMARK(BM_WriteScanAllColumns)->Arg(100000);
+BENCHMARK(BM_WriteTrustedNumericColumns)->Arg(100000);
+
+BENCHMARK_MAIN();
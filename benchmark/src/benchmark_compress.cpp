@@ -0,0 +1,39 @@
+#include <benchmark/benchmark.h>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "csvio/compress.hpp"
+#include "csvio/csvio.hpp"
+
+using BgzfLineWriter = csvio::util::BasicCSVBufferedLineWriter<
+    csvio::util::BgzfByteSink<csvio::util::OStreamByteSink>>;
+
+static void BM_WriteUncompressed(benchmark::State& state) {
+  for (auto _ : state) {
+    std::ofstream outfile("data/CSV_WRITER_BENCHMARK_007.csv");
+    csvio::util::CSVBufferedLineWriter csv_line_writer(outfile);
+    csvio::CSVWriter<std::vector, csvio::util::CSVBufferedLineWriter> csv_writer(csv_line_writer);
+    for (int i = 0; i < 200000; i++) {
+      csv_writer.write({std::to_string(i), "sometext", "some,text", std::to_string(i % 977)});
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * 200000);
+}
+
+static void BM_WriteBgzf(benchmark::State& state) {
+  for (auto _ : state) {
+    std::ofstream outfile("data/CSV_WRITER_BENCHMARK_007.csv.gz");
+    BgzfLineWriter csv_line_writer(csvio::util::OStreamByteSink(outfile), 6,
+                                   static_cast<unsigned>(state.range(0)));
+    csvio::CSVWriter<std::vector, BgzfLineWriter> csv_writer(csv_line_writer);
+    for (int i = 0; i < 200000; i++) {
+      csv_writer.write({std::to_string(i), "sometext", "some,text", std::to_string(i % 977)});
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * 200000);
+}
+
+BENCHMARK(BM_WriteUncompressed)->UseRealTime();
+BENCHMARK(BM_WriteBgzf)->Arg(1)->Arg(2)->Arg(4)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,36 @@
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include "csvio/logger.hpp"
+
+int main() {
+  const std::string name{"benchmark_csv_logger"};
+  const std::size_t count = 1000000;
+
+  std::ofstream outfile("./data/CSV_LOGGER_BENCHMARK_001.csv");
+  csvio::util::CSVLineWriter csv_line_writer(outfile);
+  csvio::CSVLogger logger(csv_line_writer, csvio::LOG_DEBUG, csvio::util::GROW, 1 << 16);
+
+  std::vector<std::int64_t> latencies;
+  latencies.reserve(count);
+  for (std::size_t i = 0; i < count; i++) {
+    auto t1 = std::chrono::steady_clock::now();
+    logger.info("order_gateway") << "order accepted id=" << i << " px=" << 101.25;
+    auto t2 = std::chrono::steady_clock::now();
+    latencies.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count());
+  }
+  logger.close();
+
+  std::sort(latencies.begin(), latencies.end());
+  auto percentile = [&](double p) {
+    return latencies[static_cast<std::size_t>(p * static_cast<double>(count - 1))];
+  };
+
+  std::cout << name << '\n'
+            << "Messages           : " << count << '\n'
+            << "p50(nanos)         : " << percentile(0.50) << '\n'
+            << "p99(nanos)         : " << percentile(0.99) << '\n'
+            << "p99.9(nanos)       : " << percentile(0.999) << '\n';
+}
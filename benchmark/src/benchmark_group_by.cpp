@@ -0,0 +1,70 @@
+#include <benchmark/benchmark.h>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include "csvio/group_by.hpp"
+
+static std::string make_input(std::size_t rows) {
+  std::mt19937 random(11);
+  std::string input{"id,store,price,name\n"};
+  for (std::size_t i = 0; i < rows; i++) {
+    const double price = static_cast<double>(random() % 100000) / 100.0;
+    input += std::to_string(i) + ",store " + std::to_string(random() % 5000) + "," +
+             std::to_string(price) + ",\"name, " + std::to_string(random() % 100) + "\"\n";
+  }
+  return input;
+}
+
+static void group_input(benchmark::State& state, unsigned threads) {
+  const auto input = make_input(static_cast<std::size_t>(state.range(0)));
+  for (auto _ : state) {
+    std::istringstream instream(input);
+    std::ostringstream outstream;
+    csvio::util::CSVLineReader csv_line_reader(instream);
+    csvio::util::CSVBufferedLineWriter csv_line_writer(outstream);
+    csvio::CSVGroupBy<csvio::util::CSVLineReader, csvio::util::CSVBufferedLineWriter> group_by(
+        csv_line_reader, csv_line_writer);
+    group_by.add_key("store");
+    group_by.add_aggregate(csvio::COUNT, "");
+    group_by.add_aggregate(csvio::SUM, "price");
+    group_by.add_aggregate(csvio::MAX, "price");
+    group_by.add_aggregate(csvio::COUNT_DISTINCT, "name");
+    group_by.set_threads(threads);
+    group_by.run();
+    csv_line_writer.flush();
+    benchmark::DoNotOptimize(outstream.str().size());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_GroupBy(benchmark::State& state) { group_input(state, 1); }
+
+static void BM_GroupByThreads(benchmark::State& state) { group_input(state, 4); }
+
+static void BM_GroupByStdMap(benchmark::State& state) {
+  const auto input = make_input(static_cast<std::size_t>(state.range(0)));
+  for (auto _ : state) {
+    std::istringstream instream(input);
+    csvio::util::CSVLineReader csv_line_reader(instream);
+    csvio::CSVReader<> reader(csv_line_reader);
+    std::map<std::string, std::pair<std::size_t, double>> groups;
+    while (reader.good()) {
+      const auto& row = reader.read();
+      if (row.size() < 3) { continue; }
+      double price{0.0};
+      csvio::util::parse_field(row[2], price);
+      auto& group = groups[row[1]];
+      group.first++;
+      group.second += price;
+    }
+    benchmark::DoNotOptimize(groups.size());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_GroupBy)->Arg(200000);
+BENCHMARK(BM_GroupByThreads)->Arg(200000);
+BENCHMARK(BM_GroupByStdMap)->Arg(200000);
+
+BENCHMARK_MAIN();
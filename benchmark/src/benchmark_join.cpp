@@ -0,0 +1,82 @@
+#include <benchmark/benchmark.h>
+#include <random>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include "csvio/join.hpp"
+
+static std::string make_products(std::size_t rows) {
+  std::string input{"sku,name,price\n"};
+  for (std::size_t i = 0; i < rows; i++) {
+    input += "sku-" + std::to_string(i) + ",\"product, " + std::to_string(i) + "\"," +
+             std::to_string(i % 1000) + ".99\n";
+  }
+  return input;
+}
+
+static std::string make_sales(std::size_t rows, std::size_t products) {
+  std::mt19937 random(5);
+  std::string input{"id,sku,quantity\n"};
+  for (std::size_t i = 0; i < rows; i++) {
+    input += std::to_string(i) + ",sku-" + std::to_string(random() % (products + products / 10)) +
+             "," + std::to_string(random() % 10) + "\n";
+  }
+  return input;
+}
+
+static void BM_HashJoin(benchmark::State& state) {
+  const auto products = make_products(50000);
+  const auto sales = make_sales(static_cast<std::size_t>(state.range(0)), 50000);
+  for (auto _ : state) {
+    std::istringstream build_stream(products);
+    std::istringstream probe_stream(sales);
+    std::ostringstream outstream;
+    csvio::util::CSVLineReader build_reader(build_stream);
+    csvio::util::CSVLineReader probe_reader(probe_stream);
+    csvio::util::CSVBufferedLineWriter csv_line_writer(outstream);
+    csvio::CSVJoin<csvio::util::CSVLineReader, csvio::util::CSVBufferedLineWriter> join(
+        build_reader, probe_reader, csv_line_writer, csvio::LEFT);
+    join.add_key("sku");
+    join.run();
+    csv_line_writer.flush();
+    benchmark::DoNotOptimize(outstream.str().size());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_UnorderedMapJoin(benchmark::State& state) {
+  const auto products = make_products(50000);
+  const auto sales = make_sales(static_cast<std::size_t>(state.range(0)), 50000);
+  for (auto _ : state) {
+    std::istringstream build_stream(products);
+    std::istringstream probe_stream(sales);
+    std::ostringstream outstream;
+    csvio::util::CSVLineReader build_reader(build_stream);
+    csvio::util::CSVLineReader probe_reader(probe_stream);
+    csvio::util::CSVBufferedLineWriter csv_line_writer(outstream);
+    csvio::CSVReader<> build(build_reader, ',', true);
+    csvio::CSVReader<> probe(probe_reader, ',', true);
+    csvio::CSVWriter<std::vector, csvio::util::CSVBufferedLineWriter> writer(csv_line_writer);
+    std::unordered_map<std::string, std::vector<std::string>> table;
+    while (build.good()) {
+      const auto& row = build.read();
+      if (row.size() == 3) { table[row[0]] = row; }
+    }
+    while (probe.good()) {
+      auto row = probe.read();
+      if (row.size() != 3) { continue; }
+      const auto match = table.find(row[1]);
+      row.push_back(match == table.end() ? "" : match->second[1]);
+      row.push_back(match == table.end() ? "" : match->second[2]);
+      writer.write(row);
+    }
+    csv_line_writer.flush();
+    benchmark::DoNotOptimize(outstream.str().size());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_HashJoin)->Arg(500000);
+BENCHMARK(BM_UnorderedMapJoin)->Arg(500000);
+
+BENCHMARK_MAIN();
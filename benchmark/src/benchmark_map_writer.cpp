@@ -0,0 +1,62 @@
+#include <benchmark/benchmark.h>
+#include <map>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "csvio/csvio.hpp"
+
+static const std::vector<std::string> header{"id", "symbol", "side", "price", "quantity", "venue"};
+
+template <template <class...> class Map>
+static std::vector<Map<std::string, std::string>> make_rows(std::size_t count) {
+  std::vector<Map<std::string, std::string>> rows;
+  for (std::size_t i = 0; i < count; i++) {
+    rows.push_back({{"id", std::to_string(i)},
+                    {"symbol", "SYM" + std::to_string(i % 97)},
+                    {"side", i % 2 == 0 ? "BUY" : "SELL"},
+                    {"price", std::to_string(100 + i % 1000)},
+                    {"quantity", std::to_string(i % 500)},
+                    {"venue", "XNAS"}});
+  }
+  return rows;
+}
+
+template <template <class...> class Map>
+static void BM_ManualConversion(benchmark::State& state) {
+  const auto rows = make_rows<Map>(10000);
+  for (auto _ : state) {
+    std::ostringstream outstream;
+    csvio::util::CSVLineWriter csv_line_writer(outstream);
+    csvio::CSVWriter<std::vector> csv_writer(csv_line_writer);
+    csv_writer.write_header(header);
+    for (const auto& row : rows) {
+      std::vector<std::string> values;
+      values.reserve(header.size());
+      for (const auto& name : header) { values.push_back(row.at(name)); }
+      csv_writer.write(values);
+    }
+    benchmark::DoNotOptimize(outstream.str().size());
+  }
+  state.SetItemsProcessed(state.iterations() * 10000);
+}
+
+template <template <class...> class Map>
+static void BM_CSVMapWriter(benchmark::State& state) {
+  const auto rows = make_rows<Map>(10000);
+  for (auto _ : state) {
+    std::ostringstream outstream;
+    csvio::util::CSVLineWriter csv_line_writer(outstream);
+    csvio::CSVMapWriter<Map> csv_map_writer(csv_line_writer, header);
+    for (const auto& row : rows) { csv_map_writer.write(row); }
+    benchmark::DoNotOptimize(outstream.str().size());
+  }
+  state.SetItemsProcessed(state.iterations() * 10000);
+}
+
+BENCHMARK_TEMPLATE(BM_ManualConversion, std::map);
+BENCHMARK_TEMPLATE(BM_CSVMapWriter, std::map);
+BENCHMARK_TEMPLATE(BM_ManualConversion, std::unordered_map);
+BENCHMARK_TEMPLATE(BM_CSVMapWriter, std::unordered_map);
+
+BENCHMARK_MAIN();
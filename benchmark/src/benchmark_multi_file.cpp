@@ -0,0 +1,58 @@
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "csvio/multi_file.hpp"
+
+static std::vector<std::string> make_files(std::size_t files, std::size_t rows) {
+  std::vector<std::string> paths;
+  for (std::size_t f = 0; f < files; f++) {
+    paths.push_back("BENCH_MULTI_FILE_" + std::to_string(f) + ".csv");
+    std::ofstream file(paths.back(), std::ios::binary);
+    file << "id,name,amount\n";
+    for (std::size_t i = 0; i < rows; i++) {
+      file << i << ",\"name " << i << "\"," << i * 3 << ".5\n";
+    }
+  }
+  return paths;
+}
+
+static void remove_files(const std::vector<std::string>& paths) {
+  for (const auto& path : paths) { std::remove(path.c_str()); }
+}
+
+static void BM_MultiFileLineReader(benchmark::State& state) {
+  const auto paths = make_files(static_cast<std::size_t>(state.range(0)), 200);
+  for (auto _ : state) {
+    csvio::util::MultiFileLineReader csv_line_reader(paths);
+    csvio::CSVReader<std::vector, csvio::util::MultiFileLineReader> reader(csv_line_reader, ',',
+                                                                           true);
+    std::size_t rows{0};
+    while (reader.good()) { rows += reader.read().size(); }
+    benchmark::DoNotOptimize(rows);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0) * 200);
+  remove_files(paths);
+}
+
+static void BM_ReaderPerFile(benchmark::State& state) {
+  const auto paths = make_files(static_cast<std::size_t>(state.range(0)), 200);
+  for (auto _ : state) {
+    std::size_t rows{0};
+    for (const auto& path : paths) {
+      std::ifstream file(path);
+      csvio::util::CSVLineReader csv_line_reader(file);
+      csvio::CSVReader<> reader(csv_line_reader, ',', true);
+      while (reader.good()) { rows += reader.read().size(); }
+    }
+    benchmark::DoNotOptimize(rows);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0) * 200);
+  remove_files(paths);
+}
+
+BENCHMARK(BM_MultiFileLineReader)->Arg(500);
+BENCHMARK(BM_ReaderPerFile)->Arg(500);
+
+BENCHMARK_MAIN();
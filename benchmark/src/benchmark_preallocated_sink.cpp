@@ -0,0 +1,83 @@
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "csvio/csvio.hpp"
+
+static const char* const output_path = "benchmark_preallocated_sink.csv";
+
+static std::vector<std::vector<std::string>> make_rows(std::size_t rows) {
+  std::vector<std::vector<std::string>> out;
+  out.reserve(rows);
+  for (std::size_t i = 0; i < rows; i++) {
+    out.push_back({std::to_string(i), "2024-01-02 09:30:00", std::to_string(i * 31 % 100003),
+                   "some, text with a delimiter"});
+  }
+  return out;
+}
+
+static void BM_WriteOfstream(benchmark::State& state) {
+  const auto rows = make_rows(static_cast<std::size_t>(state.range(0)));
+  for (auto _ : state) {
+    std::ofstream outfile(output_path, std::ios::binary);
+    csvio::util::CSVLineWriter csv_line_writer(outfile);
+    csvio::CSVWriter<std::vector> csv_writer(csv_line_writer);
+    csv_writer.write_batch(rows);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  std::remove(output_path);
+}
+
+static void BM_WritePreallocated(benchmark::State& state) {
+  const auto rows = make_rows(static_cast<std::size_t>(state.range(0)));
+  using LineWriter = csvio::util::BasicCSVBufferedLineWriter<csvio::util::PreallocatedFileByteSink>;
+  for (auto _ : state) {
+    LineWriter csv_line_writer(output_path, rows.size() * 64);
+    csvio::CSVWriter<std::vector, LineWriter> csv_writer(csv_line_writer);
+    csv_writer.write_batch(rows);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  std::remove(output_path);
+}
+
+// every thread formats its own blocks and writes them at offsets claimed in block order
+static void BM_WritePreallocatedParallel(benchmark::State& state) {
+  const auto rows = make_rows(static_cast<std::size_t>(state.range(0)));
+  const std::size_t threads = std::max(2u, std::thread::hardware_concurrency());
+  const std::size_t block_rows = 4096;
+  const std::size_t blocks = (rows.size() + block_rows - 1) / block_rows;
+  for (auto _ : state) {
+    csvio::util::PreallocatedFileByteSink sink(output_path, rows.size() * 64);
+    std::atomic<std::size_t> next_block{0};
+    std::atomic<std::size_t> next_reserve{0};
+    auto format_blocks = [&] {
+      csvio::util::DelimJoinEscapedFormat<std::vector> formatter;
+      std::string data;
+      for (std::size_t block; (block = next_block.fetch_add(1)) < blocks;) {
+        data.clear();
+        const std::size_t end = std::min(rows.size(), (block + 1) * block_rows);
+        for (std::size_t row = block * block_rows; row < end; row++) {
+          data.append(formatter(rows[row], ',', "\r\n"));
+        }
+        while (next_reserve.load(std::memory_order_acquire) != block) { std::this_thread::yield(); }
+        const std::uint64_t offset = sink.reserve(data.size());
+        next_reserve.store(block + 1, std::memory_order_release);
+        sink.write_at(data.data(), data.size(), offset);
+      }
+    };
+    std::vector<std::thread> workers;
+    for (std::size_t i = 0; i < threads; i++) { workers.emplace_back(format_blocks); }
+    for (auto& worker : workers) { worker.join(); }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  std::remove(output_path);
+}
+
+BENCHMARK(BM_WriteOfstream)->Arg(200000);
+BENCHMARK(BM_WritePreallocated)->Arg(200000);
+BENCHMARK(BM_WritePreallocatedParallel)->Arg(200000)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,55 @@
+#include <benchmark/benchmark.h>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "csvio/csvio.hpp"
+
+static const int rows_per_thread = 100000;
+
+static void BM_MutexCSVWriter(benchmark::State& state) {
+  for (auto _ : state) {
+    std::ofstream outfile("data/CSV_WRITER_BENCHMARK_005.csv");
+    csvio::util::CSVLineWriter csv_line_writer(outfile);
+    csvio::CSVWriter<std::vector> csv_writer(csv_line_writer);
+    std::mutex mutex;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < state.range(0); t++) {
+      threads.emplace_back([&] {
+        std::vector<std::string> data{"sometext", "some,text", "sometext", "sometext"};
+        for (int i = 0; i < rows_per_thread; i++) {
+          std::lock_guard<std::mutex> lock(mutex);
+          csv_writer.write(data);
+        }
+      });
+    }
+    for (auto& thread : threads) { thread.join(); }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0) * rows_per_thread);
+}
+
+static void BM_CSVSharedWriter(benchmark::State& state) {
+  for (auto _ : state) {
+    std::ofstream outfile("data/CSV_WRITER_BENCHMARK_006.csv");
+    csvio::util::CSVLineWriter csv_line_writer(outfile);
+    csvio::CSVSharedWriter<std::vector> csv_writer(csv_line_writer);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < state.range(0); t++) {
+      threads.emplace_back([&] {
+        std::vector<std::string> data{"sometext", "some,text", "sometext", "sometext"};
+        auto local = csv_writer.local();
+        for (int i = 0; i < rows_per_thread; i++) { local.write(data); }
+      });
+    }
+    for (auto& thread : threads) { thread.join(); }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0) * rows_per_thread);
+}
+
+BENCHMARK(BM_MutexCSVWriter)->Arg(1)->Arg(2)->Arg(4)->UseRealTime();
+BENCHMARK(BM_CSVSharedWriter)->Arg(1)->Arg(2)->Arg(4)->UseRealTime();
+
+BENCHMARK_MAIN();
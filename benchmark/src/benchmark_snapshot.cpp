@@ -0,0 +1,71 @@
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include "csvio/snapshot.hpp"
+
+static const std::string csv_path{"BENCH_SNAPSHOT.csv"};
+static const std::string snapshot_path{"BENCH_SNAPSHOT.bin"};
+
+static void make_files(std::size_t rows) {
+  {
+    std::ofstream file(csv_path, std::ios::binary);
+    file << "id,name,city,amount\n";
+    for (std::size_t i = 0; i < rows; i++) {
+      file << i << ",\"name, " << i << "\",city " << i % 100 << "," << i * 7 << ".5\n";
+    }
+  }
+  std::ifstream file(csv_path, std::ios::binary);
+  csvio::util::CSVLineReader csv_line_reader(file);
+  csvio::write_snapshot(csv_line_reader, snapshot_path);
+}
+
+static void remove_files() {
+  std::remove(csv_path.c_str());
+  std::remove(snapshot_path.c_str());
+}
+
+static void BM_ParseCsv(benchmark::State& state) {
+  make_files(static_cast<std::size_t>(state.range(0)));
+  for (auto _ : state) {
+    std::ifstream file(csv_path, std::ios::binary);
+    csvio::util::CSVLineReader csv_line_reader(file);
+    csvio::CSVReader<> reader(csv_line_reader, ',', true);
+    std::size_t bytes{0};
+    while (reader.good()) {
+      for (const auto& field : reader.read()) { bytes += field.size(); }
+    }
+    benchmark::DoNotOptimize(bytes);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  remove_files();
+}
+
+static void BM_ReadSnapshot(benchmark::State& state) {
+  make_files(static_cast<std::size_t>(state.range(0)));
+  for (auto _ : state) {
+    csvio::CSVSnapshotReader reader(snapshot_path);
+    std::size_t bytes{0};
+    while (reader.good()) {
+      for (const auto field : reader.read()) { bytes += field.size(); }
+    }
+    benchmark::DoNotOptimize(bytes);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  remove_files();
+}
+
+static void BM_OpenSnapshot(benchmark::State& state) {
+  make_files(static_cast<std::size_t>(state.range(0)));
+  for (auto _ : state) {
+    csvio::CSVSnapshotReader reader(snapshot_path);
+    benchmark::DoNotOptimize(reader.row(reader.rows() - 1)[0].size());
+  }
+  remove_files();
+}
+
+BENCHMARK(BM_ParseCsv)->Arg(500000);
+BENCHMARK(BM_ReadSnapshot)->Arg(500000);
+BENCHMARK(BM_OpenSnapshot)->Arg(500000);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,50 @@
+#include <benchmark/benchmark.h>
+#include <random>
+#include <sstream>
+#include <string>
+#include "csvio/sort.hpp"
+
+static std::string make_input(std::size_t rows) {
+  std::mt19937 random(7);
+  std::string input{"id,price,name,date\n"};
+  for (std::size_t i = 0; i < rows; i++) {
+    const double price = static_cast<double>(random() % 100000) / 100.0;
+    input += std::to_string(random() % 1000000) + "," + std::to_string(price) + ",\"name, " +
+             std::to_string(i) + "\",2024-0" + std::to_string(1 + random() % 9) + "-1" +
+             std::to_string(random() % 10) + "\n";
+  }
+  return input;
+}
+
+static void sort_input(benchmark::State& state, std::size_t memory_limit) {
+  const auto input = make_input(static_cast<std::size_t>(state.range(0)));
+  std::size_t runs{0};
+  for (auto _ : state) {
+    std::istringstream instream(input);
+    std::ostringstream outstream;
+    csvio::util::CSVLineReader csv_line_reader(instream);
+    csvio::util::CSVBufferedLineWriter csv_line_writer(outstream);
+    csvio::CSVSorter<csvio::util::CSVLineReader, csvio::util::CSVBufferedLineWriter> sorter(
+        csv_line_reader, csv_line_writer);
+    sorter.add_key("date", csvio::DATE);
+    sorter.add_key("price", csvio::NUMERIC, true);
+    sorter.set_memory_limit(memory_limit);
+    sorter.run();
+    runs = sorter.spilled_runs();
+    csv_line_writer.flush();
+    benchmark::DoNotOptimize(outstream.str().size());
+  }
+  state.counters["runs"] = static_cast<double>(runs);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_SortInMemory(benchmark::State& state) {
+  sort_input(state, csvio::util::default_sort_memory);
+}
+
+static void BM_SortSpilled(benchmark::State& state) { sort_input(state, 1u << 20); }
+
+BENCHMARK(BM_SortInMemory)->Arg(200000);
+BENCHMARK(BM_SortSpilled)->Arg(200000);
+
+BENCHMARK_MAIN();
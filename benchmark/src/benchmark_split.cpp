@@ -0,0 +1,87 @@
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "csvio/split.hpp"
+
+static std::string make_input(std::size_t rows) {
+  std::mt19937 random(13);
+  std::string input{"id,customer,amount,note\n"};
+  for (std::size_t i = 0; i < rows; i++) {
+    input += std::to_string(i) + ",customer " + std::to_string(random() % 100000) + "," +
+             std::to_string(random() % 10000) + ".25,\"note, " + std::to_string(i) + "\"\n";
+  }
+  return input;
+}
+
+static constexpr std::size_t shard_count = 8;
+
+static void split_input(benchmark::State& state, csvio::SplitMode mode, unsigned threads) {
+  const auto input = make_input(static_cast<std::size_t>(state.range(0)));
+  for (auto _ : state) {
+    std::istringstream instream(input);
+    std::vector<std::unique_ptr<std::ostringstream>> streams;
+    csvio::util::CSVLineReader csv_line_reader(instream);
+    {
+      csvio::CSVSplitter<csvio::util::CSVLineReader, csvio::util::CSVBufferedLineWriter> splitter(
+          csv_line_reader,
+          [&streams](std::size_t) {
+            streams.push_back(std::make_unique<std::ostringstream>());
+            return std::make_unique<csvio::util::CSVBufferedLineWriter>(*streams.back());
+          },
+          mode, shard_count);
+      splitter.add_key("customer");
+      splitter.set_threads(threads);
+      splitter.run();
+    }
+    benchmark::DoNotOptimize(streams.back()->str().size());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_SplitHash(benchmark::State& state) { split_input(state, csvio::HASH, 1); }
+
+static void BM_SplitHashThreads(benchmark::State& state) { split_input(state, csvio::HASH, 4); }
+
+static void BM_SplitRoundRobin(benchmark::State& state) {
+  split_input(state, csvio::ROUND_ROBIN, 1);
+}
+
+static void BM_SplitReadWriteLoop(benchmark::State& state) {
+  const auto input = make_input(static_cast<std::size_t>(state.range(0)));
+  for (auto _ : state) {
+    std::istringstream instream(input);
+    std::vector<std::unique_ptr<std::ostringstream>> streams;
+    std::vector<std::unique_ptr<csvio::util::CSVBufferedLineWriter>> line_writers;
+    std::vector<std::unique_ptr<csvio::CSVWriter<std::vector, csvio::util::CSVBufferedLineWriter>>>
+        writers;
+    csvio::util::CSVLineReader csv_line_reader(instream);
+    csvio::CSVReader<> reader(csv_line_reader, ',', true);
+    for (std::size_t shard = 0; shard < shard_count; shard++) {
+      streams.push_back(std::make_unique<std::ostringstream>());
+      line_writers.push_back(std::make_unique<csvio::util::CSVBufferedLineWriter>(*streams.back()));
+      writers.push_back(
+          std::make_unique<csvio::CSVWriter<std::vector, csvio::util::CSVBufferedLineWriter>>(
+              *line_writers.back()));
+      writers.back()->write_header(reader.get_header_names());
+    }
+    while (reader.good()) {
+      const auto& row = reader.read();
+      if (row.size() != 4) { continue; }
+      writers[std::hash<std::string>{}(row[1]) % shard_count]->write(row);
+    }
+    writers.clear();
+    line_writers.clear();
+    benchmark::DoNotOptimize(streams.back()->str().size());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_SplitHash)->Arg(500000);
+BENCHMARK(BM_SplitHashThreads)->Arg(500000);
+BENCHMARK(BM_SplitRoundRobin)->Arg(500000);
+BENCHMARK(BM_SplitReadWriteLoop)->Arg(500000);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,97 @@
+#include <benchmark/benchmark.h>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "csvio/csvio.hpp"
+
+struct Trade {
+  long id{0};
+  std::string symbol;
+  double price{0.0};
+  int quantity{0};
+};
+
+template <>
+struct csvio::StructBinding<Trade> {
+  static constexpr auto columns =
+      std::make_tuple(csvio::column("id", &Trade::id), csvio::column("symbol", &Trade::symbol),
+                      csvio::column("price", &Trade::price),
+                      csvio::column("quantity", &Trade::quantity));
+};
+
+static std::vector<Trade> make_trades(long count) {
+  std::vector<Trade> trades;
+  for (long i = 0; i < count; i++) {
+    trades.push_back({i, "SYM" + std::to_string(i % 97), 100.0 + static_cast<double>(i) * 0.01,
+                      static_cast<int>(i % 1000)});
+  }
+  return trades;
+}
+
+static void BM_WriteStructs(benchmark::State& state) {
+  const auto trades = make_trades(state.range(0));
+  for (auto _ : state) {
+    std::ostringstream outstream;
+    csvio::util::CSVLineWriter csv_line_writer(outstream);
+    csvio::CSVWriter<std::vector> csv_writer(csv_line_writer);
+    csv_writer.write_structs(trades);
+    benchmark::DoNotOptimize(outstream.str().size());
+  }
+}
+
+static void BM_WriteStrings(benchmark::State& state) {
+  const auto trades = make_trades(state.range(0));
+  for (auto _ : state) {
+    std::ostringstream outstream;
+    csvio::util::CSVLineWriter csv_line_writer(outstream);
+    csvio::CSVWriter<std::vector> csv_writer(csv_line_writer);
+    for (const auto& trade : trades) {
+      csv_writer.write(std::vector<std::string>{std::to_string(trade.id), trade.symbol,
+                                                std::to_string(trade.price),
+                                                std::to_string(trade.quantity)});
+    }
+    benchmark::DoNotOptimize(outstream.str().size());
+  }
+}
+
+static void BM_ReadStructs(benchmark::State& state) {
+  std::ostringstream outstream;
+  csvio::util::CSVLineWriter csv_line_writer(outstream);
+  csvio::CSVWriter<std::vector> csv_writer(csv_line_writer);
+  csv_writer.write_structs(make_trades(state.range(0)));
+  const std::string data = outstream.str();
+
+  for (auto _ : state) {
+    std::istringstream instream(data);
+    csvio::util::CSVLineReader csv_line_reader(instream);
+    csvio::CSVReader<std::vector> csv_reader(csv_line_reader);
+    benchmark::DoNotOptimize(csv_reader.read_structs<Trade>());
+  }
+}
+
+static void BM_ReadStrings(benchmark::State& state) {
+  std::ostringstream outstream;
+  csvio::util::CSVLineWriter csv_line_writer(outstream);
+  csvio::CSVWriter<std::vector> csv_writer(csv_line_writer);
+  csv_writer.write_structs(make_trades(state.range(0)));
+  const std::string data = outstream.str();
+
+  for (auto _ : state) {
+    std::istringstream instream(data);
+    csvio::util::CSVLineReader csv_line_reader(instream);
+    csvio::CSVReader<std::vector> csv_reader(csv_line_reader);
+    std::vector<Trade> trades;
+    for (auto& row : csv_reader) {
+      if (row.size() < 4) { continue; }
+      trades.push_back({std::stol(row[0]), row[1], std::stod(row[2]), std::stoi(row[3])});
+    }
+    benchmark::DoNotOptimize(trades);
+  }
+}
+
+BENCHMARK(BM_WriteStructs)->RangeMultiplier(8)->Range(8, 8 << 10);
+BENCHMARK(BM_WriteStrings)->RangeMultiplier(8)->Range(8, 8 << 10);
+BENCHMARK(BM_ReadStructs)->RangeMultiplier(8)->Range(8, 8 << 10);
+BENCHMARK(BM_ReadStrings)->RangeMultiplier(8)->Range(8, 8 << 10);
+
+BENCHMARK_MAIN();
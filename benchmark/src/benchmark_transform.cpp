@@ -0,0 +1,61 @@
+#include <benchmark/benchmark.h>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "csvio/csvio.hpp"
+
+static std::string make_input(std::size_t rows) {
+  std::string input{"id,name,comment,price,qty\n"};
+  for (std::size_t i = 0; i < rows; i++) {
+    input += std::to_string(i) + ",\"Smith, J\",\"said \"\"ok\"\"\"," +
+             std::to_string(static_cast<double>(i) * 0.5) + "," + std::to_string(i % 100) + "\n";
+  }
+  return input;
+}
+
+static void BM_ReadWriteRoundTrip(benchmark::State& state) {
+  const auto input = make_input(static_cast<std::size_t>(state.range(0)));
+  for (auto _ : state) {
+    std::istringstream instream(input);
+    std::ostringstream outstream;
+    csvio::util::CSVLineReader csv_line_reader(instream);
+    csvio::util::CSVBufferedLineWriter csv_line_writer(outstream);
+    csvio::CSVReader<> csv_reader(csv_line_reader, ',', true);
+    csvio::CSVWriter<std::vector, csvio::util::CSVBufferedLineWriter> csv_writer(
+        csv_line_writer);
+    csv_writer.write_header({"price", "name", "comment", "id"});
+    while (csv_reader.good()) {
+      const auto& row = csv_reader.read();
+      if (row.size() < 5) { continue; }
+      csv_writer.write({row[3], row[1], row[2], row[0]});
+    }
+    csv_line_writer.flush();
+    benchmark::DoNotOptimize(outstream.str().size());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_Transform(benchmark::State& state) {
+  const auto input = make_input(static_cast<std::size_t>(state.range(0)));
+  for (auto _ : state) {
+    std::istringstream instream(input);
+    std::ostringstream outstream;
+    csvio::util::CSVLineReader csv_line_reader(instream);
+    csvio::util::CSVBufferedLineWriter csv_line_writer(outstream);
+    csvio::CSVTransform<csvio::util::CSVLineReader, csvio::util::CSVBufferedLineWriter> transform(
+        csv_line_reader, csv_line_writer);
+    transform.add_column("price");
+    transform.add_column("name");
+    transform.add_column("comment");
+    transform.add_column("id");
+    transform.run();
+    csv_line_writer.flush();
+    benchmark::DoNotOptimize(outstream.str().size());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_ReadWriteRoundTrip)->Arg(100000);
+BENCHMARK(BM_Transform)->Arg(100000);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,43 @@
+#include <benchmark/benchmark.h>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "csvio/csvio.hpp"
+
+static std::vector<std::vector<std::string>> make_rows(std::size_t count) {
+  std::vector<std::vector<std::string>> rows;
+  rows.reserve(count);
+  for (std::size_t i = 0; i < count; i++) {
+    rows.push_back({std::to_string(i), "sometext", "some,text", "some \"quoted\" text"});
+  }
+  return rows;
+}
+
+static void BM_WriteRowByRow(benchmark::State& state) {
+  const auto rows = make_rows(200000);
+  for (auto _ : state) {
+    std::ostringstream outstream;
+    csvio::util::CSVLineWriter csv_line_writer(outstream);
+    csvio::CSVWriter<std::vector> csv_writer(csv_line_writer);
+    for (const auto& row : rows) { csv_writer.write(row); }
+    benchmark::DoNotOptimize(outstream.str().size());
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(rows.size()));
+}
+
+static void BM_WriteAll(benchmark::State& state) {
+  const auto rows = make_rows(200000);
+  for (auto _ : state) {
+    std::ostringstream outstream;
+    csvio::util::CSVLineWriter csv_line_writer(outstream);
+    csvio::CSVWriter<std::vector> csv_writer(csv_line_writer);
+    csv_writer.write_all(rows, static_cast<unsigned>(state.range(0)));
+    benchmark::DoNotOptimize(outstream.str().size());
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(rows.size()));
+}
+
+BENCHMARK(BM_WriteRowByRow)->UseRealTime();
+BENCHMARK(BM_WriteAll)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime();
+
+BENCHMARK_MAIN();
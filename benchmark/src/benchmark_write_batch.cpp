@@ -0,0 +1,69 @@
+#include <benchmark/benchmark.h>
+#include <array>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "csvio/csvio.hpp"
+
+using ViewRow = std::array<std::string_view, 4>;
+
+static std::vector<ViewRow> make_rows(std::size_t rows) {
+  static const std::array<std::string_view, 4> symbols{"AAPL", "MSFT", "GOOG", "AMZN"};
+  std::vector<ViewRow> out;
+  out.reserve(rows);
+  for (std::size_t i = 0; i < rows; i++) {
+    out.push_back({symbols[i % 4], "101.25", "500", "2024-01-02 09:30:00"});
+  }
+  return out;
+}
+
+static void BM_WriteOwnedStrings(benchmark::State& state) {
+  const auto rows = make_rows(static_cast<std::size_t>(state.range(0)));
+  for (auto _ : state) {
+    std::ostringstream outstream;
+    csvio::util::CSVBufferedLineWriter csv_line_writer(outstream);
+    csvio::CSVWriter<std::vector, csvio::util::CSVBufferedLineWriter> csv_writer(
+        csv_line_writer);
+    for (const auto& row : rows) {
+      csv_writer.write(std::vector<std::string>(row.begin(), row.end()));
+    }
+    csv_line_writer.flush();
+    benchmark::DoNotOptimize(outstream.str().size());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_WriteViews(benchmark::State& state) {
+  const auto rows = make_rows(static_cast<std::size_t>(state.range(0)));
+  for (auto _ : state) {
+    std::ostringstream outstream;
+    csvio::util::CSVBufferedLineWriter csv_line_writer(outstream);
+    csvio::CSVWriter<std::vector, csvio::util::CSVBufferedLineWriter> csv_writer(
+        csv_line_writer);
+    for (const auto& row : rows) { csv_writer.write(row); }
+    csv_line_writer.flush();
+    benchmark::DoNotOptimize(outstream.str().size());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_WriteBatch(benchmark::State& state) {
+  const auto rows = make_rows(static_cast<std::size_t>(state.range(0)));
+  for (auto _ : state) {
+    std::ostringstream outstream;
+    csvio::util::CSVBufferedLineWriter csv_line_writer(outstream);
+    csvio::CSVWriter<std::vector, csvio::util::CSVBufferedLineWriter> csv_writer(
+        csv_line_writer);
+    csv_writer.write_batch(rows);
+    csv_line_writer.flush();
+    benchmark::DoNotOptimize(outstream.str().size());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_WriteOwnedStrings)->Arg(100000);
+BENCHMARK(BM_WriteViews)->Arg(100000);
+BENCHMARK(BM_WriteBatch)->Arg(100000);
+
+BENCHMARK_MAIN();
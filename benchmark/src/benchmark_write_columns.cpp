@@ -0,0 +1,61 @@
+#include <benchmark/benchmark.h>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "csvio/csvio.hpp"
+
+struct Table {
+  std::vector<long> ids;
+  std::vector<double> prices;
+  std::vector<int> quantities;
+  std::string symbols;
+  std::vector<std::uint32_t> symbol_offsets{0};
+};
+
+static Table make_table(std::size_t rows) {
+  Table table;
+  for (std::size_t i = 0; i < rows; i++) {
+    table.ids.push_back(static_cast<long>(i));
+    table.prices.push_back(100.0 + static_cast<double>(i % 1000) * 0.25);
+    table.quantities.push_back(static_cast<int>(i % 500));
+    table.symbols += "SYM" + std::to_string(i % 97);
+    table.symbol_offsets.push_back(static_cast<std::uint32_t>(table.symbols.size()));
+  }
+  return table;
+}
+
+static void BM_WriteTransposedRows(benchmark::State& state) {
+  const auto rows = static_cast<std::size_t>(state.range(0));
+  const auto table = make_table(rows);
+  const csvio::util::StringColumn<> symbols(table.symbols.data(), table.symbol_offsets.data());
+  for (auto _ : state) {
+    std::ostringstream outstream;
+    csvio::util::CSVLineWriter csv_line_writer(outstream);
+    csvio::CSVWriter<std::vector> csv_writer(csv_line_writer);
+    for (std::size_t i = 0; i < rows; i++) {
+      csv_writer.write({std::to_string(table.ids[i]), std::to_string(table.prices[i]),
+                        std::to_string(table.quantities[i]), std::string(symbols[i])});
+    }
+    benchmark::DoNotOptimize(outstream.str().size());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_WriteColumns(benchmark::State& state) {
+  const auto rows = static_cast<std::size_t>(state.range(0));
+  const auto table = make_table(rows);
+  const csvio::util::StringColumn<> symbols(table.symbols.data(), table.symbol_offsets.data());
+  for (auto _ : state) {
+    std::ostringstream outstream;
+    csvio::util::CSVLineWriter csv_line_writer(outstream);
+    csvio::CSVWriter<std::vector> csv_writer(csv_line_writer);
+    csv_writer.write_columns(rows, table.ids, table.prices, table.quantities, symbols);
+    benchmark::DoNotOptimize(outstream.str().size());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_WriteTransposedRows)->Arg(100000);
+BENCHMARK(BM_WriteColumns)->Arg(100000);
+
+BENCHMARK_MAIN();
@@ -15,8 +15,10 @@ class CSVIOConan(ConanFile):
     description = 'io for reading/writing csv to/from containers'
     topics = 'io', 'csv'
     settings = 'os', 'compiler', 'build_type', 'arch'
-    generators = 'CMakeDeps', 'CMakeToolchain'
+    generators = 'CMakeDeps'
     package_type = 'header-library'
+    options = {'with_zlib': [True, False], 'with_zstd': [True, False]}
+    default_options = {'with_zlib': False, 'with_zstd': False}
 
     def export_sources(self):
         copy(self, "LICENSE.md", self.recipe_folder, self.export_sources_folder)
@@ -28,6 +30,10 @@ class CSVIOConan(ConanFile):
 
     def requirements(self):
         self.requires('tl-expected/20190710', transitive_headers=True)
+        if self.options.with_zlib:
+            self.requires('zlib/1.3.1', transitive_headers=True)
+        if self.options.with_zstd:
+            self.requires('zstd/1.5.6', transitive_headers=True)
 
         self.test_requires('gtest/1.14.0')
 
@@ -36,6 +42,12 @@ class CSVIOConan(ConanFile):
     #         cmd = os.path.join(self.cpp.build.bindir, "test",  'unit_tests')
     #         self.run(cmd, env="conanrun")
 
+    def generate(self):
+        toolchain = CMakeToolchain(self)
+        toolchain.cache_variables['CSVIO_WITH_ZLIB'] = bool(self.options.with_zlib)
+        toolchain.cache_variables['CSVIO_WITH_ZSTD'] = bool(self.options.with_zstd)
+        toolchain.generate()
+
     def build(self):
         cmake = CMake(self)
         cmake.configure()
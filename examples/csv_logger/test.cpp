@@ -1,35 +1,29 @@
-#include "logger.hpp"
+#include <fstream>
 #include <iostream>
+#include "csvio/logger.hpp"
 
-void function_3(util::Logger& log) {
-  log.Debug() << "Hello 3!";
+using Logger = csvio::CSVLogger<csvio::util::RotatingFileLineWriter>;
+
+void function_3(Logger& log) {
+  CSVIO_LOG_DEBUG(log) << "Hello " << 3 << '!';
 }
 
-void function_2(util::Logger& log) {
-  log.Debug() << "Hello 2!";
+void function_2(Logger& log) {
+  CSVIO_LOG_DEBUG(log) << "Hello " << 2 << '!';
   function_3(log);
 }
 
-
-void function_1(util::Logger& log) {
-  log.Debug() << "Hello 1!";
+void function_1(Logger& log) {
+  CSVIO_LOG_DEBUG(log) << "Hello " << 1 << '!';
   function_2(log);
 }
 
+int main() {
+  // rotate log_test.csv every 10 MB, keeping log_test.csv.1 to log_test.csv.5
+  csvio::util::RotatingFileLineWriter log_file("log_test.csv", 10 << 20, 5);
+  Logger log(log_file);
 
-int main () {
-//  std::ofstream log_file("log_test.csv");
-//  util::Logger log(log_file);
-  util::Logger log(std::cout);
-
-
-/*
-  for (int i = 0; i < 1000000; i++) {
-    log.Debug()() << "Hello World!";
-  }
-*/
-
-  log.Debug() << "Hello World!";
+  CSVIO_LOG_INFO(log) << "Hello World!";
 
   function_1(log);
 }
@@ -0,0 +1,410 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Matthew Guidry
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef MGUID_CSV_IO_COMPRESS_HPP
+#define MGUID_CSV_IO_COMPRESS_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "csvio/csvio.hpp"
+
+#if defined(CSVIO_WITH_ZLIB)
+#include <zlib.h>
+#endif
+
+#if defined(CSVIO_WITH_ZSTD)
+#include <zstd.h>
+#endif
+
+namespace csvio {
+
+/** \internal */
+namespace util {
+
+#if defined(CSVIO_WITH_ZLIB)
+
+/** \class BgzfDeflater
+ *  \ingroup compress
+ *  \brief Compresses one BGZF block, a complete gzip member carrying its own size
+ *
+ *  The raw deflate stream is reused between blocks through deflateReset().
+ */
+class BgzfDeflater {
+public:
+  /** \brief largest number of input bytes in one block, its compressed form always fits 64 KiB */
+  static constexpr std::size_t max_input = 0xff00;
+  /** \brief largest size of a compressed block */
+  static constexpr std::size_t max_block = 0x10000;
+
+  /** \brief construct a deflater
+   *  \param level zlib compression level
+   */
+  explicit BgzfDeflater(int level) {
+    m_ok = deflateInit2(&m_stream, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+  }
+
+  BgzfDeflater(const BgzfDeflater&) = delete;
+  BgzfDeflater& operator=(const BgzfDeflater&) = delete;
+
+  ~BgzfDeflater() {
+    if (m_ok) { deflateEnd(&m_stream); }
+  }
+
+  /** \brief compress up to max_input bytes into a BGZF block
+   *  \param input bytes to compress
+   *  \param output receives the block
+   *  \return true on success
+   */
+  bool compress(string_view input, std::string& output) {
+    if (!m_ok || input.size() > max_input) { return false; }
+    output.resize(max_block);
+    auto* out = reinterpret_cast<unsigned char*>(&output[0]);
+
+    deflateReset(&m_stream);
+    m_stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+    m_stream.avail_in = static_cast<uInt>(input.size());
+    m_stream.next_out = out + header_size;
+    m_stream.avail_out = static_cast<uInt>(max_block - header_size - footer_size);
+    if (deflate(&m_stream, Z_FINISH) != Z_STREAM_END) { return false; }
+
+    const std::size_t size = header_size + m_stream.total_out + footer_size;
+    static constexpr unsigned char header[header_size - 2]{31,  139, 8, 4,  0,  0,  0, 0,
+                                                           0,   255, 6, 0, 'B', 'C', 2, 0};
+    std::memcpy(out, header, sizeof(header));
+    put_le(out + 16, size - 1, 2);
+    const auto crc = crc32(0L, reinterpret_cast<const Bytef*>(input.data()),
+                           static_cast<uInt>(input.size()));
+    put_le(out + size - footer_size, crc, 4);
+    put_le(out + size - 4, input.size(), 4);
+    output.resize(size);
+    return true;
+  }
+
+  /** \brief the empty block BGZF readers expect at the end of a file
+   *  \return end of file marker
+   */
+  static string_view eof_block() {
+    static constexpr unsigned char block[28]{31, 139, 8,  4, 0, 0, 0, 0, 0, 255, 6, 0, 'B', 'C',
+                                             2,  0,   27, 0, 3, 0, 0, 0, 0, 0,   0, 0, 0,   0};
+    return {reinterpret_cast<const char*>(block), sizeof(block)};
+  }
+
+private:
+  static constexpr std::size_t header_size = 18;
+  static constexpr std::size_t footer_size = 8;
+
+  static void put_le(unsigned char* out, std::uint64_t value, std::size_t bytes) {
+    for (std::size_t i = 0; i < bytes; i++) {
+      out[i] = static_cast<unsigned char>(value >> (8 * i));
+    }
+  }
+
+  z_stream m_stream{};
+  bool m_ok{false};
+};
+
+/** \class BgzfByteSink
+ *  \ingroup compress
+ *  \brief ByteSink writing gzip compressed data as independent BGZF blocks to another ByteSink
+ *
+ *  The output is a valid multi-member gzip file which every gzip reader accepts, and since
+ *  each block of at most 64 KiB stands alone it can later be decompressed in parallel or
+ *  indexed. With more than one thread, blocks are compressed by worker threads and written
+ *  in order. close() or the destructor write the last block and the BGZF end of file marker.
+ */
+template <typename ByteSink>
+class BgzfByteSink {
+public:
+  /** \brief Construct a BgzfByteSink around a ByteSink
+   *  \param sink ByteSink receiving compressed blocks
+   *  \param level zlib compression level
+   *  \param threads number of compression threads, 1 compresses in the calling thread
+   */
+  explicit BgzfByteSink(ByteSink sink, int level = Z_DEFAULT_COMPRESSION, unsigned threads = 1)
+      : m_sink(std::move(sink)), m_level(level), m_deflater(level) {
+    m_input.reserve(BgzfDeflater::max_input);
+    if (threads > 1) {
+      m_slots.resize(threads * 2);
+      for (unsigned i = 0; i < threads; i++) { m_workers.emplace_back([this] { run(); }); }
+    }
+  }
+
+  BgzfByteSink(const BgzfByteSink&) = delete;
+  BgzfByteSink& operator=(const BgzfByteSink&) = delete;
+
+  ~BgzfByteSink() { close(); }
+
+  /** \brief compress count bytes from data, full blocks are written as they complete
+   *  \return true if the sink is still good
+   */
+  bool write(const char* data, std::size_t count) {
+    while (count != 0 && m_good) {
+      const std::size_t part = std::min(count, BgzfDeflater::max_input - m_input.size());
+      m_input.append(data, part);
+      data += part;
+      count -= part;
+      if (m_input.size() == BgzfDeflater::max_input) { submit(); }
+    }
+    return m_good;
+  }
+
+  /** \brief compress the pending partial block and write every block
+   *  \return true if the sink is still good
+   */
+  bool flush() {
+    if (!m_input.empty()) { submit(); }
+    if (!m_slots.empty()) {
+      while (m_written < m_submitted) { write_next(); }
+    }
+    return m_good;
+  }
+
+  /** \brief flush, write the end of file marker and stop the worker threads
+   *  \return true if the sink is still good
+   */
+  bool close() {
+    if (m_closed) { return m_good; }
+    flush();
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_closed = true;
+    }
+    m_job_ready.notify_all();
+    for (auto& worker : m_workers) { worker.join(); }
+    const auto eof = BgzfDeflater::eof_block();
+    if (m_good) { m_good = m_sink.write(eof.data(), eof.size()); }
+    return m_good;
+  }
+
+  /** \brief check if compression and the wrapped sink are still good
+   *  \return true if good, otherwise false
+   */
+  bool good() { return m_good && m_sink.good(); }
+
+  /** \brief access the wrapped ByteSink
+   *  \return reference to the ByteSink
+   */
+  ByteSink& sink() { return m_sink; }
+
+private:
+  struct Slot {
+    std::string input;
+    std::string output;
+    bool done{false};
+    bool ok{false};
+  };
+
+  void submit() {
+    if (m_slots.empty()) {
+      if (!m_deflater.compress(m_input, m_block)) {
+        m_good = false;
+      } else {
+        m_good = m_sink.write(m_block.data(), m_block.size());
+      }
+      m_input.clear();
+      return;
+    }
+
+    // wait for the block occupying the slot, then hand the input to the workers
+    if (m_submitted - m_written == m_slots.size()) { write_next(); }
+    Slot& slot = m_slots[m_submitted % m_slots.size()];
+    slot.input.swap(m_input);
+    m_input.clear();
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      slot.done = false;
+      m_submitted++;
+    }
+    m_job_ready.notify_one();
+
+    // write whatever completed in order without waiting
+    while (m_written < m_submitted) {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      if (!m_slots[m_written % m_slots.size()].done) { break; }
+      lock.unlock();
+      write_next();
+    }
+  }
+
+  void write_next() {
+    Slot& slot = m_slots[m_written % m_slots.size()];
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_job_done.wait(lock, [&] { return slot.done; });
+    }
+    if (!slot.ok) {
+      m_good = false;
+    } else if (m_good) {
+      m_good = m_sink.write(slot.output.data(), slot.output.size());
+    }
+    m_written++;
+  }
+
+  void run() {
+    BgzfDeflater deflater(m_level);
+    while (true) {
+      std::size_t job{0};
+      {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_job_ready.wait(lock, [&] { return m_closed || m_next_job < m_submitted; });
+        if (m_next_job == m_submitted) { return; }
+        job = m_next_job++;
+      }
+      Slot& slot = m_slots[job % m_slots.size()];
+      const bool ok = deflater.compress(slot.input, slot.output);
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        slot.ok = ok;
+        slot.done = true;
+      }
+      m_job_done.notify_all();
+    }
+  }
+
+  ByteSink m_sink;
+  int m_level;
+  bool m_good{true};
+  bool m_closed{false};
+  std::string m_input;
+  std::string m_block;
+  BgzfDeflater m_deflater;
+
+  std::vector<Slot> m_slots;
+  std::size_t m_submitted{0};
+  std::size_t m_written{0};
+  std::size_t m_next_job{0};
+  std::mutex m_mutex;
+  std::condition_variable m_job_ready;
+  std::condition_variable m_job_done;
+  std::vector<std::thread> m_workers;
+};
+
+#endif  // CSVIO_WITH_ZLIB
+
+#if defined(CSVIO_WITH_ZSTD)
+
+/** \class ZstdByteSink
+ *  \ingroup compress
+ *  \brief ByteSink writing a zstd frame to another ByteSink
+ *
+ *  With threads above 0 zstd compresses on its own worker threads and write() only copies
+ *  into its job buffers. close() or the destructor end the frame.
+ */
+template <typename ByteSink>
+class ZstdByteSink {
+public:
+  /** \brief Construct a ZstdByteSink around a ByteSink
+   *  \param sink ByteSink receiving compressed data
+   *  \param level zstd compression level
+   *  \param threads number of zstd worker threads, 0 compresses in the calling thread
+   */
+  explicit ZstdByteSink(ByteSink sink, int level = 3, unsigned threads = 0)
+      : m_sink(std::move(sink)), m_context(ZSTD_createCCtx()), m_output(ZSTD_CStreamOutSize()) {
+    m_good = m_context != nullptr &&
+             !ZSTD_isError(ZSTD_CCtx_setParameter(m_context, ZSTD_c_compressionLevel, level));
+    if (m_good && threads > 0) {
+      // a libzstd built without threading support rejects this, compress in place instead
+      ZSTD_CCtx_setParameter(m_context, ZSTD_c_nbWorkers, static_cast<int>(threads));
+    }
+  }
+
+  ZstdByteSink(const ZstdByteSink&) = delete;
+  ZstdByteSink& operator=(const ZstdByteSink&) = delete;
+
+  ~ZstdByteSink() {
+    close();
+    ZSTD_freeCCtx(m_context);
+  }
+
+  /** \brief compress count bytes from data
+   *  \return true if the sink is still good
+   */
+  bool write(const char* data, std::size_t count) {
+    ZSTD_inBuffer input{data, count, 0};
+    while (m_good && input.pos < input.size) { compress(input, ZSTD_e_continue); }
+    return m_good;
+  }
+
+  /** \brief write everything compressed so far, ending the current zstd block
+   *  \return true if the sink is still good
+   */
+  bool flush() { return finish(ZSTD_e_flush); }
+
+  /** \brief end the frame
+   *  \return true if the sink is still good
+   */
+  bool close() {
+    if (m_closed) { return m_good; }
+    m_closed = true;
+    return finish(ZSTD_e_end);
+  }
+
+  /** \brief check if compression and the wrapped sink are still good
+   *  \return true if good, otherwise false
+   */
+  bool good() { return m_good && m_sink.good(); }
+
+  /** \brief access the wrapped ByteSink
+   *  \return reference to the ByteSink
+   */
+  ByteSink& sink() { return m_sink; }
+
+private:
+  std::size_t compress(ZSTD_inBuffer& input, ZSTD_EndDirective mode) {
+    ZSTD_outBuffer output{m_output.data(), m_output.size(), 0};
+    const std::size_t remaining = ZSTD_compressStream2(m_context, &output, &input, mode);
+    if (ZSTD_isError(remaining)) {
+      m_good = false;
+      return 0;
+    }
+    if (output.pos != 0) { m_good = m_sink.write(m_output.data(), output.pos); }
+    return remaining;
+  }
+
+  bool finish(ZSTD_EndDirective mode) {
+    ZSTD_inBuffer input{nullptr, 0, 0};
+    while (m_good && compress(input, mode) != 0) {}
+    return m_good;
+  }
+
+  ByteSink m_sink;
+  ZSTD_CCtx* m_context;
+  std::vector<char> m_output;
+  bool m_good{true};
+  bool m_closed{false};
+};
+
+#endif  // CSVIO_WITH_ZSTD
+
+}  // namespace util
+}  // namespace csvio
+
+#endif  // MGUID_CSV_IO_COMPRESS_HPP
@@ -27,19 +27,48 @@
 #define MGUID_CSV_IO_HPP
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
 #include <exception>
 #include <fstream>
 #include <functional>
+#include <initializer_list>
 #include <iostream>
 #include <istream>
+#include <iterator>
 #include <list>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <stdexcept>
 #include <string>
 #include <thread>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
 namespace csvio {
 
 #if defined(__cpp_lib_string_view) || defined(__cpp_lib_experimental_string_view)
@@ -52,6 +81,105 @@ using string_view = const std::string&;
 /** \internal */
 namespace util {
 
+/** \brief find the first character which forces a csv field to be quoted
+ *  \ingroup utility
+ *
+ *  Looks for a double quote, carriage return, newline or the delimiter,
+ *  16 bytes at a time with SSE2 when available.
+ *
+ *  \param first start of the field
+ *  \param last end of the field
+ *  \param delim delimiter of the output
+ *  \return pointer to the first such character, or last if there is none
+ */
+inline const char* find_escape_char(const char* first, const char* last, char delim) {
+#if defined(__SSE2__)
+  const __m128i quote = _mm_set1_epi8('\"');
+  const __m128i cr = _mm_set1_epi8('\r');
+  const __m128i lf = _mm_set1_epi8('\n');
+  const __m128i dl = _mm_set1_epi8(delim);
+  while (last - first >= 16) {
+    const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+    const __m128i hits = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(block, quote), _mm_cmpeq_epi8(block, cr)),
+        _mm_or_si128(_mm_cmpeq_epi8(block, lf), _mm_cmpeq_epi8(block, dl)));
+    if (const int mask = _mm_movemask_epi8(hits); mask != 0) {
+      return first + __builtin_ctz(static_cast<unsigned>(mask));
+    }
+    first += 16;
+  }
+#endif
+  for (; first != last; ++first) {
+    const char c = *first;
+    if (c == '\"' || c == '\r' || c == '\n' || c == delim) { return first; }
+  }
+  return last;
+}
+
+/** \brief append a csv field to a buffer, escaping it according to RFC 4180 if needed
+ *  \ingroup utility
+ *
+ *  Fields without special characters are appended as is, all others are
+ *  written quoted in a single pass without building a temporary string.
+ *
+ *  \param out buffer to append to
+ *  \param data field to append
+ *  \param delim used to check if a delimiter is in the field. if so, it should be escaped
+ *  \param force_escape wrap the field in quotes even if not needed
+ */
+inline void escape_append(std::string& out, string_view data, char delim = ',',
+                          bool force_escape = false) {
+  const char* first = data.data();
+  const char* const last = first + data.size();
+
+  const char* special = force_escape ? first : find_escape_char(first, last, delim);
+  if (special == last && !force_escape) {
+    out.append(first, data.size());
+    return;
+  }
+
+  out.reserve(out.size() + data.size() + 2);
+  out.push_back('\"');
+  out.append(first, special);
+  first = special;
+  while (first != last) {
+    const void* quote = std::memchr(first, '\"', static_cast<std::size_t>(last - first));
+    if (quote == nullptr) {
+      out.append(first, last);
+      break;
+    }
+    const char* const next = static_cast<const char*>(quote) + 1;
+    out.append(first, next);
+    out.push_back('\"');
+    first = next;
+  }
+  out.push_back('\"');
+}
+
+/** \brief how a formatter escapes the fields of a column
+ *  \ingroup utility
+ *
+ *  SCAN looks for special characters and quotes the field only if it has any, NEVER copies
+ *  the field as is and is meant for trusted columns such as numbers or ids, ALWAYS quotes
+ *  the field without looking for special characters first.
+ */
+enum EscapePolicy { SCAN, NEVER, ALWAYS };
+
+/** \brief append a csv field to a buffer according to an escape policy
+ *  \ingroup utility
+ *  \param out buffer to append to
+ *  \param data field to append
+ *  \param delim delimiter of the output
+ *  \param policy how to escape the field
+ */
+inline void escape_append(std::string& out, string_view data, char delim, EscapePolicy policy) {
+  if (policy == NEVER) {
+    out.append(data.data(), data.size());
+  } else {
+    escape_append(out, data, delim, policy == ALWAYS);
+  }
+}
+
 /** \brief function to escape characters in csv fields according to RFC 4180
  *  \ingroup utility
  *
@@ -72,32 +200,7 @@ namespace util {
  */
 inline std::string escape(string_view data, char delim = ',', bool force_escape = false) {
   std::string result;
-  result.reserve(
-      data.length());  // avoid lots of allocations by setting a reasonable initial allocation
-
-  bool needs_escape{false};
-  for (const char& c : data) {
-    switch (c) {
-      case '\"':
-        result.push_back(c);
-        [[fallthrough]];
-      case '\r':
-      case '\n':
-        needs_escape = true;
-        break;
-      default:
-        if (c == delim) {
-          needs_escape = true;  // special handle for alternative delimiters
-        }
-    }
-    result.push_back(c);
-  }
-
-  if (needs_escape || force_escape) {
-    result.push_back('\"');
-    result.insert(0, "\"");
-  }
-
+  escape_append(result, data, delim, force_escape);
   return result;
 }
 
@@ -405,6 +508,267 @@ struct DelimSplitUnescaped {
   RowContainer<std::string> m_data;
 };
 
+/** \class LazyRow
+ *  \ingroup parser
+ *  \brief Row container which keeps the raw csv line and unescapes fields on access
+ *
+ *  Each field records its offsets in the raw line and whether a quote was seen
+ *  while scanning it. Only those fields are passed through unescape, the first
+ *  time they are accessed, and the result is cached until the row is cleared.
+ *  Fields without quotes are returned as views into the raw line.
+ *
+ *  Usable as the RowContainer of a CSVReader together with DelimSplitLazy,
+ *  the element type is always std::string. Accessors fill the cache so a
+ *  LazyRow must not be read concurrently from several threads.
+ */
+template <typename Field = std::string>
+class LazyRow {
+  static_assert(std::is_same_v<Field, std::string>, "LazyRow only holds std::string fields");
+
+public:
+  using value_type = std::string;
+  using size_type = std::size_t;
+
+  /** \class const_iterator
+   *  \brief iterates the unescaped fields of a LazyRow as string_view
+   */
+  struct const_iterator {
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = string_view;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const string_view*;
+    using reference = string_view;
+
+    string_view operator*() const { return (*m_row)[m_index]; }
+    const_iterator& operator++() {
+      ++m_index;
+      return *this;
+    }
+    bool operator==(const const_iterator& other) const { return m_index == other.m_index; }
+    bool operator!=(const const_iterator& other) const { return m_index != other.m_index; }
+
+    const LazyRow* m_row;
+    size_type m_index;
+  };
+
+  LazyRow() = default;
+
+  /** \brief construct a row of already unescaped fields
+   *  \param fields field values
+   */
+  LazyRow(std::initializer_list<std::string> fields) {
+    for (const auto& field : fields) { push_back(field); }
+  }
+
+  /** \brief replace the contents with a raw escaped line, fields are added with add_field
+   *  \param line raw csv line, copied into the row
+   */
+  void assign_line(string_view line) {
+    clear();
+    m_line.assign(line.data(), line.size());
+  }
+
+  /** \brief record a field of the raw line
+   *  \param start offset of the first byte of the field
+   *  \param end offset one past the last byte of the field
+   *  \param needs_unescape true if the scanner saw a quote in the field
+   */
+  void add_field(size_type start, size_type end, bool needs_unescape) {
+    m_fields.push_back({start, end, needs_unescape, false});
+  }
+
+  /** \brief shorten the last field, used to drop a trailing carriage return
+   *  \param count number of bytes to remove from the end of the last field
+   */
+  void trim_last_field(size_type count) { m_fields.back().end -= count; }
+
+  /** \brief append an unescaped field
+   *  \param field field value
+   */
+  void push_back(string_view field) {
+    const size_type start = m_line.size();
+    m_line.append(field.data(), field.size());
+    add_field(start, m_line.size(), false);
+  }
+
+  /** \brief remove all fields, keeps the allocated capacity */
+  void clear() {
+    m_line.clear();
+    m_fields.clear();
+  }
+
+  /** \brief number of fields */
+  [[nodiscard]] size_type size() const { return m_fields.size(); }
+
+  /** \brief check whether the row has no fields */
+  [[nodiscard]] bool empty() const { return m_fields.empty(); }
+
+  /** \brief get the unescaped value of a field, unescaping it on first access
+   *  \param index field index, must be less than size()
+   *  \return view valid until the row is modified
+   */
+  string_view operator[](size_type index) const {
+    const Span& span = m_fields[index];
+    if (!span.needs_unescape) { return raw(index); }
+    if (m_cache.size() < m_fields.size()) { m_cache.resize(m_fields.size()); }
+    if (!span.cached) {
+      m_cache[index] = unescape(raw(index));
+      span.cached = true;
+    }
+    return m_cache[index];
+  }
+
+  /** \brief get the unescaped value of a field with bounds checking
+   *  \param index field index
+   *  \return view valid until the row is modified
+   */
+  string_view at(size_type index) const {
+    if (index >= m_fields.size()) { throw std::out_of_range("LazyRow::at index out of range"); }
+    return (*this)[index];
+  }
+
+  /** \brief get the field exactly as it appeared in the line, still escaped
+   *  \param index field index, must be less than size()
+   *  \return view into the raw line
+   */
+  [[nodiscard]] string_view raw(size_type index) const {
+    const Span& span = m_fields[index];
+    return string_view(m_line).substr(span.start, span.end - span.start);
+  }
+
+  /** \brief check whether a field needs unescaping
+   *  \param index field index, must be less than size()
+   *  \return true if the scanner saw a quote in the field
+   */
+  [[nodiscard]] bool needs_unescape(size_type index) const {
+    return m_fields[index].needs_unescape;
+  }
+
+  const_iterator begin() const { return {this, 0}; }
+  const_iterator end() const { return {this, m_fields.size()}; }
+
+  /** \brief copy all unescaped fields into a vector
+   *  \return vector of unescaped fields
+   */
+  [[nodiscard]] std::vector<std::string> to_vector() const {
+    std::vector<std::string> result;
+    result.reserve(size());
+    for (const auto field : *this) { result.emplace_back(field); }
+    return result;
+  }
+
+private:
+  struct Span {
+    size_type start;
+    size_type end;
+    bool needs_unescape;
+    mutable bool cached;
+  };
+
+  std::string m_line;
+  std::vector<Span> m_fields;
+  mutable std::vector<std::string> m_cache;
+};
+
+/** \brief check for a row split from a blank line
+ *  \ingroup parser
+ *  \param row split row
+ *  \return true if the row has no fields or a single empty one
+ */
+template <typename Row>
+bool is_blank_row(const Row& row) {
+  return row.empty() || (row.size() == 1 && row.raw(0).empty());
+}
+
+/** \brief find a column by its header name
+ *  \ingroup parser
+ *  \param header header names
+ *  \param name header name of the column
+ *  \param warn print a warning if the header has no such column
+ *  \return position of the column, header.size() if it was not found
+ */
+template <typename Header>
+std::size_t find_column(const Header& header, string_view name, bool warn) {
+  std::size_t index{0};
+  for (const auto& column : header) {
+    if (string_view(column) == name) { break; }
+    index++;
+  }
+  if (index == header.size() && warn) {
+    std::cerr << "[warning] Column " << name << " not found in header\n";
+  }
+  return index;
+}
+
+/** \class DelimSplitLazy
+ *  \ingroup parser
+ *  \brief Split a CSV into a LazyRow, deferring unescaping until a field is read
+ */
+template <template <class...> class RowContainer = LazyRow>
+struct DelimSplitLazy {
+  /** \brief split a csv row on a delimiter, recording field offsets only
+   *
+   *  Linear time complexity with respect to the size of input
+   *
+   *  \param input string_view to split by delimiter
+   *  \param delim delimiter to split on
+   *  \return RowContainer of split csv fields, if input string empty, return RowContainer with one
+   * empty string
+   */
+  RowContainer<std::string>& operator()(string_view input, const char delim) {
+    parse_into(m_data, input, delim);
+    return m_data;
+  }
+
+  /** \brief split a csv row into a caller's row, which keeps its allocated capacity
+   *  \param out row to replace the contents of
+   *  \param input string_view to split by delimiter
+   *  \param delim delimiter to split on
+   */
+  static void parse_into(RowContainer<std::string>& out, string_view input, const char delim) {
+    out.assign_line(input);
+
+    CSVParserScope state{LINE};
+    std::size_t start{0};
+    std::size_t num_cols{1};
+    bool quoted{false};
+
+    for (std::size_t i = 0; i < input.size(); ++i) {
+      const char c = input[i];
+      if (c == '\"') {
+        quoted = true;
+        state = (state == LINE) ? QUOTE : LINE;
+      } else if (state == LINE && (c == delim || c == '\n')) {
+        if (c == delim) { num_cols++; }
+        out.add_field(start, i, quoted);
+        start = i + 1;
+        quoted = false;
+      }
+    }
+    if (start < input.size() || out.size() < num_cols) {
+      out.add_field(start, input.size(), quoted);
+    }
+
+    if (const auto last = out.raw(out.size() - 1); !last.empty() && last.back() == '\r') {
+      out.trim_last_field(1);
+    }
+  }
+
+  RowContainer<std::string> m_data;
+};
+
+/** \brief detect parsers which can split a line straight into a caller's row
+ *  \ingroup parser
+ */
+template <typename Parser, typename Row, typename = void>
+struct has_parse_into : std::false_type {};
+
+template <typename Parser, typename Row>
+struct has_parse_into<Parser, Row,
+                      std::void_t<decltype(std::declval<Parser&>().parse_into(
+                          std::declval<Row&>(), std::declval<string_view>(), char{}))>>
+    : std::true_type {};
+
 /** \class MapDelimSplitUnescaped
  *  \ingroup parser
  *  \brief Split a CSV to a map assuming it is escaped and unescape the output
@@ -656,26 +1020,79 @@ struct DelimJoinEscapedFormat {
    */
   std::string& operator()(const RowContainer<std::string>& csv_row, const char delim,
                           const std::string& line_terminator) {
-    m_data.clear();
     m_data.reserve(csv_row.size() * 2);
+    return join(csv_row, delim, line_terminator);
+  }
 
-    bool first{true};
-    for (auto& s : csv_row) {
-      if (first) {
-        m_data.append(escape(s));
-        first = false;
-      } else {
-        m_data.push_back(delim);
-        m_data.append(escape(s));
+  /** \brief get an escaped csv string from any range of string like values
+   *  \param csv_row range of values convertible to string_view
+   *  \param delim delimiter to join values on
+   *  \param line_terminator line terminating sequence
+   *  \return an escaped csv string of the joined range
+   */
+  template <typename Row>
+  std::string& operator()(const Row& csv_row, const char delim,
+                          const std::string& line_terminator) {
+    return join(csv_row, delim, line_terminator);
+  }
+
+  /** \brief set how the fields of each column are escaped, columns without an entry are scanned
+   *  \param policy escape policy per column, in column order
+   */
+  void set_column_escape(std::vector<EscapePolicy> policy) { m_column_escape = std::move(policy); }
+
+  /** \brief get the escape policy per column
+   *  \return escape policy per column, in column order
+   */
+  [[nodiscard]] const std::vector<EscapePolicy>& get_column_escape() const {
+    return m_column_escape;
+  }
+
+  std::string m_data;
+
+private:
+  template <typename Row>
+  std::string& join(const Row& csv_row, const char delim, const std::string& line_terminator) {
+    m_data.clear();
+
+    if (m_column_escape.empty()) {
+      bool first{true};
+      for (auto& s : csv_row) {
+        if (first) {
+          first = false;
+        } else {
+          m_data.push_back(delim);
+        }
+        escape_append(m_data, string_view(s), delim);
+      }
+    } else {
+      std::size_t column{0};
+      for (auto& s : csv_row) {
+        if (column != 0) { m_data.push_back(delim); }
+        const EscapePolicy policy =
+            column < m_column_escape.size() ? m_column_escape[column] : SCAN;
+        escape_append(m_data, string_view(s), delim, policy);
+        column++;
       }
     }
     m_data.append(line_terminator);
     return m_data;
   }
 
-  std::string m_data;
+  std::vector<EscapePolicy> m_column_escape;
 };
 
+/** \brief detect formatters with a per-column escape policy
+ *  \ingroup formatter
+ */
+template <typename Formatter, typename = void>
+struct has_column_escape : std::false_type {};
+
+template <typename Formatter>
+struct has_column_escape<
+    Formatter, std::void_t<decltype(std::declval<Formatter&>().set_column_escape(
+                   std::declval<std::vector<EscapePolicy>>()))>> : std::true_type {};
+
 /** \class DelimJoinUnescapedFormat
  *  \ingroup formatter
  *  \brief Join a CSV on a delimiter leaving each field unescaped
@@ -690,391 +1107,3178 @@ struct DelimJoinUnescapedFormat {
    */
   std::string& operator()(const RowContainer<std::string>& csv_row, const char delim,
                           const std::string& line_terminator) {
+    return join(csv_row, delim, line_terminator);
+  }
+
+  /** \brief get an unescaped csv string from any range of string like values
+   *  \param csv_row range of values convertible to string_view
+   *  \param delim delimiter to join values on
+   *  \param line_terminator line terminating sequence
+   *  \return an unescaped csv string of the joined range
+   */
+  template <typename Row>
+  std::string& operator()(const Row& csv_row, const char delim,
+                          const std::string& line_terminator) {
+    return join(csv_row, delim, line_terminator);
+  }
+
+  std::string m_data;
+
+private:
+  template <typename Row>
+  std::string& join(const Row& csv_row, const char delim, const std::string& line_terminator) {
     m_data.clear();
     bool first{true};
     for (auto& s : csv_row) {
+      const string_view field(s);
       if (first) {
-        m_data.append(s);
         first = false;
       } else {
         m_data.push_back(delim);
-        m_data.append(s);
       }
+      m_data.append(field.data(), field.size());
     }
     m_data.append(line_terminator);
     return m_data;
   }
-
-  std::string m_data;
 };
 
-/** \class CSVLineReader
- *  \ingroup line_reader
- *  \brief Stateful CSV line reader which reads csv lines with escaped fields according to RFC 4180
+/** \brief detect ranges whose elements convert to string_view
+ *  \ingroup formatter
  */
-class CSVLineReader {
-public:
-  /** \brief Construct a CSVLineReader from a reference to a istream
-   *  \param instream reference to a istream
-   */
-  explicit CSVLineReader(std::istream& instream) : m_csv_stream(instream) {}
+template <typename Row, typename = void>
+struct is_string_row : std::false_type {};
 
-  /** \brief read a csv line
-   *  \return a string with the contents of the csv line
-   */
-  std::string readline() {
-    m_result.clear();
+template <typename Row>
+struct is_string_row<Row, std::void_t<decltype(std::begin(std::declval<const Row&>())),
+                                      decltype(std::end(std::declval<const Row&>()))>>
+    : std::is_convertible<decltype(*std::begin(std::declval<const Row&>())), string_view> {};
 
-    std::string buf;
-    buf.reserve(1024);
+/** \brief detect std::tuple and std::pair rows
+ *  \ingroup formatter
+ */
+template <typename T>
+struct is_tuple_like : std::false_type {};
 
-    char c;
+template <typename... Ts>
+struct is_tuple_like<std::tuple<Ts...>> : std::true_type {};
 
-    while (m_csv_stream.good()) {
-      m_csv_stream.get(c);
-      if (m_state == LINE && (c == '\n' || c == EOF || !m_csv_stream.good())) {
-        if (c == '\n') m_result.push_back(c);
-        break;
-      } else if (m_state == LINE && c == '\"') {
-        m_state = QUOTE;
-      } else if (m_state == QUOTE && c == '\"') {
-        m_state = LINE;
-      } else if (m_state == QUOTE && !m_csv_stream.good()) {
-        m_result = "";
-        return m_result;
-      }
-      m_result.push_back(c);
-    }
+template <typename First, typename Second>
+struct is_tuple_like<std::pair<First, Second>> : std::true_type {};
 
-    // handle the possibility of the last line, we dont want to parse it
-    // we will inspect the next three characters and see if eofbit is set.
-    // if it is not, then we will unget these characters;
-    m_csv_stream.get();
-    m_csv_stream.get();
-    m_csv_stream.get();
+/** \brief check whether a delimiter could appear in a formatted number
+ *  \ingroup formatter
+ *  \param delim delimiter to check
+ *  \return true if numbers have to be escaped for this delimiter
+ */
+inline bool delimiter_in_numbers(char delim) {
+  return (delim >= '0' && delim <= '9') || std::strchr(".+-eEinfaINFA", delim) != nullptr;
+}
 
-    if (good()) {
-      m_csv_stream.unget();
-      m_csv_stream.unget();
-      m_csv_stream.unget();
+/** \brief append a typed value as a csv field
+ *  \ingroup formatter
+ *
+ *  Integers and floating point values are formatted with std::to_chars directly into
+ *  the output, doubles use the shortest representation which round trips. Numbers
+ *  and bools are not scanned for escaping unless escape_numbers is set. Anything
+ *  convertible to string_view is escaped with escape_append.
+ *
+ *  \param out buffer to append to
+ *  \param value value to format
+ *  \param delim output delimiter
+ *  \param escape_numbers whether numbers may contain the delimiter
+ */
+template <typename T>
+void append_field(std::string& out, const T& value, char delim, bool escape_numbers = false) {
+  if constexpr (std::is_same_v<T, bool>) {
+    out.append(value ? "true" : "false");
+  } else if constexpr (std::is_same_v<T, char>) {
+    escape_append(out, string_view(&value, 1), delim);
+  } else if constexpr (std::is_integral_v<T> || std::is_floating_point_v<T>) {
+    char buf[64];
+    std::size_t length{0};
+    if constexpr (std::is_integral_v<T>) {
+      length = static_cast<std::size_t>(std::to_chars(buf, buf + sizeof(buf), value).ptr - buf);
+    } else {
+#if defined(__cpp_lib_to_chars)
+      length = static_cast<std::size_t>(std::to_chars(buf, buf + sizeof(buf), value).ptr - buf);
+#else
+      length = static_cast<std::size_t>(
+          std::snprintf(buf, sizeof(buf), "%.17Lg", static_cast<long double>(value)));
+#endif
     }
+    const string_view number(buf, length);
+    if (escape_numbers) {
+      escape_append(out, number, delim);
+    } else {
+      out.append(number.data(), number.size());
+    }
+  } else if constexpr (std::is_convertible_v<const T&, string_view>) {
+    escape_append(out, string_view(value), delim);
+  } else {
+    static_assert(std::is_convertible_v<const T&, string_view>,
+                  "append_field supports integers, floating point, bool, char and string types");
+  }
+}
 
-    m_lines_read++;
-    m_state = LINE;
-    return m_result;
+/** \brief append a typed value as a csv field according to an escape policy
+ *  \ingroup formatter
+ *
+ *  SCAN formats the value like append_field without a policy, NEVER copies strings as is,
+ *  ALWAYS quotes numbers and bools as well as strings.
+ *
+ *  \param out buffer to append to
+ *  \param value value to format
+ *  \param delim output delimiter
+ *  \param escape_numbers whether numbers may contain the delimiter
+ *  \param policy how to escape the field
+ */
+template <typename T>
+void append_field(std::string& out, const T& value, char delim, bool escape_numbers,
+                  EscapePolicy policy) {
+  if (policy == SCAN) {
+    append_field(out, value, delim, escape_numbers);
+  } else if constexpr (std::is_same_v<T, char>) {
+    escape_append(out, string_view(&value, 1), delim, policy);
+  } else if constexpr (std::is_convertible_v<const T&, string_view> && !std::is_same_v<T, bool>) {
+    escape_append(out, string_view(value), delim, policy);
+  } else if (policy == ALWAYS) {
+    // formatted numbers and bools never contain a quote, only the enclosing quotes are needed
+    out.push_back('\"');
+    append_field(out, value, delim, false);
+    out.push_back('\"');
+  } else {
+    append_field(out, value, delim, false);
   }
+}
 
-  /** \brief Get number of csv lines read so far
-   *  \return number of csv lines read so far
+/** \class StringColumn
+ *  \ingroup formatter
+ *  \brief View of a string column stored as one character buffer and an offsets array
+ *
+ *  Row i spans data[offsets[i]] to data[offsets[i + 1]], so offsets holds one entry more
+ *  than there are rows, the layout used by Arrow and most columnar engines.
+ */
+template <typename Offset = std::uint32_t>
+class StringColumn {
+public:
+  /** \brief construct a StringColumn
+   *  \param data concatenated characters of every row
+   *  \param offsets start of every row followed by the end of the last row
    */
-  [[nodiscard]] std::size_t lcount() const { return m_lines_read; }
+  StringColumn(const char* data, const Offset* offsets) : m_data(data), m_offsets(offsets) {}
 
-  /** \brief check if the underlying stream is still good
-   *  \return true if good, otherwise false
+  /** \brief get a row of the column
+   *  \param row row index
+   *  \return view of the row's characters
    */
-  bool good() { return m_csv_stream.good(); }
+  string_view operator[](std::size_t row) const {
+    return {m_data + m_offsets[row],
+            static_cast<std::size_t>(m_offsets[row + 1] - m_offsets[row])};
+  }
 
 private:
-  CSVParserScope m_state{LINE};
-  std::istream& m_csv_stream;
-  std::string m_result;
-  std::size_t m_lines_read{0};
+  const char* m_data;
+  const Offset* m_offsets;
 };
 
-/** \class CSVSimpleLineReader
- *  \ingroup line_reader
- *  \brief CSV line reader which reads csv lines
+/** \brief format one row of a column, anything indexable whose elements append_field formats
+ *  \ingroup formatter
+ *  \param out buffer to append to
+ *  \param column column to read from
+ *  \param row row index
+ *  \param delim output delimiter
+ *  \param escape_numbers whether numbers may contain the delimiter
+ *  \param policy how to escape the field
+ */
+template <typename Column>
+void append_column_field(std::string& out, const Column& column, std::size_t row, char delim,
+                         bool escape_numbers, EscapePolicy policy = SCAN) {
+  const auto& value = column[row];
+  using Value = std::decay_t<decltype(value)>;
+  if constexpr (std::is_class_v<Value> && !std::is_convertible_v<const Value&, string_view> &&
+                std::is_convertible_v<const Value&, bool>) {
+    // proxies such as std::vector<bool>::reference
+    append_field(out, static_cast<bool>(value), delim, escape_numbers, policy);
+  } else {
+    append_field(out, value, delim, escape_numbers, policy);
+  }
+}
+
+/** \brief convert an unescaped csv field to a typed value
+ *  \ingroup parser
  *
- *  This line reader is a sane alternative to the conforming line reader which
- *  allows for newline characters in your csv fields.
- *  If you have an insane dataset which allows newlines in the middle of fields,
- *  I'm sorry...
+ *  Integers and floating point values are parsed with std::from_chars, bools
+ *  accept true/false and 1/0. An empty field leaves a value initialized result.
  *
- *  This should be a slightly faster alternative for most cases.
+ *  \param field unescaped field
+ *  \param out value to assign
+ *  \return true if the whole field was converted, otherwise false
  */
-class CSVSimpleLineReader {
-public:
-  /** \brief Construct a CSVSimpleLineReader from a reference to a istream
-   *  \param instream reference to a istream
-   */
-  explicit CSVSimpleLineReader(std::istream& instream) : m_csv_stream(instream) {}
-
-  /** \brief read a csv line
-   *  \return a string with the contents of the csv line
-   */
-  std::string readline() {
-    m_result.clear();
+template <typename T>
+bool parse_field(string_view field, T& out) {
+  if constexpr (std::is_same_v<T, std::string>) {
+    out.assign(field.data(), field.size());
+    return true;
+  } else {
+    if (field.empty()) {
+      out = T{};
+      return true;
+    }
+    if constexpr (std::is_same_v<T, bool>) {
+      out = (field == "true" || field == "1");
+      return out || field == "false" || field == "0";
+    } else if constexpr (std::is_same_v<T, char>) {
+      out = field[0];
+      return field.size() == 1;
+    } else if constexpr (std::is_integral_v<T>) {
+      const auto result = std::from_chars(field.data(), field.data() + field.size(), out);
+      return result.ec == std::errc() && result.ptr == field.data() + field.size();
+    } else if constexpr (std::is_floating_point_v<T>) {
+#if defined(__cpp_lib_to_chars)
+      const auto result = std::from_chars(field.data(), field.data() + field.size(), out);
+      return result.ec == std::errc() && result.ptr == field.data() + field.size();
+#else
+      const std::string copy(field.data(), field.size());
+      char* end{nullptr};
+      out = static_cast<T>(std::strtold(copy.c_str(), &end));
+      return end == copy.c_str() + copy.size();
+#endif
+    } else {
+      static_assert(std::is_integral_v<T>,
+                    "parse_field supports integers, floating point, bool, char and std::string");
+    }
+  }
+}
+
+/** \brief call f(element, index) for every element of a tuple
+ *  \ingroup utility
+ */
+template <typename Tuple, typename Func, std::size_t... Index>
+constexpr void for_each_indexed(const Tuple& tuple, Func&& func, std::index_sequence<Index...>) {
+  (func(std::get<Index>(tuple), Index), ...);
+}
+
+/** \brief call f(element, index) for every element of a tuple
+ *  \ingroup utility
+ */
+template <typename Tuple, typename Func>
+constexpr void for_each_indexed(const Tuple& tuple, Func&& func) {
+  for_each_indexed(tuple, std::forward<Func>(func),
+                   std::make_index_sequence<std::tuple_size_v<Tuple>>{});
+}
 
-    std::getline(m_csv_stream, m_result);
+/** \brief detect rows which support operator[] with an index
+ *  \ingroup utility
+ */
+template <typename Row, typename = void>
+struct has_index_operator : std::false_type {};
 
-    // handle the possibility of the last line, we don't want to parse it
-    // we will inspect the next three characters and see if eofbit is set.
-    // if it is not, then we will unget these characters;
-    m_csv_stream.get();
-    m_csv_stream.get();
-    m_csv_stream.get();
+template <typename Row>
+struct has_index_operator<Row, std::void_t<decltype(std::declval<Row&>()[std::size_t{}])>>
+    : std::true_type {};
 
-    if (good()) {
-      m_csv_stream.unget();
-      m_csv_stream.unget();
-      m_csv_stream.unget();
-    }
+/** \brief number of bytes requested from a ByteSource each time a line reader runs dry
+ *  \ingroup byte_source
+ */
+inline constexpr std::size_t default_block_size = std::size_t{1} << 16;
 
-    m_lines_read++;
-    return m_result;
-  }
+/** \brief detect whether a ByteSource can hand out zero-copy views through next_view()
+ *  \ingroup byte_source
+ */
+template <typename ByteSource, typename = void>
+struct has_next_view : std::false_type {};
 
-  /** \brief Get number of csv lines read so far
-   *  \return number of csv lines read so far
+template <typename ByteSource>
+struct has_next_view<ByteSource, std::void_t<decltype(std::declval<ByteSource&>().next_view())>>
+    : std::true_type {};
+
+/** \class IStreamByteSource
+ *  \ingroup byte_source
+ *  \brief ByteSource reading blocks from a std::istream
+ *
+ *  The stream is only touched once per block, so the sentry and streambuf
+ *  dispatch are paid per block instead of per character.
+ */
+class IStreamByteSource {
+public:
+  /** \brief Construct an IStreamByteSource from a reference to a istream
+   *  \param instream reference to a istream
    */
-  [[nodiscard]] std::size_t lcount() const { return m_lines_read; }
+  explicit IStreamByteSource(std::istream& instream) : m_stream(instream) {}
 
-  /** \brief check if the underlying stream is still good
-   *  \return true if good, otherwise false
+  /** \brief read up to count bytes into dest
+   *  \param dest buffer with room for at least count bytes
+   *  \param count maximum number of bytes to read
+   *  \return number of bytes read, 0 once the stream is exhausted
    */
-  bool good() { return m_csv_stream.good(); }
+  std::size_t read(char* dest, std::size_t count) {
+    if (!m_stream.good()) { return 0; }
+    m_stream.read(dest, static_cast<std::streamsize>(count));
+    return static_cast<std::size_t>(m_stream.gcount());
+  }
 
 private:
-  std::istream& m_csv_stream;
-  std::string m_result;
-  std::size_t m_lines_read{0};
+  std::istream& m_stream;
 };
 
-/** \class CSVLineWriter
- *  \ingroup line_writer
- *  \brief Writes a csv line to a stream, provides a written lines counter
- *
- *  doesnt do much other than make the implementation symmetrical
- *  also allows for ever greater custom behavior,
- *  maybe some kind of custom format that prepends or appends some string before writing
+/** \class FileByteSource
+ *  \ingroup byte_source
+ *  \brief ByteSource reading blocks from a C FILE*, the FILE* is not owned
  */
-class CSVLineWriter {
+class FileByteSource {
 public:
-  /** \brief Construct a CSVLineWriter from an outstream
-   *  \param outstream ostream to write lines to
+  /** \brief Construct a FileByteSource from an open FILE*
+   *  \param file open FILE* to read from
    */
-  explicit CSVLineWriter(std::ostream& outstream) : m_csv_stream(outstream) {}
+  explicit FileByteSource(std::FILE* file) : m_file(file) {}
 
-  /** \brief write a csv line to the stream
-   *  \param line line to write to stream
+  /** \brief read up to count bytes into dest
+   *  \param dest buffer with room for at least count bytes
+   *  \param count maximum number of bytes to read
+   *  \return number of bytes read, 0 once the file is exhausted
    */
-  void writeline(string_view line) {
-    if (good()) {
-      m_csv_stream.write(line.data(), static_cast<std::streamsize>(line.length()));
-      m_lines_written++;
-    }
+  std::size_t read(char* dest, std::size_t count) {
+    if (m_file == nullptr) { return 0; }
+    return std::fread(dest, 1, count, m_file);
   }
 
-  /** \brief check if the underlying stream is still good
-   *  \return true if good, otherwise false
+private:
+  std::FILE* m_file;
+};
+
+/** \class MemoryByteSource
+ *  \ingroup byte_source
+ *  \brief ByteSource over a contiguous in-memory buffer, the buffer is not owned
+ */
+class MemoryByteSource {
+public:
+  /** \brief Construct a MemoryByteSource from a pointer and a size
+   *  \param data pointer to the first byte
+   *  \param size number of bytes
    */
-  bool good() { return m_csv_stream.good(); }
+  MemoryByteSource(const char* data, std::size_t size) : m_data(data, size) {}
 
-  /** \brief Get number of csv lines written so far
-   *  \return number of csv lines written so far
+  /** \brief Construct a MemoryByteSource from a string_view
+   *  \param data view of the bytes to read, must outlive this source
    */
-  [[nodiscard]] std::size_t lcount() const { return m_lines_written; }
+  explicit MemoryByteSource(string_view data) : m_data(data) {}
+
+  /** \brief copy up to count bytes into dest
+   *  \param dest buffer with room for at least count bytes
+   *  \param count maximum number of bytes to copy
+   *  \return number of bytes copied, 0 once the buffer is exhausted
+   */
+  std::size_t read(char* dest, std::size_t count) {
+    const std::size_t n = std::min(count, m_data.size());
+    if (n != 0) { std::memcpy(dest, m_data.data(), n); }
+    m_data.remove_prefix(n);
+    return n;
+  }
+
+  /** \brief hand out the rest of the buffer without copying
+   *  \return view of the unread bytes, empty once exhausted
+   */
+  string_view next_view() {
+    string_view result = m_data;
+    m_data = string_view{};
+    return result;
+  }
 
 private:
-  std::ostream& m_csv_stream;
-  std::size_t m_lines_written{0};
+  string_view m_data;
 };
 
-}  // namespace util
+#if defined(__unix__) || defined(__APPLE__)
 
-/** \class CSVReader
- *  \ingroup reader
- *  \brief Reader to read a stream as CSV
+/** \class FdByteSource
+ *  \ingroup byte_source
+ *  \brief ByteSource reading blocks from a POSIX file descriptor, the descriptor is not owned
  */
-template <template <class...> class RowContainer = std::vector,
-          typename LineReader = csvio::util::CSVLineReader,
-          typename Parser = csvio::util::DelimSplitUnescaped<RowContainer>>
-class CSVReader {
+class FdByteSource {
 public:
-  /** \class iterator
-   *  \brief CSVReader iterator
+  /** \brief Construct a FdByteSource from an open file descriptor
+   *  \param fd open file descriptor to read from
    */
-  struct iterator {
-    /** \brief construct a CSVReader iterator
-     *  This default is used for the end iterator
-     */
-    iterator() { m_good = false; }
+  explicit FdByteSource(int fd) : m_fd(fd) {}
 
-    /** \brief parameterized constructor that takes a pointer to a CSVReader
-     *  \param ptr pointer to a valid non-nullptr CSVReader iterator
-     */
-    explicit iterator(CSVReader* ptr) : m_ptr(ptr) {
-      m_ptr->read();
-      m_good = m_ptr->good();
-    }
+  /** \brief read up to count bytes into dest, retrying on EINTR
+   *  \param dest buffer with room for at least count bytes
+   *  \param count maximum number of bytes to read
+   *  \return number of bytes read, 0 at end of file or on error
+   */
+  std::size_t read(char* dest, std::size_t count) {
+    if (m_fd < 0) { return 0; }
+    ssize_t n;
+    do {
+      n = ::read(m_fd, dest, count);
+    } while (n < 0 && errno == EINTR);
+    return n < 0 ? 0 : static_cast<std::size_t>(n);
+  }
 
-    /** \brief increment this CSVReader iterator
-     *  \return the iteration of CSVReader
-     */
-    iterator operator++() {
-      m_ptr->read();
-      m_good = m_ptr->good();
-      return *this;
+private:
+  int m_fd;
+};
+
+/** \class MMapByteSource
+ *  \ingroup byte_source
+ *  \brief ByteSource which memory maps a whole file and hands it out as one view
+ *
+ *  Like std::ifstream, failing to open the file is not an error by itself,
+ *  the source is simply empty and is_open() returns false.
+ */
+class MMapByteSource {
+public:
+  /** \brief map the file at path read only
+   *  \param path path of the file to map
+   *  \param advice madvise() advice for the mapping, MADV_SEQUENTIAL suits reading it front to
+   *  back, MADV_NORMAL or MADV_RANDOM suit random access
+   */
+  explicit MMapByteSource(const std::string& path, int advice = MADV_SEQUENTIAL) {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) { return; }
+    struct stat info {};
+    if (::fstat(fd, &info) == 0) {
+      m_open = true;
+      m_size = static_cast<std::size_t>(info.st_size);
+      if (m_size != 0) {
+        void* addr = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED) {
+          m_open = false;
+          m_size = 0;
+        } else {
+          m_addr = static_cast<const char*>(addr);
+          ::madvise(addr, m_size, advice);
+        }
+      }
     }
+    ::close(fd);
+  }
 
-    /** \brief Comparison to check for end
-     *  \param other const ref to a CSVReader iterator
-     *  \return true if the iterator is still good; otherwise false
-     */
-    bool operator!=(const iterator& other) const { return m_good != other.m_good; }
+  MMapByteSource(const MMapByteSource&) = delete;
+  MMapByteSource& operator=(const MMapByteSource&) = delete;
 
-    /** \brief return the current RowContainer reference from this iterator
-     *  \return a reference to the current RowContainer
-     */
-    RowContainer<std::string>& operator*() const { return m_ptr->current(); }
+  MMapByteSource(MMapByteSource&& other) noexcept
+      : m_addr(std::exchange(other.m_addr, nullptr)), m_size(std::exchange(other.m_size, 0)),
+        m_consumed(other.m_consumed), m_open(std::exchange(other.m_open, false)) {}
 
-    /** \brief return the current RowContainer pointed to by this iterator
-     *  \return a pointer to the current RowContainer
-     */
-    RowContainer<std::string>* operator->() const { return &m_ptr->current(); }
+  MMapByteSource& operator=(MMapByteSource&& other) noexcept {
+    if (this != &other) {
+      unmap();
+      m_addr = std::exchange(other.m_addr, nullptr);
+      m_size = std::exchange(other.m_size, 0);
+      m_consumed = other.m_consumed;
+      m_open = std::exchange(other.m_open, false);
+    }
+    return *this;
+  }
 
-    CSVReader* m_ptr;
-    bool m_good{true};
-  };
+  ~MMapByteSource() { unmap(); }
 
-  /** \brief the begin CSVReader iterator
-   *  \return iterator with the begin CSVReader
+  /** \brief check whether the file was opened and mapped
+   *  \return true if open, otherwise false
    */
-  iterator begin() { return iterator(this); }
+  [[nodiscard]] bool is_open() const { return m_open; }
 
-  /** \brief the end CSVReader iterator
-   *  \return default constructed end iterator
+  /** \brief copy up to count bytes into dest
+   *  \param dest buffer with room for at least count bytes
+   *  \param count maximum number of bytes to copy
+   *  \return number of bytes copied, 0 once the mapping is exhausted
    */
-  iterator end() const { return iterator(); }
+  std::size_t read(char* dest, std::size_t count) {
+    const std::size_t n = std::min(count, m_size - m_consumed);
+    if (n != 0) { std::memcpy(dest, m_addr + m_consumed, n); }
+    m_consumed += n;
+    return n;
+  }
 
-  /** \brief Construct a CSVReader from a reference to a generic LineReader
-   *  \param line_reader reference to a LineReader
-   *  \param delimiter a character delimiter
-   *  \param has_header specify that this csv has a header
-   *  \param warn_columns warn in case of mismatched columns
-   *  \param parse_func a function which describes how to split a csv row
+  /** \brief hand out the rest of the mapping without copying
+   *  \return view of the unread bytes, empty once exhausted
    */
-  explicit CSVReader(LineReader& line_reader, const char delimiter = ',', bool has_header = false,
-                     bool warn_columns = true)
-      : m_csv_line_reader(line_reader), m_delim(delimiter), m_has_header(has_header),
-        m_warn_columns(warn_columns) {
-    if (m_has_header) { handle_header(); }
+  string_view next_view() {
+    string_view result{m_addr + m_consumed, m_size - m_consumed};
+    m_consumed = m_size;
+    return result;
   }
 
-  /** \brief set the delimiter to a different character
-   *  \param delim new delimiter
+private:
+  void unmap() {
+    if (m_addr != nullptr) { ::munmap(const_cast<char*>(m_addr), m_size); }
+    m_addr = nullptr;
+  }
+
+  const char* m_addr{nullptr};
+  std::size_t m_size{0};
+  std::size_t m_consumed{0};
+  bool m_open{false};
+};
+
+#endif
+
+/** \class ByteSourceWindow
+ *  \ingroup byte_source
+ *  \brief Owns a ByteSource and exposes the current block of unread bytes
+ *
+ *  Sources providing next_view() are never copied, all others are read into
+ *  an internal block of default_block_size bytes.
+ */
+template <typename ByteSource>
+class ByteSourceWindow {
+public:
+  /** \brief construct the owned ByteSource in place
+   *  \param args arguments forwarded to the ByteSource constructor
    */
-  void set_delimiter(const char delim) { m_delim = delim; }
+  template <typename... Args,
+            typename = std::enable_if_t<std::is_constructible_v<ByteSource, Args&&...>>>
+  explicit ByteSourceWindow(Args&&... args) : m_source(std::forward<Args>(args)...) {}
 
-  /** \brief get the current delimiter
-   *  \return constant char delimiter value
+  /** \brief make sure there are unread bytes in the window
+   *  \return true if the window is non empty, false if the source is exhausted
    */
-  [[nodiscard]] char get_delimiter() const { return m_delim; }
+  bool fill() {
+    if (m_begin != m_end) { return true; }
+    if (m_exhausted) { return false; }
+
+    if constexpr (has_next_view<ByteSource>::value) {
+      const string_view view = m_source.next_view();
+      m_begin = view.data();
+      m_end = m_begin + view.size();
+    } else {
+      if (m_block.empty()) { m_block.resize(default_block_size); }
+      const std::size_t n = m_source.read(m_block.data(), m_block.size());
+      m_begin = m_block.data();
+      m_end = m_begin + n;
+    }
 
-  /** \brief check if the underlying stream is still good
-   *  \return true if good, otherwise false
+    if (m_begin == m_end) {
+      m_exhausted = true;
+    } else {
+      m_generation++;
+    }
+    return !m_exhausted;
+  }
+
+  /** \brief first unread byte */
+  [[nodiscard]] const char* begin() const { return m_begin; }
+
+  /** \brief one past the last unread byte of the current block */
+  [[nodiscard]] const char* end() const { return m_end; }
+
+  /** \brief mark everything before pos as consumed
+   *  \param pos pointer in [begin(), end()]
    */
-  bool good() { return m_csv_line_reader.good(); }
+  void consume_to(const char* pos) { m_begin = pos; }
 
-  /** \brief Get the csv headers if they exist
-   *  \return a reference to the RowContainer of headers, otherwise a RowContainer with one blank
-   * element
+  /** \brief number of blocks fetched so far, lets callers cache per block scan results
+   *  \return count of successful refills
    */
-  RowContainer<std::string>& get_header_names() { return m_header_names; }
+  [[nodiscard]] std::size_t generation() const { return m_generation; }
 
-  /** \brief Return the current RowContainer of CSV values
-   *  \return a reference to the current RowContainer
+  /** \brief access the underlying ByteSource
+   *  \return reference to the owned ByteSource
    */
-  RowContainer<std::string>& current() { return m_current; }
+  ByteSource& source() { return m_source; }
 
-  /** \brief Advance to the next row and return the current RowContainer of CSV values
-   *  \return a reference to the current RowContainer
+private:
+  ByteSource m_source;
+  std::vector<char> m_block;
+  const char* m_begin{nullptr};
+  const char* m_end{nullptr};
+  std::size_t m_generation{0};
+  bool m_exhausted{false};
+};
+
+/** \brief locate the first occurrence of a byte sequence
+ *  \ingroup utility
+ *
+ *  Single bytes are delegated to memchr. Longer sequences compare the first and
+ *  last byte of the sequence against 16 candidate positions at a time with SSE2
+ *  when available and only verify the middle bytes of candidates.
+ *
+ *  \param first start of the range to search
+ *  \param last end of the range to search
+ *  \param seq non empty sequence to find
+ *  \return pointer to the start of the first match, or last if there is none
+ */
+inline const char* find_sequence(const char* first, const char* last, string_view seq) {
+  const std::size_t k = seq.size();
+  if (k == 0 || static_cast<std::size_t>(last - first) < k) { return last; }
+
+  if (k == 1) {
+    const void* found = std::memchr(first, seq[0], static_cast<std::size_t>(last - first));
+    return found == nullptr ? last : static_cast<const char*>(found);
+  }
+
+#if defined(__SSE2__)
+  const __m128i head = _mm_set1_epi8(seq.front());
+  const __m128i tail = _mm_set1_epi8(seq.back());
+  while (last - first >= static_cast<std::ptrdiff_t>(16 + k - 1)) {
+    const __m128i block_head = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+    const __m128i block_tail = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first + k - 1));
+    auto mask = static_cast<unsigned>(_mm_movemask_epi8(
+        _mm_and_si128(_mm_cmpeq_epi8(head, block_head), _mm_cmpeq_epi8(tail, block_tail))));
+    while (mask != 0) {
+      const auto offset = static_cast<std::size_t>(__builtin_ctz(mask));
+      if (std::memcmp(first + offset + 1, seq.data() + 1, k - 2) == 0) { return first + offset; }
+      mask &= mask - 1;
+    }
+    first += 16;
+  }
+#endif
+
+  const char* const stop = last - (k - 1);
+  while (first < stop) {
+    const void* found = std::memchr(first, seq[0], static_cast<std::size_t>(stop - first));
+    if (found == nullptr) { break; }
+    first = static_cast<const char*>(found);
+    if (std::memcmp(first + 1, seq.data() + 1, k - 1) == 0) { return first; }
+    ++first;
+  }
+  return last;
+}
+
+/** \class LineTerminator
+ *  \ingroup line_reader
+ *  \brief Byte sequence ending a csv line, shared by the built-in line readers
+ *
+ *  The sequence must not contain a double quote.
+ */
+class LineTerminator {
+public:
+  /** \brief construct a LineTerminator
+   *  \param sequence single or multi byte sequence ending a line
+   *  \param keep whether readers keep the sequence at the end of returned lines
    */
-  RowContainer<std::string>& read() {
-    advance();
-    return current();
+  explicit LineTerminator(std::string sequence = "\n", bool keep = false)
+      : m_sequence(std::move(sequence)), m_keep(keep) {
+    assert(!m_sequence.empty());
   }
 
-  /** \brief Get number of csv lines read so far
-   *  \return number of csv lines read so far
+  /** \brief get the terminating sequence
+   *  \return reference to the terminating sequence
    */
-  [[nodiscard]] std::size_t lcount() const { return m_csv_line_reader.lcount(); }
+  [[nodiscard]] const std::string& str() const { return m_sequence; }
 
-protected:
-  /** \brief advance the current string and parse it
+  /** \brief length of the terminating sequence
+   *  \return number of bytes in the sequence
    */
-  void advance() {
-    m_current_str_line = m_csv_line_reader.readline();
-    parse_current_str();
+  [[nodiscard]] std::size_t size() const { return m_sequence.size(); }
+
+  /** \brief check whether readers keep the sequence in returned lines
+   *  \return true if kept, otherwise false
+   */
+  [[nodiscard]] bool keep() const { return m_keep; }
+
+  /** \brief find the first complete terminator in [first, last)
+   *  \return pointer to the start of the terminator, or last if there is none
+   */
+  [[nodiscard]] const char* find(const char* first, const char* last) const {
+    return find_sequence(first, last, m_sequence);
   }
 
-  /** \brief parse the current string line to a RowContainer
+  /** \brief check for a complete terminator starting at pos
+   *  \return true if [pos, last) starts with the terminator
    */
-  void parse_current_str() {
-    if (m_current_str_line.empty()) {
-      m_current.clear();
-      m_current.push_back("");
-      return;
+  [[nodiscard]] bool match_at(const char* pos, const char* last) const {
+    return static_cast<std::size_t>(last - pos) >= m_sequence.size() && *pos == m_sequence[0] &&
+           std::memcmp(pos, m_sequence.data(), m_sequence.size()) == 0;
+  }
+
+  /** \brief find a terminator which started in previously consumed bytes and ends in a new block
+   *  \param consumed bytes consumed so far for the current line
+   *  \param first start of the new block
+   *  \param last end of the new block
+   *  \return number of bytes of the new block completing the terminator, 0 if there is none
+   */
+  [[nodiscard]] std::size_t complete(string_view consumed, const char* first,
+                                     const char* last) const {
+    const std::size_t k = m_sequence.size();
+    if (k < 2 || consumed.empty()) { return 0; }
+
+    const auto available = static_cast<std::size_t>(last - first);
+    std::size_t start = consumed.size() > k - 1 ? consumed.size() - (k - 1) : 0;
+    for (; start < consumed.size(); ++start) {
+      const std::size_t have = consumed.size() - start;
+      const std::size_t need = k - have;
+      if (need <= available && std::memcmp(consumed.data() + start, m_sequence.data(), have) == 0 &&
+          std::memcmp(first, m_sequence.data() + have, need) == 0) {
+        return need;
+      }
     }
-    m_current = m_parse_func(m_current_str_line, m_delim);
+    return 0;
+  }
 
-    if (m_num_columns == -1) {
-      m_num_columns = static_cast<long>(m_current.size());
-    } else if (m_warn_columns &&
-               (m_current.size() !=
-                static_cast<typename RowContainer<std::string>::size_type>(m_num_columns))) {
-      std::cerr << "[warning] Column mismatch detected, further parsing may be malformed\n";
+private:
+  std::string m_sequence;
+  bool m_keep;
+};
+
+/** \class BasicCSVLineReader
+ *  \ingroup line_reader
+ *  \brief Stateful CSV line reader which reads csv lines with escaped fields according to RFC 4180
+ *
+ *  Reads from any ByteSource, a ByteSource is any type providing
+ *  std::size_t read(char* dest, std::size_t count) and optionally
+ *  string_view next_view() for zero-copy access.
+ */
+template <typename ByteSource>
+class BasicCSVLineReader {
+public:
+  /** \brief Construct a BasicCSVLineReader, constructing its ByteSource in place
+   *  \param args arguments forwarded to the ByteSource constructor
+   */
+  template <typename... Args,
+            typename = std::enable_if_t<std::is_constructible_v<ByteSource, Args&&...>>>
+  explicit BasicCSVLineReader(Args&&... args) : m_window(std::forward<Args>(args)...) {}
+
+  /** \brief read a csv line
+   *  \return a string with the contents of the csv line
+   */
+  std::string readline() {
+    m_result.clear();
+
+    bool terminated{false};
+    while (!terminated && m_window.fill()) {
+      const char* pos = m_window.begin();
+      const char* const end = m_window.end();
+
+      if (m_state == LINE) {
+        if (const std::size_t need = m_terminator.complete(m_result, pos, end); need != 0) {
+          finish_straddled(need);
+          break;
+        }
+      }
+
+      // positions too close to the end of the block are checked by complete() on the next block
+      const auto tail = static_cast<std::ptrdiff_t>(m_terminator.size() - 1);
+      const char* const last_start = (end - pos > tail) ? end - tail : pos;
+      const char first = m_terminator.str()[0];
+      const char* line_end = end;
+      for (; pos != end; ++pos) {
+        if (*pos == '\"') {
+          m_state = (m_state == LINE) ? QUOTE : LINE;
+        } else if (*pos == first && m_state == LINE && pos < last_start &&
+                   m_terminator.match_at(pos, end)) {
+          line_end = pos;
+          pos += m_terminator.size();
+          terminated = true;
+          break;
+        }
+      }
+      m_result.append(m_window.begin(), m_terminator.keep() ? pos : line_end);
+      m_window.consume_to(pos);
+    }
+
+    if (!terminated && m_state == QUOTE) {  // premature EOF inside a quoted field
+      m_state = LINE;
+      m_good = false;
+      m_result.clear();
+      return m_result;
+    }
+
+    m_good = m_window.fill();
+    m_lines_read++;
+    m_state = LINE;
+    return m_result;
+  }
+
+  /** \brief set the sequence which terminates a line
+   *  \param terminator single or multi byte terminating sequence, e.g. "\r\n" or "\x01"
+   *  \param keep_terminator keep the sequence at the end of returned lines
+   */
+  void set_line_terminator(std::string terminator, bool keep_terminator = false) {
+    m_terminator = LineTerminator(std::move(terminator), keep_terminator);
+  }
+
+  /** \brief get the sequence which terminates a line
+   *  \return reference to the terminating sequence
+   */
+  [[nodiscard]] const std::string& get_line_terminator() const { return m_terminator.str(); }
+
+  /** \brief Get number of csv lines read so far
+   *  \return number of csv lines read so far
+   */
+  [[nodiscard]] std::size_t lcount() const { return m_lines_read; }
+
+  /** \brief check if the underlying source still has data
+   *  \return true if good, otherwise false
+   */
+  bool good() { return m_good; }
+
+  /** \brief access the underlying ByteSource
+   *  \return reference to the ByteSource
+   */
+  ByteSource& source() { return m_window.source(); }
+
+private:
+  void finish_straddled(std::size_t need) {
+    if (m_terminator.keep()) {
+      m_result.append(m_window.begin(), need);
+    } else {
+      m_result.resize(m_result.size() - (m_terminator.size() - need));
+    }
+    m_window.consume_to(m_window.begin() + need);
+  }
+
+  CSVParserScope m_state{LINE};
+  ByteSourceWindow<ByteSource> m_window;
+  LineTerminator m_terminator{"\n", true};
+  std::string m_result;
+  std::size_t m_lines_read{0};
+  bool m_good{true};
+};
+
+/** \class BasicCSVSimpleLineReader
+ *  \ingroup line_reader
+ *  \brief CSV line reader which reads csv lines
+ *
+ *  This line reader is a sane alternative to the conforming line reader which
+ *  allows for newline characters in your csv fields.
+ *  If you have an insane dataset which allows newlines in the middle of fields,
+ *  I'm sorry...
+ *
+ *  This should be a slightly faster alternative for most cases.
+ */
+template <typename ByteSource>
+class BasicCSVSimpleLineReader {
+public:
+  /** \brief Construct a BasicCSVSimpleLineReader, constructing its ByteSource in place
+   *  \param args arguments forwarded to the ByteSource constructor
+   */
+  template <typename... Args,
+            typename = std::enable_if_t<std::is_constructible_v<ByteSource, Args&&...>>>
+  explicit BasicCSVSimpleLineReader(Args&&... args) : m_window(std::forward<Args>(args)...) {}
+
+  /** \brief read a csv line
+   *  \return a string with the contents of the csv line without the terminator
+   */
+  std::string readline() {
+    m_result.clear();
+
+    while (m_window.fill()) {
+      const char* const begin = m_window.begin();
+      const char* const end = m_window.end();
+
+      if (const std::size_t need = m_terminator.complete(m_result, begin, end); need != 0) {
+        if (m_terminator.keep()) {
+          m_result.append(begin, need);
+        } else {
+          m_result.resize(m_result.size() - (m_terminator.size() - need));
+        }
+        m_window.consume_to(begin + need);
+        break;
+      }
+
+      const char* const found = m_terminator.find(begin, end);
+      if (found != end) {
+        const char* const next = found + m_terminator.size();
+        m_result.append(begin, m_terminator.keep() ? next : found);
+        m_window.consume_to(next);
+        break;
+      }
+      m_result.append(begin, end);
+      m_window.consume_to(end);
+    }
+
+    m_good = m_window.fill();
+    m_lines_read++;
+    return m_result;
+  }
+
+  /** \brief set the sequence which terminates a line
+   *  \param terminator single or multi byte terminating sequence, e.g. "\r\n" or "\x01"
+   *  \param keep_terminator keep the sequence at the end of returned lines
+   */
+  void set_line_terminator(std::string terminator, bool keep_terminator = false) {
+    m_terminator = LineTerminator(std::move(terminator), keep_terminator);
+  }
+
+  /** \brief get the sequence which terminates a line
+   *  \return reference to the terminating sequence
+   */
+  [[nodiscard]] const std::string& get_line_terminator() const { return m_terminator.str(); }
+
+  /** \brief Get number of csv lines read so far
+   *  \return number of csv lines read so far
+   */
+  [[nodiscard]] std::size_t lcount() const { return m_lines_read; }
+
+  /** \brief check if the underlying source still has data
+   *  \return true if good, otherwise false
+   */
+  bool good() { return m_good; }
+
+  /** \brief access the underlying ByteSource
+   *  \return reference to the ByteSource
+   */
+  ByteSource& source() { return m_window.source(); }
+
+private:
+  ByteSourceWindow<ByteSource> m_window;
+  LineTerminator m_terminator{"\n", false};
+  std::string m_result;
+  std::size_t m_lines_read{0};
+  bool m_good{true};
+};
+
+/** \class BasicCSVHybridLineReader
+ *  \ingroup line_reader
+ *  \brief Conforming CSV line reader with a quote-free fast path
+ *
+ *  Produces the same lines as BasicCSVLineReader. The position of the next
+ *  quote in the current block is located once with memchr, every line
+ *  ending before it is split with a plain terminator search. Only the parts
+ *  of a block from a quote onward are walked quote by quote.
+ */
+template <typename ByteSource>
+class BasicCSVHybridLineReader {
+public:
+  /** \brief Construct a BasicCSVHybridLineReader, constructing its ByteSource in place
+   *  \param args arguments forwarded to the ByteSource constructor
+   */
+  template <typename... Args,
+            typename = std::enable_if_t<std::is_constructible_v<ByteSource, Args&&...>>>
+  explicit BasicCSVHybridLineReader(Args&&... args) : m_window(std::forward<Args>(args)...) {}
+
+  /** \brief read a csv line
+   *  \return a string with the contents of the csv line
+   */
+  std::string readline() {
+    m_result.clear();
+
+    bool terminated{false};
+    while (!terminated && m_window.fill()) {
+      const char* pos = m_window.begin();
+      const char* const end = m_window.end();
+      const char* line_end = end;
+
+      if (m_state == LINE) {
+        if (const std::size_t need = m_terminator.complete(m_result, pos, end); need != 0) {
+          if (m_terminator.keep()) {
+            m_result.append(pos, need);
+          } else {
+            m_result.resize(m_result.size() - (m_terminator.size() - need));
+          }
+          m_window.consume_to(pos + need);
+          break;
+        }
+      }
+
+      while (pos != end) {
+        if (m_state == QUOTE) {
+          const char* closing = find(pos, end, '\"');
+          if (closing == end) {
+            pos = end;
+            break;
+          }
+          pos = closing + 1;
+          m_state = LINE;
+          continue;
+        }
+
+        const char* quote = next_quote(pos, end);
+        const char* found = m_terminator.find(pos, quote);
+        if (found != quote) {
+          line_end = found;
+          pos = found + m_terminator.size();
+          terminated = true;
+          break;
+        }
+        if (quote == end) {
+          pos = end;
+          break;
+        }
+        pos = quote + 1;
+        m_state = QUOTE;
+      }
+
+      m_result.append(m_window.begin(), (terminated && !m_terminator.keep()) ? line_end : pos);
+      m_window.consume_to(pos);
+    }
+
+    if (!terminated && m_state == QUOTE) {  // premature EOF inside a quoted field
+      m_state = LINE;
+      m_good = false;
+      m_result.clear();
+      return m_result;
+    }
+
+    m_good = m_window.fill();
+    m_lines_read++;
+    m_state = LINE;
+    return m_result;
+  }
+
+  /** \brief set the sequence which terminates a line
+   *  \param terminator single or multi byte terminating sequence, e.g. "\r\n" or "\x01"
+   *  \param keep_terminator keep the sequence at the end of returned lines
+   */
+  void set_line_terminator(std::string terminator, bool keep_terminator = false) {
+    m_terminator = LineTerminator(std::move(terminator), keep_terminator);
+  }
+
+  /** \brief get the sequence which terminates a line
+   *  \return reference to the terminating sequence
+   */
+  [[nodiscard]] const std::string& get_line_terminator() const { return m_terminator.str(); }
+
+  /** \brief Get number of csv lines read so far
+   *  \return number of csv lines read so far
+   */
+  [[nodiscard]] std::size_t lcount() const { return m_lines_read; }
+
+  /** \brief check if the underlying source still has data
+   *  \return true if good, otherwise false
+   */
+  bool good() { return m_good; }
+
+  /** \brief access the underlying ByteSource
+   *  \return reference to the ByteSource
+   */
+  ByteSource& source() { return m_window.source(); }
+
+private:
+  static const char* find(const char* first, const char* last, char c) {
+    const void* found = std::memchr(first, c, static_cast<std::size_t>(last - first));
+    return found == nullptr ? last : static_cast<const char*>(found);
+  }
+
+  /** \brief position of the next quote at or after pos in the current block, cached per block
+   */
+  const char* next_quote(const char* pos, const char* end) {
+    if (m_quote_generation != m_window.generation() || m_next_quote < pos) {
+      m_next_quote = find(pos, end, '\"');
+      m_quote_generation = m_window.generation();
+    }
+    return m_next_quote;
+  }
+
+  CSVParserScope m_state{LINE};
+  ByteSourceWindow<ByteSource> m_window;
+  LineTerminator m_terminator{"\n", true};
+  const char* m_next_quote{nullptr};
+  std::size_t m_quote_generation{0};
+  std::string m_result;
+  std::size_t m_lines_read{0};
+  bool m_good{true};
+};
+
+/** \brief conforming line reader over a std::istream */
+using CSVLineReader = BasicCSVLineReader<IStreamByteSource>;
+
+/** \brief simple line reader over a std::istream */
+using CSVSimpleLineReader = BasicCSVSimpleLineReader<IStreamByteSource>;
+
+/** \brief conforming line reader with a quote-free fast path over a std::istream */
+using CSVHybridLineReader = BasicCSVHybridLineReader<IStreamByteSource>;
+
+/** \class CSVLineWriter
+ *  \ingroup line_writer
+ *  \brief Writes a csv line to a stream, provides a written lines counter
+ *
+ *  doesnt do much other than make the implementation symmetrical
+ *  also allows for ever greater custom behavior,
+ *  maybe some kind of custom format that prepends or appends some string before writing
+ */
+class CSVLineWriter {
+public:
+  /** \brief Construct a CSVLineWriter from an outstream
+   *  \param outstream ostream to write lines to
+   */
+  explicit CSVLineWriter(std::ostream& outstream) : m_csv_stream(outstream) {}
+
+  /** \brief write a csv line to the stream
+   *  \param line line to write to stream
+   */
+  void writeline(string_view line) {
+    if (good()) {
+      m_csv_stream.write(line.data(), static_cast<std::streamsize>(line.length()));
+      m_lines_written++;
+    }
+  }
+
+  /** \brief write several complete csv lines to the stream in one call
+   *  \param lines concatenated lines
+   *  \param count number of lines
+   */
+  void writelines(string_view lines, std::size_t count) {
+    if (good()) {
+      m_csv_stream.write(lines.data(), static_cast<std::streamsize>(lines.length()));
+      m_lines_written += count;
+    }
+  }
+
+  /** \brief check if the underlying stream is still good
+   *  \return true if good, otherwise false
+   */
+  bool good() { return m_csv_stream.good(); }
+
+  /** \brief Get number of csv lines written so far
+   *  \return number of csv lines written so far
+   */
+  [[nodiscard]] std::size_t lcount() const { return m_lines_written; }
+
+private:
+  std::ostream& m_csv_stream;
+  std::size_t m_lines_written{0};
+};
+
+/** \brief detect LineWriters which accept several lines in one writelines(lines, count) call
+ *  \ingroup line_writer
+ */
+template <typename LineWriter, typename = void>
+struct has_writelines : std::false_type {};
+
+template <typename LineWriter>
+struct has_writelines<LineWriter, std::void_t<decltype(std::declval<LineWriter&>().writelines(
+                                      std::declval<string_view>(), std::size_t{}))>>
+    : std::true_type {};
+
+/** \brief default capacity of the buffer used by buffered line writers
+ *  \ingroup byte_sink
+ */
+inline constexpr std::size_t default_write_buffer_size = std::size_t{1} << 20;
+
+/** \brief detect whether a ByteSink can gather several buffers into one write through writev()
+ *  \ingroup byte_sink
+ */
+template <typename ByteSink, typename = void>
+struct has_writev : std::false_type {};
+
+template <typename ByteSink>
+struct has_writev<ByteSink, std::void_t<decltype(std::declval<ByteSink&>().writev(
+                                std::declval<const string_view*>(), std::size_t{}))>>
+    : std::true_type {};
+
+/** \class OStreamByteSink
+ *  \ingroup byte_sink
+ *  \brief ByteSink writing blocks to a std::ostream
+ */
+class OStreamByteSink {
+public:
+  /** \brief Construct an OStreamByteSink from a reference to a ostream
+   *  \param outstream reference to a ostream
+   */
+  explicit OStreamByteSink(std::ostream& outstream) : m_stream(outstream) {}
+
+  /** \brief write count bytes from data
+   *  \return true if the stream is still good
+   */
+  bool write(const char* data, std::size_t count) {
+    m_stream.write(data, static_cast<std::streamsize>(count));
+    return m_stream.good();
+  }
+
+  /** \brief check if the underlying stream is still good
+   *  \return true if good, otherwise false
+   */
+  bool good() { return m_stream.good(); }
+
+private:
+  std::ostream& m_stream;
+};
+
+/** \class FileByteSink
+ *  \ingroup byte_sink
+ *  \brief ByteSink writing blocks to a C FILE*, the FILE* is not owned
+ */
+class FileByteSink {
+public:
+  /** \brief Construct a FileByteSink from an open FILE*
+   *  \param file open FILE* to write to
+   */
+  explicit FileByteSink(std::FILE* file) : m_file(file) {}
+
+  /** \brief write count bytes from data
+   *  \return true if everything was written
+   */
+  bool write(const char* data, std::size_t count) {
+    return m_file != nullptr && std::fwrite(data, 1, count, m_file) == count;
+  }
+
+  /** \brief check if the FILE* has no error set
+   *  \return true if good, otherwise false
+   */
+  bool good() { return m_file != nullptr && std::ferror(m_file) == 0; }
+
+private:
+  std::FILE* m_file;
+};
+
+#if defined(__unix__) || defined(__APPLE__)
+
+/** \class FdByteSink
+ *  \ingroup byte_sink
+ *  \brief ByteSink writing to a POSIX file descriptor, the descriptor is not owned
+ */
+class FdByteSink {
+public:
+  /** \brief Construct a FdByteSink from an open file descriptor
+   *  \param fd open file descriptor to write to
+   */
+  explicit FdByteSink(int fd) : m_fd(fd) {}
+
+  /** \brief write count bytes from data, retrying on EINTR and short writes
+   *  \return true if everything was written
+   */
+  bool write(const char* data, std::size_t count) {
+    const string_view part{data, count};
+    return writev(&part, 1);
+  }
+
+  /** \brief write several buffers with as few writev calls as possible
+   *  \param parts buffers to write in order
+   *  \param count number of buffers
+   *  \return true if everything was written
+   */
+  bool writev(const string_view* parts, std::size_t count) {
+    if (m_fd < 0) { return false; }
+
+    // gather at most max_iov buffers per call into a stack array, well below any IOV_MAX
+    iovec iov[max_iov];
+    for (std::size_t first = 0; first < count; first += max_iov) {
+      const std::size_t group = std::min(max_iov, count - first);
+      for (std::size_t i = 0; i < group; i++) {
+        iov[i].iov_base = const_cast<char*>(parts[first + i].data());
+        iov[i].iov_len = parts[first + i].size();
+      }
+      if (!writev_all(iov, static_cast<int>(group))) {
+        m_good = false;
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /** \brief check if no write has failed so far
+   *  \return true if good, otherwise false
+   */
+  bool good() { return m_fd >= 0 && m_good; }
+
+private:
+  static constexpr std::size_t max_iov = 64;
+
+  bool writev_all(iovec* current, int remaining) {
+    while (remaining > 0) {
+      const ssize_t n = ::writev(m_fd, current, remaining);
+      if (n < 0) {
+        if (errno == EINTR) { continue; }
+        return false;
+      }
+      auto written = static_cast<std::size_t>(n);
+      while (remaining > 0 && written >= current->iov_len) {
+        written -= current->iov_len;
+        ++current;
+        --remaining;
+      }
+      if (remaining > 0) {
+        current->iov_base = static_cast<char*>(current->iov_base) + written;
+        current->iov_len -= written;
+      }
+    }
+    return true;
+  }
+
+  int m_fd;
+  bool m_good{true};
+};
+
+/** \class PreallocatedFileByteSink
+ *  \ingroup byte_sink
+ *  \brief ByteSink owning a file which is preallocated up front and written at explicit offsets
+ *
+ *  Meant for large exports whose size is roughly known. The file is allocated with
+ *  fallocate() on Linux to avoid fragmentation, written with pwrite() and truncated to the
+ *  end of the furthest write on close, so an overestimated size leaves no trailing bytes.
+ *
+ *  write() appends like any other ByteSink. Several threads may instead claim disjoint
+ *  regions with reserve() and fill them concurrently with write_at().
+ */
+class PreallocatedFileByteSink {
+public:
+  /** \brief create or truncate the file at path and preallocate expected_size bytes
+   *  \param path path of the file to write
+   *  \param expected_size number of bytes to preallocate, 0 to skip preallocation
+   */
+  explicit PreallocatedFileByteSink(const std::string& path, std::uint64_t expected_size = 0)
+      : m_fd(::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644)) {
+#if defined(__linux__)
+    // only a hint, filesystems without fallocate support still work
+    if (m_fd >= 0 && expected_size != 0) {
+      static_cast<void>(::fallocate(m_fd, 0, 0, static_cast<off_t>(expected_size)));
+    }
+#else
+    static_cast<void>(expected_size);
+#endif
+  }
+
+  PreallocatedFileByteSink(const PreallocatedFileByteSink&) = delete;
+  PreallocatedFileByteSink& operator=(const PreallocatedFileByteSink&) = delete;
+
+  ~PreallocatedFileByteSink() { close(); }
+
+  /** \brief check whether the file was opened
+   *  \return true if open, otherwise false
+   */
+  [[nodiscard]] bool is_open() const { return m_fd >= 0; }
+
+  /** \brief claim the next count bytes of the file
+   *  \param count size of the region
+   *  \return offset of the region
+   */
+  std::uint64_t reserve(std::size_t count) {
+    return m_offset.fetch_add(count, std::memory_order_relaxed);
+  }
+
+  /** \brief append count bytes from data
+   *  \return true if everything was written
+   */
+  bool write(const char* data, std::size_t count) { return write_at(data, count, reserve(count)); }
+
+  /** \brief write count bytes from data at offset, safe to call from several threads
+   *  \param data bytes to write
+   *  \param count number of bytes
+   *  \param offset position in the file
+   *  \return true if everything was written
+   */
+  bool write_at(const char* data, std::size_t count, std::uint64_t offset) {
+    if (m_fd < 0) { return false; }
+    const std::uint64_t end = offset + count;
+    while (count > 0) {
+      const ssize_t n = ::pwrite(m_fd, data, count, static_cast<off_t>(offset));
+      if (n < 0) {
+        if (errno == EINTR) { continue; }
+        m_good.store(false, std::memory_order_relaxed);
+        return false;
+      }
+      data += n;
+      count -= static_cast<std::size_t>(n);
+      offset += static_cast<std::uint64_t>(n);
+    }
+
+    std::uint64_t current = m_end.load(std::memory_order_relaxed);
+    while (current < end &&
+           !m_end.compare_exchange_weak(current, end, std::memory_order_relaxed)) {}
+    return true;
+  }
+
+  /** \brief truncate the file to the end of the furthest write and close it
+   *  \return true if every write and the truncation succeeded
+   */
+  bool close() {
+    if (m_fd < 0) { return false; }
+    if (::ftruncate(m_fd, static_cast<off_t>(m_end.load())) != 0) { m_good = false; }
+    if (::close(m_fd) != 0) { m_good = false; }
+    m_fd = -1;
+    return m_good;
+  }
+
+  /** \brief check if the file is open and no write has failed so far
+   *  \return true if good, otherwise false
+   */
+  bool good() { return m_fd >= 0 && m_good.load(std::memory_order_relaxed); }
+
+  /** \brief get the end of the furthest write, the size of the file once closed
+   *  \return size in bytes
+   */
+  [[nodiscard]] std::uint64_t size() const { return m_end.load(); }
+
+private:
+  int m_fd;
+  std::atomic<bool> m_good{true};
+  std::atomic<std::uint64_t> m_offset{0};
+  std::atomic<std::uint64_t> m_end{0};
+};
+
+#endif
+
+/** \struct FlushPolicy
+ *  \ingroup line_writer
+ *  \brief Decides when a buffered line writer hands its buffer to the ByteSink
+ *
+ *  Independent of the policy the buffer is always flushed when it is full,
+ *  on flush() and on destruction.
+ */
+struct FlushPolicy {
+  enum Mode { BYTES, ROWS, EXPLICIT };
+
+  /** \brief flush once at least count bytes are buffered */
+  static FlushPolicy bytes(std::size_t count) { return {BYTES, count}; }
+
+  /** \brief flush after every count rows */
+  static FlushPolicy rows(std::size_t count) { return {ROWS, count}; }
+
+  /** \brief only flush when asked to, or when the buffer is full */
+  static FlushPolicy manual() { return {EXPLICIT, 0}; }
+
+  Mode mode{EXPLICIT};
+  std::size_t threshold{0};
+};
+
+/** \class BasicCSVBufferedLineWriter
+ *  \ingroup line_writer
+ *  \brief Accumulates csv lines in a large buffer and writes it to a ByteSink in one call
+ *
+ *  A ByteSink is any type providing bool write(const char* data, std::size_t count)
+ *  and bool good(), optionally bool writev(const string_view* parts, std::size_t count).
+ *  Lines larger than the buffer are written straight through.
+ */
+template <typename ByteSink>
+class BasicCSVBufferedLineWriter {
+public:
+  /** \brief Construct a BasicCSVBufferedLineWriter, constructing its ByteSink in place
+   *  \param args arguments forwarded to the ByteSink constructor
+   */
+  template <typename... Args,
+            typename = std::enable_if_t<std::is_constructible_v<ByteSink, Args&&...>>>
+  explicit BasicCSVBufferedLineWriter(Args&&... args) : m_sink(std::forward<Args>(args)...) {
+    m_buffer.reserve(m_buffer_size);
+  }
+
+  BasicCSVBufferedLineWriter(const BasicCSVBufferedLineWriter&) = delete;
+  BasicCSVBufferedLineWriter& operator=(const BasicCSVBufferedLineWriter&) = delete;
+
+  ~BasicCSVBufferedLineWriter() { flush(); }
+
+  /** \brief buffer a csv line, flushing according to the flush policy
+   *  \param line line to write
+   */
+  void writeline(string_view line) {
+    if (!good()) { return; }
+
+    if (m_buffer.size() + line.size() > m_buffer_size) {
+      if (line.size() >= m_buffer_size) {
+        write_through(line);
+        m_lines_written++;
+        return;
+      }
+      flush();
+    }
+
+    m_buffer.append(line.data(), line.size());
+    m_lines_written++;
+    m_pending_rows++;
+
+    if ((m_policy.mode == FlushPolicy::BYTES && m_buffer.size() >= m_policy.threshold) ||
+        (m_policy.mode == FlushPolicy::ROWS && m_pending_rows >= m_policy.threshold)) {
+      flush();
+    }
+  }
+
+  /** \brief buffer several complete csv lines at once, flushing according to the flush policy
+   *  \param lines concatenated lines
+   *  \param count number of lines
+   */
+  void writelines(string_view lines, std::size_t count) {
+    if (!good()) { return; }
+
+    if (m_buffer.size() + lines.size() > m_buffer_size) {
+      if (lines.size() >= m_buffer_size) {
+        write_through(lines);
+        m_lines_written += count;
+        return;
+      }
+      flush();
+    }
+
+    m_buffer.append(lines.data(), lines.size());
+    m_lines_written += count;
+    m_pending_rows += count;
+
+    if ((m_policy.mode == FlushPolicy::BYTES && m_buffer.size() >= m_policy.threshold) ||
+        (m_policy.mode == FlushPolicy::ROWS && m_pending_rows >= m_policy.threshold)) {
+      flush();
+    }
+  }
+
+  /** \brief write all buffered lines to the ByteSink
+   *  \return true if the sink is still good
+   */
+  bool flush() {
+    if (!m_buffer.empty() && m_good) { m_good = m_sink.write(m_buffer.data(), m_buffer.size()); }
+    m_buffer.clear();
+    m_pending_rows = 0;
+    return good();
+  }
+
+  /** \brief set when the buffer is written out
+   *  \param policy new flush policy
+   */
+  void set_flush_policy(FlushPolicy policy) { m_policy = policy; }
+
+  /** \brief get the current flush policy
+   *  \return the flush policy
+   */
+  [[nodiscard]] FlushPolicy get_flush_policy() const { return m_policy; }
+
+  /** \brief change the capacity of the buffer, flushing it first
+   *  \param size new capacity in bytes
+   */
+  void set_buffer_size(std::size_t size) {
+    flush();
+    m_buffer_size = size;
+    m_buffer.shrink_to_fit();
+    m_buffer.reserve(size);
+  }
+
+  /** \brief get the capacity of the buffer
+   *  \return capacity in bytes
+   */
+  [[nodiscard]] std::size_t get_buffer_size() const { return m_buffer_size; }
+
+  /** \brief number of bytes waiting to be flushed
+   *  \return buffered byte count
+   */
+  [[nodiscard]] std::size_t buffered() const { return m_buffer.size(); }
+
+  /** \brief check if the underlying sink is still good
+   *  \return true if good, otherwise false
+   */
+  bool good() { return m_good && m_sink.good(); }
+
+  /** \brief Get number of csv lines written so far, including buffered lines
+   *  \return number of csv lines written so far
+   */
+  [[nodiscard]] std::size_t lcount() const { return m_lines_written; }
+
+  /** \brief access the underlying ByteSink
+   *  \return reference to the ByteSink
+   */
+  ByteSink& sink() { return m_sink; }
+
+private:
+  void write_through(string_view line) {
+    if constexpr (has_writev<ByteSink>::value) {
+      const string_view parts[2]{string_view{m_buffer}, line};
+      const std::size_t first = m_buffer.empty() ? 1 : 0;
+      m_good = m_sink.writev(parts + first, 2 - first);
+    } else {
+      flush();
+      if (m_good) { m_good = m_sink.write(line.data(), line.size()); }
+    }
+    m_buffer.clear();
+    m_pending_rows = 0;
+  }
+
+  ByteSink m_sink;
+  std::string m_buffer;
+  std::size_t m_buffer_size{default_write_buffer_size};
+  FlushPolicy m_policy{};
+  std::size_t m_pending_rows{0};
+  std::size_t m_lines_written{0};
+  bool m_good{true};
+};
+
+/** \brief buffered line writer over a std::ostream */
+using CSVBufferedLineWriter = BasicCSVBufferedLineWriter<OStreamByteSink>;
+
+/** \class RotatingFileLineWriter
+ *  \ingroup line_writer
+ *  \brief Writes csv lines to a file and rotates it once it reaches a size limit
+ *
+ *  On rotation path.N-1 is renamed to path.N down to path becoming path.1, the oldest file
+ *  is removed and a new path is started with the header set by set_header(). A line is never
+ *  split across files, so a file only exceeds the limit when a single line does.
+ */
+class RotatingFileLineWriter {
+public:
+  /** \brief Construct a RotatingFileLineWriter, path is truncated
+   *  \param path file to write to
+   *  \param max_bytes size at which the file is rotated, 0 never rotates
+   *  \param max_files number of rotated files to keep next to path
+   */
+  explicit RotatingFileLineWriter(std::string path, std::size_t max_bytes,
+                                  std::size_t max_files = 5)
+      : m_path(std::move(path)), m_max_bytes(max_bytes), m_max_files(max_files),
+        m_file(m_path, std::ios::binary | std::ios::trunc) {}
+
+  /** \brief write a csv line, rotating first if it would not fit in the current file
+   *  \param line line to write
+   */
+  void writeline(string_view line) {
+    if (m_max_bytes != 0 && m_bytes != 0 && m_bytes + line.size() > m_max_bytes) { rotate(); }
+    if (good()) {
+      m_file.write(line.data(), static_cast<std::streamsize>(line.size()));
+      m_bytes += line.size();
+      m_lines_written++;
+    }
+  }
+
+  /** \brief write several complete csv lines, rotating between lines where they do not fit
+   *  \param lines concatenated lines
+   *  \param count number of lines
+   */
+  void writelines(string_view lines, std::size_t count) {
+    if (m_max_bytes == 0 || m_bytes + lines.size() <= m_max_bytes) {
+      if (good()) {
+        m_file.write(lines.data(), static_cast<std::streamsize>(lines.size()));
+        m_bytes += lines.size();
+        m_lines_written += count;
+      }
+      return;
+    }
+
+    // a newline inside a quoted field does not end the line
+    bool quoted{false};
+    std::size_t line_start{0};
+    for (std::size_t i = 0; i < lines.size(); i++) {
+      if (lines[i] == '"') {
+        quoted = !quoted;
+      } else if (lines[i] == '\n' && !quoted) {
+        writeline(lines.substr(line_start, i + 1 - line_start));
+        line_start = i + 1;
+      }
+    }
+    if (line_start < lines.size()) { writeline(lines.substr(line_start)); }
+  }
+
+  /** \brief set a line written at the start of every file created by a rotation
+   *  \param header line including its terminator
+   */
+  void set_header(std::string header) { m_header = std::move(header); }
+
+  /** \brief close the current file, shift the rotated files and start a new file
+   */
+  void rotate() {
+    m_file.close();
+    if (m_max_files != 0) {
+      std::remove(rotated_path(m_max_files).c_str());
+      for (std::size_t i = m_max_files; i > 1; i--) {
+        std::rename(rotated_path(i - 1).c_str(), rotated_path(i).c_str());
+      }
+      std::rename(m_path.c_str(), rotated_path(1).c_str());
+    }
+    m_file.open(m_path, std::ios::binary | std::ios::trunc);
+    m_bytes = 0;
+    m_rotations++;
+    if (!m_header.empty() && good()) {
+      m_file.write(m_header.data(), static_cast<std::streamsize>(m_header.size()));
+      m_bytes += m_header.size();
+    }
+  }
+
+  /** \brief flush the current file
+   */
+  void flush() { m_file.flush(); }
+
+  /** \brief check if the current file is still good
+   *  \return true if good, otherwise false
+   */
+  bool good() { return m_file.good(); }
+
+  /** \brief Get number of csv lines written so far, over all files
+   *  \return number of csv lines written so far
+   */
+  [[nodiscard]] std::size_t lcount() const { return m_lines_written; }
+
+  /** \brief Get number of rotations so far
+   *  \return number of rotations
+   */
+  [[nodiscard]] std::size_t rotations() const { return m_rotations; }
+
+  /** \brief path of the n-th rotated file
+   *  \param n index of the rotated file, 1 is the most recent
+   *  \return path with .n appended
+   */
+  [[nodiscard]] std::string rotated_path(std::size_t n) const {
+    return m_path + '.' + std::to_string(n);
+  }
+
+private:
+  std::string m_path;
+  std::size_t m_max_bytes;
+  std::size_t m_max_files;
+  std::ofstream m_file;
+  std::string m_header;
+  std::size_t m_bytes{0};
+  std::size_t m_lines_written{0};
+  std::size_t m_rotations{0};
+};
+
+/** \brief default size of the chunks shared writers append in one writeline() call
+ *  \ingroup line_writer
+ */
+inline constexpr std::size_t default_chunk_size = std::size_t{1} << 16;
+
+/** \brief default number of slots of the queue used by asynchronous writers
+ *  \ingroup async
+ */
+inline constexpr std::size_t default_async_queue_capacity = 8192;
+
+/** \brief what an asynchronous writer does with a row when its queue is full
+ *  \ingroup async
+ */
+enum QueueFullPolicy { BLOCK, DROP, GROW };
+
+/** \class BoundedMPSCQueue
+ *  \ingroup async
+ *  \brief Bounded lock-free queue for many producer threads and a single consumer thread
+ *
+ *  Every slot carries a sequence number, producers claim a slot with one compare and swap
+ *  on the enqueue position and publish it by bumping the sequence. The capacity is rounded
+ *  up to a power of two.
+ */
+template <typename T>
+class BoundedMPSCQueue {
+public:
+  /** \brief construct a queue with at least capacity slots
+   *  \param capacity minimum number of slots
+   */
+  explicit BoundedMPSCQueue(std::size_t capacity = default_async_queue_capacity) {
+    std::size_t size{2};
+    while (size < capacity) { size <<= 1; }
+    m_mask = size - 1;
+    m_cells = std::make_unique<Cell[]>(size);
+    for (std::size_t i = 0; i < size; i++) {
+      m_cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  BoundedMPSCQueue(const BoundedMPSCQueue&) = delete;
+  BoundedMPSCQueue& operator=(const BoundedMPSCQueue&) = delete;
+
+  /** \brief try to enqueue a value, safe to call from any thread
+   *  \param value value to move into the queue, left untouched when the queue is full
+   *  \return true if enqueued, false if the queue is full
+   */
+  bool try_push(T&& value) { return try_exchange(value); }
+
+  /** \brief try to enqueue a value by swapping it with the contents of a free slot
+   *
+   *  try_pop() leaves the consumer's previous value in the slot, so a producer which
+   *  exchanges a buffer gets back one the consumer is done with and keeps its capacity.
+   *  \param value value to enqueue, receives the slot's previous contents on success and is
+   *  left untouched when the queue is full
+   *  \return true if enqueued, false if the queue is full
+   */
+  bool try_exchange(T& value) {
+    std::size_t pos = m_enqueue_pos.load(std::memory_order_relaxed);
+    Cell* cell{nullptr};
+    while (true) {
+      cell = &m_cells[pos & m_mask];
+      const std::size_t seq = cell->sequence.load(std::memory_order_acquire);
+      const auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+      if (diff == 0) {
+        if (m_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) { break; }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = m_enqueue_pos.load(std::memory_order_relaxed);
+      }
+    }
+    using std::swap;
+    swap(cell->value, value);
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  /** \brief try to dequeue a value, only the consumer thread may call this
+   *  \param value receives the dequeued value, its previous contents are left in the slot
+   *  for a later try_exchange()
+   *  \return true if a value was dequeued, false if the queue is empty
+   */
+  bool try_pop(T& value) {
+    Cell& cell = m_cells[m_dequeue_pos & m_mask];
+    if (cell.sequence.load(std::memory_order_acquire) != m_dequeue_pos + 1) { return false; }
+    using std::swap;
+    swap(cell.value, value);
+    cell.sequence.store(m_dequeue_pos + m_mask + 1, std::memory_order_release);
+    m_dequeue_pos++;
+    return true;
+  }
+
+  /** \brief check for a value ready to dequeue, only the consumer thread may call this
+   *  \return true if try_pop would fail
+   */
+  [[nodiscard]] bool empty() const {
+    return m_cells[m_dequeue_pos & m_mask].sequence.load(std::memory_order_acquire) !=
+           m_dequeue_pos + 1;
+  }
+
+  /** \brief number of slots
+   *  \return capacity of the queue
+   */
+  [[nodiscard]] std::size_t capacity() const { return m_mask + 1; }
+
+private:
+  struct Cell {
+    std::atomic<std::size_t> sequence{0};
+    T value{};
+  };
+
+  std::unique_ptr<Cell[]> m_cells;
+  std::size_t m_mask{0};
+  alignas(64) std::atomic<std::size_t> m_enqueue_pos{0};
+  alignas(64) std::size_t m_dequeue_pos{0};
+};
+
+/** \struct MapKeyPolicy
+ *  \ingroup writer
+ *  \brief Decides what a map writer does with keys missing from a row or not in the header
+ *
+ *  IGNORE writes an empty field for a missing key and drops an extra key, WARN does the
+ *  same and prints a warning, SKIP_ROW does not write the row.
+ */
+struct MapKeyPolicy {
+  enum Action { IGNORE, WARN, SKIP_ROW };
+
+  Action missing{WARN};
+  Action extra{WARN};
+};
+
+}  // namespace util
+
+/** \struct ColumnBinding
+ *  \ingroup binding
+ *  \brief Associates a csv column name with a data member of a struct
+ */
+template <typename Class, typename Member>
+struct ColumnBinding {
+  using class_type = Class;
+  using member_type = Member;
+
+  const char* name;
+  Member Class::*member;
+};
+
+/** \brief create a ColumnBinding
+ *  \ingroup binding
+ *  \param name csv column name
+ *  \param member pointer to the bound data member
+ *  \return binding of name to member
+ */
+template <typename Class, typename Member>
+constexpr ColumnBinding<Class, Member> column(const char* name, Member Class::*member) {
+  return {name, member};
+}
+
+/** \struct StructBinding
+ *  \ingroup binding
+ *  \brief Specialize for a struct to read and write it directly as a csv row
+ *
+ *  The specialization provides a constexpr tuple of ColumnBinding in csv column order:
+ *
+ *      template <>
+ *      struct csvio::StructBinding<Trade> {
+ *        static constexpr auto columns =
+ *            std::make_tuple(csvio::column("id", &Trade::id), csvio::column("px", &Trade::px));
+ *      };
+ *
+ *  Every field is converted with util::parse_field and util::append_field,
+ *  selected at compile time from the member type.
+ */
+template <typename T>
+struct StructBinding {};
+
+/** \brief detect structs with a StructBinding specialization
+ *  \ingroup binding
+ */
+template <typename T, typename = void>
+struct has_struct_binding : std::false_type {};
+
+template <typename T>
+struct has_struct_binding<T, std::void_t<decltype(StructBinding<T>::columns)>> : std::true_type {};
+
+/** \class CSVReader
+ *  \ingroup reader
+ *  \brief Reader to read a stream as CSV
+ */
+template <template <class...> class RowContainer = std::vector,
+          typename LineReader = csvio::util::CSVLineReader,
+          typename Parser = csvio::util::DelimSplitUnescaped<RowContainer>>
+class CSVReader {
+public:
+  /** \class iterator
+   *  \brief CSVReader iterator
+   */
+  struct iterator {
+    /** \brief construct a CSVReader iterator
+     *  This default is used for the end iterator
+     */
+    iterator() { m_good = false; }
+
+    /** \brief parameterized constructor that takes a pointer to a CSVReader
+     *  \param ptr pointer to a valid non-nullptr CSVReader iterator
+     */
+    explicit iterator(CSVReader* ptr) : m_ptr(ptr) {
+      m_ptr->read();
+      m_good = m_ptr->good();
+    }
+
+    /** \brief increment this CSVReader iterator
+     *  \return the iteration of CSVReader
+     */
+    iterator operator++() {
+      m_ptr->read();
+      m_good = m_ptr->good();
+      return *this;
+    }
+
+    /** \brief Comparison to check for end
+     *  \param other const ref to a CSVReader iterator
+     *  \return true if the iterator is still good; otherwise false
+     */
+    bool operator!=(const iterator& other) const { return m_good != other.m_good; }
+
+    /** \brief return the current RowContainer reference from this iterator
+     *  \return a reference to the current RowContainer
+     */
+    RowContainer<std::string>& operator*() const { return m_ptr->current(); }
+
+    /** \brief return the current RowContainer pointed to by this iterator
+     *  \return a pointer to the current RowContainer
+     */
+    RowContainer<std::string>* operator->() const { return &m_ptr->current(); }
+
+    CSVReader* m_ptr;
+    bool m_good{true};
+  };
+
+  /** \brief the begin CSVReader iterator
+   *  \return iterator with the begin CSVReader
+   */
+  iterator begin() { return iterator(this); }
+
+  /** \brief the end CSVReader iterator
+   *  \return default constructed end iterator
+   */
+  iterator end() const { return iterator(); }
+
+  /** \brief Construct a CSVReader from a reference to a generic LineReader
+   *  \param line_reader reference to a LineReader
+   *  \param delimiter a character delimiter
+   *  \param has_header specify that this csv has a header
+   *  \param warn_columns warn in case of mismatched columns
+   *  \param parse_func a function which describes how to split a csv row
+   */
+  explicit CSVReader(LineReader& line_reader, const char delimiter = ',', bool has_header = false,
+                     bool warn_columns = true)
+      : m_csv_line_reader(line_reader), m_delim(delimiter), m_has_header(has_header),
+        m_warn_columns(warn_columns) {
+    if (m_has_header) { handle_header(); }
+  }
+
+  /** \brief set the delimiter to a different character
+   *  \param delim new delimiter
+   */
+  void set_delimiter(const char delim) { m_delim = delim; }
+
+  /** \brief get the current delimiter
+   *  \return constant char delimiter value
+   */
+  [[nodiscard]] char get_delimiter() const { return m_delim; }
+
+  /** \brief check if the underlying stream is still good
+   *  \return true if good, otherwise false
+   */
+  bool good() { return m_csv_line_reader.good(); }
+
+  /** \brief Get the csv headers if they exist
+   *  \return a reference to the RowContainer of headers, otherwise a RowContainer with one blank
+   * element
+   */
+  RowContainer<std::string>& get_header_names() { return m_header_names; }
+
+  /** \brief Return the current RowContainer of CSV values
+   *  \return a reference to the current RowContainer
+   */
+  RowContainer<std::string>& current() { return m_current; }
+
+  /** \brief Advance to the next row and return the current RowContainer of CSV values
+   *  \return a reference to the current RowContainer
+   */
+  RowContainer<std::string>& read() {
+    advance();
+    return current();
+  }
+
+  /** \brief Get number of csv lines read so far
+   *  \return number of csv lines read so far
+   */
+  [[nodiscard]] std::size_t lcount() const { return m_csv_line_reader.lcount(); }
+
+  /** \brief Advance to the next row and convert it into a struct with a StructBinding
+   *
+   *  Columns are matched by name when the csv has a header, otherwise by position.
+   *  Fields which fail to convert are reported like column mismatches.
+   *
+   *  \param value struct to fill
+   *  \return true if a row was read, false on a blank line
+   */
+  template <typename T>
+  bool read_struct(T& value) {
+    static_assert(has_struct_binding<T>::value, "read_struct requires a StructBinding<T>");
+    advance();
+    if (m_current_str_line.empty()) { return false; }
+
+    const auto& columns = struct_columns<T>();
+    util::for_each_indexed(StructBinding<T>::columns, [&](const auto& binding, std::size_t i) {
+      const std::size_t index = columns[i];
+      if (index >= m_current.size()) { return; }
+      if (!util::parse_field(field_at(index), value.*(binding.member)) && m_warn_columns) {
+        std::cerr << "[warning] Could not convert field for column " << binding.name << '\n';
+      }
+    });
+    return true;
+  }
+
+  /** \brief read every remaining row into structs with a StructBinding
+   *  \return vector of converted rows, blank lines are skipped
+   */
+  template <typename T>
+  std::vector<T> read_structs() {
+    std::vector<T> result;
+    while (good()) {
+      T value{};
+      if (read_struct(value)) { result.push_back(std::move(value)); }
+    }
+    return result;
+  }
+
+protected:
+  /** \brief get an unescaped field of the current row
+   */
+  string_view field_at(std::size_t index) {
+    if constexpr (util::has_index_operator<RowContainer<std::string>>::value) {
+      return m_current[index];
+    } else {
+      return *std::next(m_current.begin(), static_cast<std::ptrdiff_t>(index));
+    }
+  }
+
+  /** \brief resolve the row index of every bound column of T, cached until T changes
+   */
+  template <typename T>
+  const std::vector<std::size_t>& struct_columns() {
+    static const char tag{};
+    if (m_struct_tag == &tag) { return m_struct_columns; }
+
+    m_struct_tag = &tag;
+    m_struct_columns.clear();
+    util::for_each_indexed(StructBinding<T>::columns, [&](const auto& binding, std::size_t i) {
+      if (!m_has_header) {
+        m_struct_columns.push_back(i);
+        return;
+      }
+      m_struct_columns.push_back(util::find_column(m_header_names, binding.name, m_warn_columns));
+    });
+    return m_struct_columns;
+  }
+
+  /** \brief advance the current string and parse it
+   */
+  void advance() {
+    m_current_str_line = m_csv_line_reader.readline();
+    parse_current_str();
+  }
+
+  /** \brief parse the current string line to a RowContainer
+   */
+  void parse_current_str() {
+    if (m_current_str_line.empty()) {
+      m_current.clear();
+      m_current.push_back("");
+      return;
+    }
+    if constexpr (util::has_parse_into<Parser, RowContainer<std::string>>::value) {
+      m_parse_func.parse_into(m_current, m_current_str_line, m_delim);
+    } else {
+      m_current = m_parse_func(m_current_str_line, m_delim);
+    }
+
+    if (m_num_columns == -1) {
+      m_num_columns = static_cast<long>(m_current.size());
+    } else if (m_warn_columns &&
+               (m_current.size() !=
+                static_cast<typename RowContainer<std::string>::size_type>(m_num_columns))) {
+      std::cerr << "[warning] Column mismatch detected, further parsing may be malformed\n";
+    }
+  }
+
+  /** \brief handle reading and parsing the header if has_header is true
+   */
+  void handle_header() {
+    m_current_str_line = m_csv_line_reader.readline();
+    m_header_names = m_parse_func(m_current_str_line, m_delim);
+    m_num_columns = static_cast<long>(m_header_names.size());
+    m_current_str_line = "";
+  }
+
+  LineReader& m_csv_line_reader;
+
+  char m_delim;
+  bool m_has_header;
+  bool m_warn_columns;
+
+  Parser m_parse_func;
+  std::string m_current_str_line;
+  long m_num_columns{-1};
+
+  RowContainer<std::string> m_header_names{""};
+  RowContainer<std::string> m_current{""};
+
+  const void* m_struct_tag{nullptr};
+  std::vector<std::size_t> m_struct_columns;
+};
+
+/** \class CSVWriter
+ *  \ingroup writer
+ *  \brief Writes data as csv
+ */
+template <template <class...> class RowContainer = std::vector,
+          class LineWriter = csvio::util::CSVLineWriter,
+          class Formatter = csvio::util::DelimJoinEscapedFormat<RowContainer>>
+class CSVWriter {
+public:
+  /** \brief construct a CSVWriter from a LineWriter
+   *  \param line_writer reference to a LineWriter object
+   *  \param delimiter output delimiter to use to delimit ouput
+   *  \param warn_columns whether warning should be printed in the case of column mismatch
+   *  \param line_terminator sequence that denotes the end of a csv row
+   *  \param format_func a function to format a container to an output csv string
+   */
+  explicit CSVWriter(LineWriter& line_writer, const char delimiter = ',', bool warn_columns = true,
+                     std::string line_terminator = "\r\n")
+      : m_delim(delimiter), m_warn_columns(warn_columns),
+        m_line_terminator(std::move(line_terminator)), m_csv_line_writer(line_writer) {}
+
+  /** \brief set a new delimiter for this writer
+   *  \param delim new delimiter
+   */
+  void set_delimiter(const char delim) { m_delim = delim; }
+
+  /** \brief get the current delimiter from this writer
+   *  \return constant character delimiter
+   */
+  [[nodiscard]] char get_delimiter() const { return m_delim; }
+
+  /** \brief set how the fields of each column are escaped by the formatter
+   *
+   *  Columns marked util::NEVER are copied without looking for special characters, which
+   *  suits trusted numeric or id columns, util::ALWAYS columns are quoted and util::SCAN
+   *  columns are quoted only when needed. Columns without an entry are scanned. The policy
+   *  applies to the header as well, and to write_columns(), write_struct_header() and
+   *  write_struct(), where ALWAYS also quotes numbers and bools.
+   *
+   *  \param policy escape policy per column, in column order
+   */
+  void set_column_escape(std::vector<util::EscapePolicy> policy) {
+    static_assert(util::has_column_escape<Formatter>::value,
+                  "the formatter does not support a per-column escape policy");
+    m_csv_output_formatter.set_column_escape(std::move(policy));
+  }
+
+  /** \brief check if the underlying stream is still good
+   *  \return true if good, otherwise false
+   */
+  bool good() { return m_csv_line_writer.good(); }
+
+  /** \brief write the csv header, sets number of columns
+   *  \param header RowContainer of string header names
+   */
+  void write_header(const RowContainer<std::string>& header) {
+    if (header.empty()) return;
+    m_num_columns = header.size();
+    m_csv_line_writer.writeline(m_csv_output_formatter(header, m_delim, m_line_terminator));
+  }
+
+  /** \brief write a csv row, may set initial number of columns
+   *  \param header RowContainer of string values
+   */
+  void write(const RowContainer<std::string>& values) {
+    if (values.empty()) return;
+    if (m_num_columns == -1) {
+      m_num_columns = static_cast<long>(values.size());
+    } else if (m_warn_columns &&
+               (values.size() !=
+                static_cast<typename RowContainer<std::string>::size_type>(m_num_columns))) {
+      std::cerr << "[Warning] Column mismatch detected\n";
+    }
+    m_csv_line_writer.writeline(m_csv_output_formatter(values, m_delim, m_line_terminator));
+  }
+
+  /** \brief write a csv row from any range of string like values, may set initial number of
+   *  columns
+   *  \param values range of values convertible to string_view, e.g. std::string_view or
+   *  const char*
+   */
+  template <typename Row, typename = std::enable_if_t<util::is_string_row<Row>::value>>
+  void write(const Row& values) {
+    const auto size = static_cast<std::size_t>(std::distance(std::begin(values), std::end(values)));
+    if (size == 0) return;
+    if (check_columns(size) && m_warn_columns) {
+      std::cerr << "[Warning] Column mismatch detected\n";
+    }
+    m_csv_line_writer.writeline(m_csv_output_formatter(values, m_delim, m_line_terminator));
+  }
+
+  /** \brief write a csv row from a braced list of values, may set initial number of columns
+   *  \param values values convertible to string_view
+   */
+  void write(std::initializer_list<string_view> values) { write<>(values); }
+
+  /** \brief write every row of a range, may set initial number of columns
+   *
+   *  Rows are formatted into one buffer which is handed to the LineWriter in chunks of about
+   *  util::default_chunk_size bytes when it supports writelines(), and row by row otherwise.
+   *  A column mismatch is reported once per batch.
+   *
+   *  \param rows range of RowContainer or of any range of string like values
+   */
+  template <typename Rows>
+  void write_batch(const Rows& rows) {
+    bool mismatch{false};
+    std::size_t pending{0};
+    m_data.clear();
+
+    for (const auto& row : rows) {
+      const auto size = static_cast<std::size_t>(std::distance(std::begin(row), std::end(row)));
+      if (size == 0) { continue; }
+      mismatch |= check_columns(size);
+
+      const std::string& line = m_csv_output_formatter(row, m_delim, m_line_terminator);
+      if constexpr (util::has_writelines<LineWriter>::value) {
+        m_data.append(line);
+        pending++;
+        if (m_data.size() >= util::default_chunk_size) {
+          m_csv_line_writer.writelines(m_data, pending);
+          m_data.clear();
+          pending = 0;
+        }
+      } else {
+        m_csv_line_writer.writeline(line);
+      }
+    }
+
+    if constexpr (util::has_writelines<LineWriter>::value) {
+      if (pending != 0) { m_csv_line_writer.writelines(m_data, pending); }
+    }
+    if (mismatch && m_warn_columns) { std::cerr << "[Warning] Column mismatch detected\n"; }
+  }
+
+  /** \brief Get number of csv lines written so far
+   *  \return number of csv lines written so far
+   */
+  [[nodiscard]] size_t lcount() const { return m_csv_line_writer.lcount(); }
+
+  /** \brief write every row of a range, formatting blocks of rows on several threads
+   *
+   *  Rows are split into blocks which worker threads format concurrently into separate
+   *  buffers, the calling thread hands the blocks to the LineWriter in their original order.
+   *  At most two blocks per thread are buffered at once. Ranges without random access
+   *  iterators, or a single thread, are written row by row. If the formatter or the
+   *  LineWriter throws, the workers are stopped and joined and the first exception is
+   *  rethrown, blocks already handed to the LineWriter stay written.
+   *
+   *  \param rows range of RowContainer
+   *  \param threads number of formatting threads, 0 uses the hardware concurrency
+   *  \param block_rows number of rows per block
+   */
+  template <typename Range>
+  void write_all(const Range& rows, unsigned threads = 0, std::size_t block_rows = 4096) {
+    using Iterator = decltype(std::begin(rows));
+    using Category = typename std::iterator_traits<Iterator>::iterator_category;
+
+    if (threads == 0) { threads = std::max(1u, std::thread::hardware_concurrency()); }
+    const auto first = std::begin(rows);
+    const auto count = static_cast<std::size_t>(std::distance(first, std::end(rows)));
+    if (block_rows == 0) { block_rows = 1; }
+    const std::size_t blocks = (count + block_rows - 1) / block_rows;
+
+    if constexpr (std::is_base_of_v<std::random_access_iterator_tag, Category>) {
+      if (threads > 1 && blocks > 1) {
+        write_all_parallel(first, count, std::min<std::size_t>(threads, blocks), block_rows);
+        return;
+      }
+    }
+    for (const auto& row : rows) { write(row); }
+  }
+
+  /** \brief write rows from column arrays, may set initial number of columns
+   *
+   *  A column is anything indexable by row whose elements util::append_field formats,
+   *  such as a pointer or vector of numbers, a vector of strings or a util::StringColumn.
+   *  The formatting of every column is chosen at compile time and rows are built by walking
+   *  the columns in row-major order, without materializing string rows.
+   *
+   *  \param rows number of rows, every column must hold at least this many
+   *  \param columns columns in csv order
+   */
+  template <typename... Columns>
+  void write_columns(std::size_t rows, const Columns&... columns) {
+    static_assert(sizeof...(Columns) != 0, "write_columns requires at least one column");
+    if (rows == 0) { return; }
+    if (m_num_columns == -1) {
+      m_num_columns = static_cast<long>(sizeof...(Columns));
+    } else if (m_warn_columns && sizeof...(Columns) != static_cast<std::size_t>(m_num_columns)) {
+      std::cerr << "[Warning] Column mismatch detected\n";
+    }
+
+    const bool escape_numbers = util::delimiter_in_numbers(m_delim);
+    util::EscapePolicy policy[sizeof...(Columns)];
+    for (std::size_t i = 0; i < sizeof...(Columns); i++) { policy[i] = column_escape(i); }
+    for (std::size_t row = 0; row < rows; row++) {
+      m_data.clear();
+      std::size_t column{0};
+      ((column != 0 ? m_data.push_back(m_delim) : void(),
+        util::append_column_field(m_data, columns, row, m_delim, escape_numbers,
+                                  policy[column++])),
+       ...);
+      m_data.append(m_line_terminator);
+      m_csv_line_writer.writeline(m_data);
+    }
+  }
+
+  /** \brief write the column names of a StructBinding as the csv header, sets number of columns
+   */
+  template <typename T>
+  void write_struct_header() {
+    static_assert(has_struct_binding<T>::value, "write_struct_header requires a StructBinding<T>");
+    m_data.clear();
+    util::for_each_indexed(StructBinding<T>::columns, [&](const auto& binding, std::size_t i) {
+      if (i != 0) { m_data.push_back(m_delim); }
+      util::escape_append(m_data, binding.name, m_delim, column_escape(i));
+    });
+    m_data.append(m_line_terminator);
+    m_num_columns = static_cast<long>(std::tuple_size_v<decltype(StructBinding<T>::columns)>);
+    m_csv_line_writer.writeline(m_data);
+  }
+
+  /** \brief write a struct with a StructBinding as a csv row, may set initial number of columns
+   *  \param value struct to write
+   */
+  template <typename T>
+  void write_struct(const T& value) {
+    static_assert(has_struct_binding<T>::value, "write_struct requires a StructBinding<T>");
+    constexpr auto count = std::tuple_size_v<decltype(StructBinding<T>::columns)>;
+    if (m_num_columns == -1) {
+      m_num_columns = static_cast<long>(count);
+    } else if (m_warn_columns && count != static_cast<std::size_t>(m_num_columns)) {
+      std::cerr << "[Warning] Column mismatch detected\n";
+    }
+
+    const bool escape_numbers = util::delimiter_in_numbers(m_delim);
+    m_data.clear();
+    util::for_each_indexed(StructBinding<T>::columns, [&](const auto& binding, std::size_t i) {
+      if (i != 0) { m_data.push_back(m_delim); }
+      util::append_field(m_data, value.*(binding.member), m_delim, escape_numbers,
+                         column_escape(i));
+    });
+    m_data.append(m_line_terminator);
+    m_csv_line_writer.writeline(m_data);
+  }
+
+  /** \brief write every struct of a range as a csv row
+   *  \param values range of structs with a StructBinding
+   */
+  template <typename Range>
+  void write_structs(const Range& values) {
+    for (const auto& value : values) { write_struct(value); }
+  }
+
+protected:
+  /** \brief get the escape policy set for a column
+   *  \param column column index
+   *  \return the formatter's policy for the column, util::SCAN if it has none
+   */
+  [[nodiscard]] util::EscapePolicy column_escape(std::size_t column) const {
+    if constexpr (util::has_column_escape<Formatter>::value) {
+      const auto& policy = m_csv_output_formatter.get_column_escape();
+      if (column < policy.size()) { return policy[column]; }
+    }
+    return util::SCAN;
+  }
+
+  /** \brief set the number of columns from the first row, or compare against it
+   *  \param size number of fields in the row
+   *  \return true if the row does not match the number of columns
+   */
+  bool check_columns(std::size_t size) {
+    if (m_num_columns == -1) {
+      m_num_columns = static_cast<long>(size);
+      return false;
+    }
+    return size != static_cast<std::size_t>(m_num_columns);
+  }
+
+  template <typename Iterator>
+  void write_all_parallel(Iterator first, std::size_t count, std::size_t threads,
+                          std::size_t block_rows) {
+    struct Block {
+      std::string data;
+      std::vector<std::size_t> ends;
+      bool ready{false};
+    };
+
+    // the first row sets the number of columns, as it would through write()
+    auto start = std::find_if(first, first + static_cast<std::ptrdiff_t>(count),
+                              [](const auto& row) { return !row.empty(); });
+    if (start == first + static_cast<std::ptrdiff_t>(count)) { return; }
+    if (m_num_columns == -1) { m_num_columns = static_cast<long>(start->size()); }
+
+    const std::size_t blocks = (count + block_rows - 1) / block_rows;
+    const std::size_t window = threads * 2;
+    std::vector<Block> slots(window);
+    std::atomic<std::size_t> next_block{0};
+    std::size_t written{0};
+    bool stop{false};
+    std::exception_ptr failure;
+    std::mutex mutex;
+    std::condition_variable slot_free;
+    std::condition_variable slot_ready;
+
+    auto format_blocks = [&] {
+      try {
+        Formatter formatter;
+        if constexpr (util::has_column_escape<Formatter>::value) {
+          formatter.set_column_escape(m_csv_output_formatter.get_column_escape());
+        }
+        while (true) {
+          const std::size_t block = next_block.fetch_add(1, std::memory_order_relaxed);
+          if (block >= blocks) { return; }
+          Block& slot = slots[block % window];
+          {
+            std::unique_lock<std::mutex> lock(mutex);
+            slot_free.wait(lock, [&] { return stop || block < written + window; });
+            if (stop) { return; }
+          }
+
+          slot.data.clear();
+          slot.ends.clear();
+          const std::size_t begin = block * block_rows;
+          const std::size_t end = std::min(count, begin + block_rows);
+          for (auto row = first + static_cast<std::ptrdiff_t>(begin);
+               row != first + static_cast<std::ptrdiff_t>(end); ++row) {
+            if (row->empty()) { continue; }
+            if (m_warn_columns &&
+                row->size() !=
+                    static_cast<typename RowContainer<std::string>::size_type>(m_num_columns)) {
+              std::cerr << "[Warning] Column mismatch detected\n";
+            }
+            slot.data.append(formatter(*row, m_delim, m_line_terminator));
+            slot.ends.push_back(slot.data.size());
+          }
+
+          {
+            std::lock_guard<std::mutex> lock(mutex);
+            slot.ready = true;
+          }
+          slot_ready.notify_one();
+        }
+      } catch (...) {
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          if (!failure) { failure = std::current_exception(); }
+          stop = true;
+        }
+        slot_free.notify_all();
+        slot_ready.notify_all();
+      }
+    };
+
+    {
+      // stops and joins the workers however this scope is left, a joinable std::thread
+      // would otherwise terminate the program when an exception unwinds past it
+      std::vector<std::thread> workers;
+      struct JoinGuard {
+        std::vector<std::thread>& workers;
+        std::mutex& mutex;
+        bool& stop;
+        std::condition_variable& slot_free;
+        ~JoinGuard() {
+          {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+          }
+          slot_free.notify_all();
+          for (auto& worker : workers) { worker.join(); }
+        }
+      } guard{workers, mutex, stop, slot_free};
+
+      workers.reserve(threads);
+      for (std::size_t i = 0; i < threads; i++) { workers.emplace_back(format_blocks); }
+
+      for (std::size_t block = 0; block < blocks; block++) {
+        Block& slot = slots[block % window];
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          slot_ready.wait(lock, [&] { return stop || slot.ready; });
+          if (stop) { break; }
+        }
+        if constexpr (util::has_writelines<LineWriter>::value) {
+          if (!slot.ends.empty()) { m_csv_line_writer.writelines(slot.data, slot.ends.size()); }
+        } else {
+          std::size_t line_start{0};
+          for (const auto line_end : slot.ends) {
+            m_csv_line_writer.writeline(
+                string_view(slot.data.data() + line_start, line_end - line_start));
+            line_start = line_end;
+          }
+        }
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          slot.ready = false;
+          written++;
+        }
+        slot_free.notify_all();
+      }
+    }
+
+    if (failure) { std::rethrow_exception(failure); }
+  }
+
+  char m_delim;
+
+  bool m_warn_columns;
+  long m_num_columns{-1};
+  std::string m_line_terminator;
+  std::string m_data;
+
+  Formatter m_csv_output_formatter;
+
+  LineWriter& m_csv_line_writer;
+};
+
+/** \class CSVTypedWriter
+ *  \ingroup writer
+ *  \brief Writes heterogeneous rows of numbers, bools and strings as csv
+ *
+ *  Fields are formatted straight into a reusable row buffer with
+ *  util::append_field, so no std::string is built per value.
+ */
+template <class LineWriter = csvio::util::CSVLineWriter>
+class CSVTypedWriter {
+public:
+  /** \brief construct a CSVTypedWriter from a LineWriter
+   *  \param line_writer reference to a LineWriter object
+   *  \param delimiter output delimiter to use to delimit ouput
+   *  \param warn_columns whether warning should be printed in the case of column mismatch
+   *  \param line_terminator sequence that denotes the end of a csv row
+   */
+  explicit CSVTypedWriter(LineWriter& line_writer, const char delimiter = ',',
+                          bool warn_columns = true, std::string line_terminator = "\r\n")
+      : m_delim(delimiter), m_escape_numbers(util::delimiter_in_numbers(delimiter)),
+        m_warn_columns(warn_columns), m_line_terminator(std::move(line_terminator)),
+        m_csv_line_writer(line_writer) {}
+
+  /** \brief set a new delimiter for this writer
+   *  \param delim new delimiter
+   */
+  void set_delimiter(const char delim) {
+    m_delim = delim;
+    m_escape_numbers = util::delimiter_in_numbers(delim);
+  }
+
+  /** \brief get the current delimiter from this writer
+   *  \return constant character delimiter
+   */
+  [[nodiscard]] char get_delimiter() const { return m_delim; }
+
+  /** \brief check if the underlying stream is still good
+   *  \return true if good, otherwise false
+   */
+  bool good() { return m_csv_line_writer.good(); }
+
+  /** \brief write the csv header, sets number of columns
+   *  \param names header names
+   */
+  template <typename... Names>
+  void write_header(const Names&... names) {
+    static_assert(sizeof...(Names) > 0, "a header needs at least one column");
+    m_num_columns = static_cast<long>(sizeof...(Names));
+    emit(names...);
+  }
+
+  /** \brief write one csv row from its fields, may set initial number of columns
+   *  \param fields integers, floating point values, bools, chars or strings
+   */
+  template <typename... Fields>
+  void write(const Fields&... fields) {
+    static_assert(sizeof...(Fields) > 0, "a row needs at least one column");
+    check_columns(sizeof...(Fields));
+    emit(fields...);
+  }
+
+  /** \brief write one csv row from a std::tuple or std::pair
+   *  \param row tuple of fields
+   */
+  template <typename Tuple, typename = std::enable_if_t<util::is_tuple_like<Tuple>::value>>
+  void write(const Tuple& row) {
+    std::apply([this](const auto&... fields) { write(fields...); }, row);
+  }
+
+  /** \brief Get number of csv lines written so far
+   *  \return number of csv lines written so far
+   */
+  [[nodiscard]] size_t lcount() const { return m_csv_line_writer.lcount(); }
+
+protected:
+  void check_columns(std::size_t count) {
+    if (m_num_columns == -1) {
+      m_num_columns = static_cast<long>(count);
+    } else if (m_warn_columns && count != static_cast<std::size_t>(m_num_columns)) {
+      std::cerr << "[Warning] Column mismatch detected\n";
+    }
+  }
+
+  template <typename First, typename... Rest>
+  void emit(const First& first, const Rest&... rest) {
+    m_data.clear();
+    util::append_field(m_data, first, m_delim, m_escape_numbers);
+    ((m_data.push_back(m_delim), util::append_field(m_data, rest, m_delim, m_escape_numbers)),
+     ...);
+    m_data.append(m_line_terminator);
+    m_csv_line_writer.writeline(m_data);
+  }
+
+  char m_delim;
+  bool m_escape_numbers;
+
+  bool m_warn_columns;
+  long m_num_columns{-1};
+  std::string m_line_terminator;
+  std::string m_data;
+
+  LineWriter& m_csv_line_writer;
+};
+
+/** \class CSVAsyncWriter
+ *  \ingroup writer
+ *  \brief Writes data as csv from a background thread, write() may be called from any thread
+ *
+ *  Rows are moved onto a bounded lock-free queue, the background thread formats them and
+ *  hands them to the LineWriter in batches, one writelines() call per batch when the
+ *  LineWriter has one and one writeline() call per row otherwise. Rows from one producer thread
+ *  are written in the order they were enqueued. The background thread sleeps while the queue is
+ *  empty and is woken by the next write, see set_wake_backlog() to trade latency for fewer
+ *  wakeups. The LineWriter must only be used by this writer until close() returns.
+ */
+template <template <class...> class RowContainer = std::vector,
+          class LineWriter = csvio::util::CSVLineWriter,
+          class Formatter = csvio::util::DelimJoinEscapedFormat<RowContainer>>
+class CSVAsyncWriter {
+public:
+  /** \brief construct a CSVAsyncWriter and start its background thread
+   *  \param line_writer reference to a LineWriter object
+   *  \param delimiter output delimiter to use to delimit ouput
+   *  \param warn_columns whether warning should be printed in the case of column mismatch
+   *  \param line_terminator sequence that denotes the end of a csv row
+   *  \param policy what write() does when the queue is full
+   *  \param capacity minimum number of rows the queue can hold
+   */
+  explicit CSVAsyncWriter(LineWriter& line_writer, const char delimiter = ',',
+                          bool warn_columns = true, std::string line_terminator = "\r\n",
+                          util::QueueFullPolicy policy = util::BLOCK,
+                          std::size_t capacity = util::default_async_queue_capacity)
+      : m_delim(delimiter), m_warn_columns(warn_columns),
+        m_line_terminator(std::move(line_terminator)), m_policy(policy), m_queue(capacity),
+        m_csv_line_writer(line_writer) {
+    m_thread = std::thread([this] { run(); });
+  }
+
+  CSVAsyncWriter(const CSVAsyncWriter&) = delete;
+  CSVAsyncWriter& operator=(const CSVAsyncWriter&) = delete;
+
+  /** \brief write all queued rows and stop the background thread
+   */
+  ~CSVAsyncWriter() { close(); }
+
+  /** \brief enqueue the csv header, the first row enqueued sets the number of columns
+   *  \param header RowContainer of string header names
+   *  \return true if enqueued, false if dropped or closed
+   */
+  bool write_header(RowContainer<std::string> header) { return write(std::move(header)); }
+
+  /** \brief enqueue a csv row to be formatted by the background thread
+   *  \param values RowContainer of string values, moved onto the queue
+   *  \return true if enqueued, false if dropped or closed
+   */
+  bool write(RowContainer<std::string>&& values) {
+    if (values.empty()) return true;
+    Entry entry;
+    entry.row = std::move(values);
+    return enqueue(entry);
+  }
+
+  /** \brief enqueue a copy of a csv row to be formatted by the background thread
+   *  \param values RowContainer of string values
+   *  \return true if enqueued, false if dropped or closed
+   */
+  bool write(const RowContainer<std::string>& values) {
+    return write(RowContainer<std::string>(values));
+  }
+
+  /** \brief enqueue an already formatted csv line, written as is
+   *  \param line formatted line including its line terminator
+   *  \return true if enqueued, false if dropped or closed
+   */
+  bool write_line(std::string line) {
+    Entry entry;
+    entry.line = std::move(line);
+    entry.formatted = true;
+    return enqueue(entry);
+  }
+
+  /** \brief enqueue an already formatted csv line by swapping it with a recycled buffer
+   *
+   *  Once the queue has cycled, the buffer handed back is one the background thread has
+   *  already written, so a caller that reuses it does not allocate per line.
+   *  \param line formatted line including its line terminator, holds an empty recycled
+   *  buffer afterwards, or is left untouched if the line was not enqueued
+   *  \return true if enqueued, false if dropped or closed
+   */
+  bool exchange_line(std::string& line) {
+    Entry entry;
+    entry.line.swap(line);
+    entry.formatted = true;
+    const bool queued = enqueue(entry);
+    line.swap(entry.line);
+    if (queued) { line.clear(); }
+    return queued;
+  }
+
+  /** \brief block until every row enqueued before this call has been handed to the LineWriter
+   */
+  void flush() {
+    const std::size_t target = m_enqueued.load(std::memory_order_acquire);
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_flushing.fetch_add(1, std::memory_order_acq_rel);
+    m_wake.notify_one();
+    while (m_processed.load(std::memory_order_acquire) < target && m_running) {
+      m_done.wait_for(lock, std::chrono::milliseconds(1));
+    }
+    m_flushing.fetch_sub(1, std::memory_order_acq_rel);
+  }
+
+  /** \brief write all queued rows and stop the background thread, later writes are rejected
+   */
+  void close() {
+    if (!m_thread.joinable()) { return; }
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stop.store(true, std::memory_order_seq_cst);
+    }
+    m_wake.notify_one();
+    notify_blocked();
+    m_thread.join();
+  }
+
+  /** \brief set the policy applied when the queue is full
+   *  \param policy BLOCK waits for a free slot, DROP discards the row, GROW spills to the heap
+   */
+  void set_queue_full_policy(util::QueueFullPolicy policy) {
+    m_policy.store(policy, std::memory_order_seq_cst);
+    notify_blocked();
+  }
+
+  /** \brief only wake the background thread once a number of rows are pending
+   *
+   *  Above 1 write() skips the wakeup while fewer rows are pending and the background thread
+   *  polls every millisecond instead, so a row may wait up to a millisecond before it is
+   *  written. Suits producers which cannot afford a syscall per row, such as loggers.
+   *  \param rows pending rows which wake the background thread, 1 wakes it on every write
+   */
+  void set_wake_backlog(std::size_t rows) {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_wake_backlog.store(std::max<std::size_t>(rows, 1), std::memory_order_relaxed);
+    }
+    m_wake.notify_one();
+  }
+
+  /** \brief get the policy applied when the queue is full
+   *  \return current policy
+   */
+  [[nodiscard]] util::QueueFullPolicy get_queue_full_policy() const {
+    return m_policy.load(std::memory_order_relaxed);
+  }
+
+  /** \brief get the delimiter used by this writer
+   *  \return constant character delimiter
+   */
+  [[nodiscard]] char get_delimiter() const { return m_delim; }
+
+  /** \brief check if the underlying LineWriter was still good after the last batch
+   *  \return true if good, otherwise false
+   */
+  [[nodiscard]] bool good() const { return m_good.load(std::memory_order_acquire); }
+
+  /** \brief Get number of csv lines handed to the LineWriter so far
+   *  \return number of csv lines written so far
+   */
+  [[nodiscard]] std::size_t lcount() const { return m_processed.load(std::memory_order_acquire); }
+
+  /** \brief Get number of rows discarded because the queue was full or the writer closed
+   *  \return number of dropped rows
+   */
+  [[nodiscard]] std::size_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+protected:
+  struct Entry {
+    RowContainer<std::string> row;
+    std::string line;
+    bool formatted{false};
+  };
+
+  // on success entry holds the recycled contents of the slot it was swapped into
+  bool enqueue(Entry& entry) {
+    // registering before the stop check pairs with the consumer reading m_stop before
+    // m_in_flight, so either this producer sees the stop or the consumer waits for it
+    m_in_flight.fetch_add(1, std::memory_order_seq_cst);
+    struct InFlight {
+      std::atomic<std::size_t>& count;
+      ~InFlight() { count.fetch_sub(1, std::memory_order_seq_cst); }
+    } in_flight{m_in_flight};
+
+    if (m_stop.load(std::memory_order_seq_cst)) {
+      m_dropped.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+
+    // once rows spill to the heap every producer follows them there until the
+    // background thread drains the spill, which keeps each producer's rows in order
+    bool queued =
+        m_spilled.load(std::memory_order_acquire) == 0 && m_queue.try_exchange(entry);
+    while (!queued) {
+      const auto policy = m_policy.load(std::memory_order_relaxed);
+      if (policy == util::GROW || m_spilled.load(std::memory_order_acquire) != 0) {
+        std::lock_guard<std::mutex> lock(m_spill_mutex);
+        m_spill.push_back(std::move(entry));
+        entry = Entry{};
+        m_spilled.fetch_add(1, std::memory_order_release);
+        queued = true;
+      } else if (policy == util::DROP || m_stop.load(std::memory_order_acquire)) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      } else {
+        queued = wait_for_slot(entry);
+      }
+    }
+
+    const std::size_t enqueued = m_enqueued.fetch_add(1, std::memory_order_acq_rel) + 1;
+    const std::size_t wake_backlog = m_wake_backlog.load(std::memory_order_relaxed);
+    if (wake_backlog == 1 ||
+        enqueued - m_processed.load(std::memory_order_relaxed) >= wake_backlog) {
+      wake();
+    }
+    return true;
+  }
+
+  void wake() {
+    // pairs with the fence in run() between announcing sleep and checking the queue, so
+    // either this sees m_sleeping or the background thread sees the row
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_sleeping.load(std::memory_order_relaxed)) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_wake.notify_one();
+    }
+  }
+
+  // BLOCK policy, sleep until the background thread frees a slot, the writer is closed or
+  // the policy changes, returns false without enqueueing in the last two cases
+  bool wait_for_slot(Entry& entry) {
+    wake();
+    bool queued{false};
+    std::unique_lock<std::mutex> lock(m_slot_mutex);
+    // registering before retrying pairs with the consumer popping before reading m_blocked,
+    // so either the retry sees the free slot or the consumer sees this producer and notifies
+    m_blocked.fetch_add(1, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    m_slot_free.wait(lock, [&] {
+      if (m_stop.load(std::memory_order_seq_cst) ||
+          m_policy.load(std::memory_order_seq_cst) != util::BLOCK ||
+          m_spilled.load(std::memory_order_acquire) != 0) {
+        return true;
+      }
+      queued = m_queue.try_exchange(entry);
+      return queued;
+    });
+    m_blocked.fetch_sub(1, std::memory_order_relaxed);
+    return queued;
+  }
+
+  void notify_blocked() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_blocked.load(std::memory_order_relaxed) != 0) {
+      std::lock_guard<std::mutex> lock(m_slot_mutex);
+      m_slot_free.notify_all();
+    }
+  }
+
+  void run() {
+    Entry entry;
+    std::deque<Entry> spill;
+    while (true) {
+      std::size_t rows{0};
+      m_batch.clear();
+      m_batch_ends.clear();
+      while (rows < max_batch_rows && m_batch.size() < max_batch_bytes && m_queue.try_pop(entry)) {
+        append(entry);
+        rows++;
+      }
+      if (rows != 0) { notify_blocked(); }
+      if (rows == 0 && m_spilled.load(std::memory_order_acquire) != 0) {
+        {
+          std::lock_guard<std::mutex> lock(m_spill_mutex);
+          spill.swap(m_spill);
+          m_spilled.store(0, std::memory_order_release);
+        }
+        for (auto& spilled : spill) {
+          append(spilled);
+          rows++;
+        }
+        spill.clear();
+      }
+
+      if (rows != 0) {
+        if constexpr (util::has_writelines<LineWriter>::value) {
+          m_csv_line_writer.writelines(m_batch, rows);
+        } else {
+          std::size_t line_start{0};
+          for (const auto line_end : m_batch_ends) {
+            m_csv_line_writer.writeline(
+                string_view(m_batch.data() + line_start, line_end - line_start));
+            line_start = line_end;
+          }
+        }
+        m_good.store(m_csv_line_writer.good(), std::memory_order_release);
+        m_processed.fetch_add(rows, std::memory_order_acq_rel);
+        if (m_flushing.load(std::memory_order_acquire) != 0) {
+          std::lock_guard<std::mutex> lock(m_mutex);
+          m_done.notify_all();
+        }
+        continue;
+      }
+
+      std::unique_lock<std::mutex> lock(m_mutex);
+      if (m_stop.load(std::memory_order_seq_cst) &&
+          m_in_flight.load(std::memory_order_seq_cst) == 0 &&
+          m_enqueued.load(std::memory_order_acquire) ==
+              m_processed.load(std::memory_order_relaxed)) {
+        m_running = false;
+        break;
+      }
+      m_sleeping.store(true, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      // a single wait, the outer loop rechecks, so set_wake_backlog() takes effect at once
+      if (!m_stop.load(std::memory_order_acquire) && m_queue.empty() &&
+          m_spilled.load(std::memory_order_acquire) == 0) {
+        if (m_wake_backlog.load(std::memory_order_relaxed) == 1) {
+          m_wake.wait(lock);
+        } else {
+          m_wake.wait_for(lock, std::chrono::milliseconds(1));
+        }
+      }
+      m_sleeping.store(false, std::memory_order_relaxed);
+    }
+    m_done.notify_all();
+  }
+
+  void append(Entry& entry) {
+    if (entry.formatted) {
+      m_batch.append(entry.line);
+      m_batch_ends.push_back(m_batch.size());
+      return;
+    }
+    if (m_num_columns == -1) {
+      m_num_columns = static_cast<long>(entry.row.size());
+    } else if (m_warn_columns &&
+               (entry.row.size() !=
+                static_cast<typename RowContainer<std::string>::size_type>(m_num_columns))) {
+      std::cerr << "[Warning] Column mismatch detected\n";
     }
+    m_batch.append(m_csv_output_formatter(entry.row, m_delim, m_line_terminator));
+    m_batch_ends.push_back(m_batch.size());
   }
 
-  /** \brief handle reading and parsing the header if has_header is true
-   */
-  void handle_header() {
-    m_current_str_line = m_csv_line_reader.readline();
-    m_header_names = m_parse_func(m_current_str_line, m_delim);
-    m_num_columns = static_cast<long>(m_header_names.size());
-    m_current_str_line = "";
-  }
-
-  LineReader& m_csv_line_reader;
+  static constexpr std::size_t max_batch_rows = 1024;
+  static constexpr std::size_t max_batch_bytes = std::size_t{1} << 16;
 
   char m_delim;
-  bool m_has_header;
-  bool m_warn_columns;
 
-  Parser m_parse_func;
-  std::string m_current_str_line;
+  bool m_warn_columns;
   long m_num_columns{-1};
+  std::string m_line_terminator;
+  std::string m_batch;
+  std::vector<std::size_t> m_batch_ends;
+
+  std::atomic<util::QueueFullPolicy> m_policy;
+  util::BoundedMPSCQueue<Entry> m_queue;
+  std::atomic<std::size_t> m_wake_backlog{1};
+  std::mutex m_spill_mutex;
+  std::deque<Entry> m_spill;
+  std::atomic<std::size_t> m_spilled{0};
+
+  std::atomic<std::size_t> m_enqueued{0};
+  std::atomic<std::size_t> m_processed{0};
+  std::atomic<std::size_t> m_in_flight{0};
+  std::atomic<std::size_t> m_dropped{0};
+  std::atomic<std::size_t> m_flushing{0};
+  std::atomic<bool> m_good{true};
+  std::atomic<bool> m_stop{false};
+  std::atomic<bool> m_sleeping{false};
+  std::atomic<std::size_t> m_blocked{0};
+  bool m_running{true};
+
+  std::mutex m_mutex;
+  std::condition_variable m_wake;
+  std::condition_variable m_done;
+  std::mutex m_slot_mutex;
+  std::condition_variable m_slot_free;
 
-  RowContainer<std::string> m_header_names{""};
-  RowContainer<std::string> m_current{""};
+  Formatter m_csv_output_formatter;
+  LineWriter& m_csv_line_writer;
+  std::thread m_thread;
 };
 
-/** \class CSVWriter
+/** \class CSVSharedWriter
  *  \ingroup writer
- *  \brief Writes data as csv
+ *  \brief Writes data as csv from several threads through per-thread buffers
+ *
+ *  Each thread takes a Local from local() and formats rows into its own buffer. Buffers are
+ *  appended to the LineWriter as one chunk, with one writelines() call under a lock, or one
+ *  writeline() call when the LineWriter has no writelines(), so rows never interleave. Chunks are either appended as soon as they are committed, or given a
+ *  sequence number and appended in sequence order starting at 0.
  */
 template <template <class...> class RowContainer = std::vector,
           class LineWriter = csvio::util::CSVLineWriter,
           class Formatter = csvio::util::DelimJoinEscapedFormat<RowContainer>>
-class CSVWriter {
+class CSVSharedWriter {
 public:
-  /** \brief construct a CSVWriter from a LineWriter
+  /** \class Local
+   *  \brief Per-thread handle buffering formatted rows, must only be used by one thread
+   */
+  class Local {
+  public:
+    /** \brief construct a Local for a CSVSharedWriter
+     *  \param writer shared writer to commit to
+     */
+    explicit Local(CSVSharedWriter& writer) : m_writer(&writer) {
+      m_buffer.reserve(writer.m_chunk_size);
+    }
+
+    Local(const Local&) = delete;
+    Local& operator=(const Local&) = delete;
+
+    Local(Local&& other) noexcept
+        : m_writer(other.m_writer), m_buffer(std::move(other.m_buffer)),
+          m_rows(std::exchange(other.m_rows, 0)), m_sequenced(other.m_sequenced),
+          m_auto_committed(other.m_auto_committed) {}
+
+    /** \brief commit remaining unordered rows, rows left in a Local which committed with
+     *  sequence numbers have no sequence of their own and are dropped with a warning
+     */
+    ~Local() {
+      if (m_rows == 0) { return; }
+      if (m_sequenced) {
+        std::cerr << "[warning] Dropping " << m_rows
+                  << " rows which were never committed with a sequence number\n";
+        return;
+      }
+      commit();
+    }
+
+    /** \brief format a csv row into this thread's buffer, commits when the buffer is full
+     *  unless this Local has committed with a sequence number
+     *  \param values RowContainer of string values
+     */
+    void write(const RowContainer<std::string>& values) {
+      if (values.empty()) return;
+      m_writer->check_columns(values.size());
+      m_buffer.append(
+          m_csv_output_formatter(values, m_writer->m_delim, m_writer->m_line_terminator));
+      m_rows++;
+      if (m_writer->m_auto_commit && !m_sequenced && m_buffer.size() >= m_writer->m_chunk_size) {
+        commit();
+        m_auto_committed = true;
+      }
+    }
+
+    /** \brief append the buffered rows to the LineWriter now
+     */
+    void commit() {
+      if (m_rows == 0) { return; }
+      m_writer->append(m_buffer, m_rows);
+      m_buffer.clear();
+      m_rows = 0;
+    }
+
+    /** \brief append the buffered rows once every chunk before sequence has been appended
+     *  \param sequence position of this chunk, each value from 0 up must be committed once
+     *  \throw std::logic_error if write() already committed rows of this Local on its own,
+     *  those rows were appended out of sequence
+     */
+    void commit(std::uint64_t sequence) {
+      if (m_auto_committed) {
+        throw std::logic_error(
+            "CSVSharedWriter::Local committed rows without a sequence number before commit(" +
+            std::to_string(sequence) + "), construct the writer with chunk_size 0");
+      }
+      m_sequenced = true;
+      m_writer->append(sequence, m_buffer, m_rows);
+      m_buffer.clear();
+      m_buffer.reserve(m_writer->m_chunk_size);
+      m_rows = 0;
+    }
+
+    /** \brief number of bytes formatted but not committed
+     *  \return buffered byte count
+     */
+    [[nodiscard]] std::size_t buffered() const { return m_buffer.size(); }
+
+  private:
+    CSVSharedWriter* m_writer;
+    std::string m_buffer;
+    std::size_t m_rows{0};
+    bool m_sequenced{false};
+    bool m_auto_committed{false};
+    Formatter m_csv_output_formatter;
+  };
+
+  /** \brief construct a CSVSharedWriter from a LineWriter
    *  \param line_writer reference to a LineWriter object
    *  \param delimiter output delimiter to use to delimit ouput
    *  \param warn_columns whether warning should be printed in the case of column mismatch
    *  \param line_terminator sequence that denotes the end of a csv row
-   *  \param format_func a function to format a container to an output csv string
+   *  \param chunk_size buffer size at which Local::write() commits on its own, 0 only commits
+   *         when asked to, which is required when chunks are committed with sequence numbers
+   *         from the first chunk on
    */
-  explicit CSVWriter(LineWriter& line_writer, const char delimiter = ',', bool warn_columns = true,
-                     std::string line_terminator = "\r\n")
+  explicit CSVSharedWriter(LineWriter& line_writer, const char delimiter = ',',
+                           bool warn_columns = true, std::string line_terminator = "\r\n",
+                           std::size_t chunk_size = util::default_chunk_size)
       : m_delim(delimiter), m_warn_columns(warn_columns),
-        m_line_terminator(std::move(line_terminator)), m_csv_line_writer(line_writer) {}
+        m_line_terminator(std::move(line_terminator)),
+        m_chunk_size(chunk_size == 0 ? util::default_chunk_size : chunk_size),
+        m_auto_commit(chunk_size != 0), m_csv_line_writer(line_writer) {}
 
-  /** \brief set a new delimiter for this writer
-   *  \param delim new delimiter
+  CSVSharedWriter(const CSVSharedWriter&) = delete;
+  CSVSharedWriter& operator=(const CSVSharedWriter&) = delete;
+
+  /** \brief append chunks still waiting for an earlier sequence number, in order
    */
-  void set_delimiter(const char delim) { m_delim = delim; }
+  ~CSVSharedWriter() {
+    if (!m_pending.empty()) {
+      std::cerr << "[warning] Sequence " << m_next_sequence
+                << " was never committed, writing later chunks anyway\n";
+      for (auto& chunk : m_pending) { write_chunk(chunk.second.first, chunk.second.second); }
+    }
+  }
+
+  /** \brief get a per-thread handle to format rows with
+   *  \return Local bound to this writer
+   */
+  Local local() { return Local(*this); }
+
+  /** \brief write the csv header immediately, sets number of columns
+   *  \param header RowContainer of string header names
+   */
+  void write_header(const RowContainer<std::string>& header) {
+    if (header.empty()) return;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_num_columns.store(static_cast<long>(header.size()), std::memory_order_relaxed);
+    write_chunk(m_csv_output_formatter(header, m_delim, m_line_terminator), 1);
+  }
 
   /** \brief get the current delimiter from this writer
    *  \return constant character delimiter
@@ -1084,46 +4288,85 @@ public:
   /** \brief check if the underlying stream is still good
    *  \return true if good, otherwise false
    */
-  bool good() { return m_csv_line_writer.good(); }
+  bool good() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_csv_line_writer.good();
+  }
 
-  /** \brief write the csv header, sets number of columns
-   *  \param header RowContainer of string header names
+  /** \brief Get number of csv lines appended to the LineWriter so far
+   *  \return number of csv lines written so far
    */
-  void write_header(const RowContainer<std::string>& header) {
-    if (header.empty()) return;
-    m_num_columns = header.size();
-    m_csv_line_writer.writeline(m_csv_output_formatter(header, m_delim, m_line_terminator));
-  }
+  [[nodiscard]] std::size_t lcount() const { return m_rows.load(std::memory_order_acquire); }
 
-  /** \brief write a csv row, may set initial number of columns
-   *  \param header RowContainer of string values
+  /** \brief the sequence number the writer is waiting for
+   *  \return next sequence number to append
    */
-  void write(const RowContainer<std::string>& values) {
-    if (values.empty()) return;
-    if (m_num_columns == -1) {
-      m_num_columns = static_cast<long>(values.size());
-    } else if (m_warn_columns &&
-               (values.size() !=
-                static_cast<typename RowContainer<std::string>::size_type>(m_num_columns))) {
+  [[nodiscard]] std::uint64_t next_sequence() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_next_sequence;
+  }
+
+protected:
+  void check_columns(std::size_t count) {
+    long expected{-1};
+    if (m_num_columns.compare_exchange_strong(expected, static_cast<long>(count),
+                                              std::memory_order_relaxed)) {
+      return;
+    }
+    if (m_warn_columns && count != static_cast<std::size_t>(expected)) {
       std::cerr << "[Warning] Column mismatch detected\n";
     }
-    m_csv_line_writer.writeline(m_csv_output_formatter(values, m_delim, m_line_terminator));
   }
 
-  /** \brief Get number of csv lines written so far
-   *  \return number of csv lines written so far
-   */
-  [[nodiscard]] size_t lcount() const { return m_csv_line_writer.lcount(); }
+  void append(const std::string& chunk, std::size_t rows) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    write_chunk(chunk, rows);
+  }
+
+  void append(std::uint64_t sequence, std::string& chunk, std::size_t rows) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (sequence != m_next_sequence) {
+      if (sequence < m_next_sequence || m_pending.count(sequence) != 0) {
+        std::cerr << "[warning] Sequence " << sequence << " was already committed\n";
+        return;
+      }
+      m_pending.emplace(sequence, std::make_pair(std::move(chunk), rows));
+      return;
+    }
+    write_chunk(chunk, rows);
+    m_next_sequence++;
+    for (auto it = m_pending.begin(); it != m_pending.end() && it->first == m_next_sequence;
+         it = m_pending.erase(it)) {
+      write_chunk(it->second.first, it->second.second);
+      m_next_sequence++;
+    }
+  }
+
+  void write_chunk(const std::string& chunk, std::size_t rows) {
+    if (!chunk.empty()) {
+      if constexpr (util::has_writelines<LineWriter>::value) {
+        m_csv_line_writer.writelines(chunk, rows);
+      } else {
+        m_csv_line_writer.writeline(chunk);
+      }
+    }
+    m_rows.fetch_add(rows, std::memory_order_release);
+  }
 
-protected:
   char m_delim;
 
   bool m_warn_columns;
-  long m_num_columns{-1};
+  std::atomic<long> m_num_columns{-1};
   std::string m_line_terminator;
+  std::size_t m_chunk_size;
+  bool m_auto_commit;
 
-  Formatter m_csv_output_formatter;
+  std::mutex m_mutex;
+  std::uint64_t m_next_sequence{0};
+  std::map<std::uint64_t, std::pair<std::string, std::size_t>> m_pending;
+  std::atomic<std::size_t> m_rows{0};
 
+  Formatter m_csv_output_formatter;
   LineWriter& m_csv_line_writer;
 };
 
@@ -1226,6 +4469,365 @@ protected:
   RowMapContainer<std::string, std::string> m_current{};
 };
 
+/** \class CSVMapWriter
+ *  \ingroup writer
+ *  \brief Writes map like rows as csv in a fixed header order
+ *
+ *  The header is resolved once into column slots. For every position in a row's iteration
+ *  order the writer remembers which slot the key went to, so rows with the same keys in the
+ *  same order, always the case for std::map, are placed with a key comparison instead of a
+ *  lookup. Values are escaped straight from the map into a reusable line buffer.
+ */
+template <template <class...> class RowMapContainer = std::map,
+          class LineWriter = csvio::util::CSVLineWriter>
+class CSVMapWriter {
+public:
+  /** \brief Construct a CSVMapWriter and write the header
+   *  \param line_writer reference to a LineWriter object
+   *  \param header column names in output order
+   *  \param delimiter output delimiter to use to delimit ouput
+   *  \param line_terminator sequence that denotes the end of a csv row
+   *  \param policy handling of missing and extra keys
+   */
+  explicit CSVMapWriter(LineWriter& line_writer, std::vector<std::string> header,
+                        const char delimiter = ',', std::string line_terminator = "\r\n",
+                        util::MapKeyPolicy policy = {})
+      : m_delim(delimiter), m_line_terminator(std::move(line_terminator)), m_policy(policy),
+        m_header_names(std::move(header)), m_csv_line_writer(line_writer) {
+    m_slots.reserve(m_header_names.size());
+    for (std::size_t slot = 0; slot < m_header_names.size(); slot++) {
+      m_slots.emplace(m_header_names[slot], slot);
+    }
+    m_fields.resize(m_header_names.size());
+    m_stamps.resize(m_header_names.size(), 0);
+
+    m_data.clear();
+    for (std::size_t slot = 0; slot < m_header_names.size(); slot++) {
+      if (slot != 0) { m_data.push_back(m_delim); }
+      util::escape_append(m_data, m_header_names[slot], m_delim);
+    }
+    m_data.append(m_line_terminator);
+    m_csv_line_writer.writeline(m_data);
+  }
+
+  /** \brief write a map row in header order
+   *  \param row map of column name to value
+   *  \return true if the row was written, false if skipped by the key policy
+   */
+  bool write(const RowMapContainer<std::string, std::string>& row) {
+    m_stamp++;
+    std::size_t filled{0};
+    bool extra{false};
+
+    std::size_t position{0};
+    for (const auto& [key, value] : row) {
+      std::size_t slot = position < m_order.size() ? m_order[position] : no_slot;
+      if (slot == no_slot || m_header_names[slot] != key) {
+        const auto found = m_slots.find(key);
+        slot = found == m_slots.end() ? no_slot : found->second;
+        if (position < m_order.size()) {
+          m_order[position] = slot;
+        } else {
+          m_order.push_back(slot);
+        }
+      }
+      position++;
+
+      if (slot == no_slot) {
+        extra = true;
+        continue;
+      }
+      if (m_stamps[slot] != m_stamp) {
+        m_stamps[slot] = m_stamp;
+        filled++;
+      }
+      m_fields[slot] = value;
+    }
+
+    if (extra && !apply(m_policy.extra, "[warning] Row has keys which are not in the header\n")) {
+      return false;
+    }
+    if (filled != m_header_names.size() &&
+        !apply(m_policy.missing, "[warning] Row is missing keys from the header\n")) {
+      return false;
+    }
+
+    m_data.clear();
+    for (std::size_t slot = 0; slot < m_header_names.size(); slot++) {
+      if (slot != 0) { m_data.push_back(m_delim); }
+      if (m_stamps[slot] == m_stamp) { util::escape_append(m_data, m_fields[slot], m_delim); }
+    }
+    m_data.append(m_line_terminator);
+    m_csv_line_writer.writeline(m_data);
+    return true;
+  }
+
+  /** \brief get the header names in output order
+   *  \return reference to the header names
+   */
+  [[nodiscard]] const std::vector<std::string>& get_header_names() const {
+    return m_header_names;
+  }
+
+  /** \brief set the handling of missing and extra keys
+   *  \param policy new key policy
+   */
+  void set_key_policy(util::MapKeyPolicy policy) { m_policy = policy; }
+
+  /** \brief get the handling of missing and extra keys
+   *  \return current key policy
+   */
+  [[nodiscard]] util::MapKeyPolicy get_key_policy() const { return m_policy; }
+
+  /** \brief get the current delimiter from this writer
+   *  \return constant character delimiter
+   */
+  [[nodiscard]] char get_delimiter() const { return m_delim; }
+
+  /** \brief check if the underlying stream is still good
+   *  \return true if good, otherwise false
+   */
+  bool good() { return m_csv_line_writer.good(); }
+
+  /** \brief Get number of csv lines written so far, including the header
+   *  \return number of csv lines written so far
+   */
+  [[nodiscard]] size_t lcount() const { return m_csv_line_writer.lcount(); }
+
+protected:
+  static constexpr std::size_t no_slot = static_cast<std::size_t>(-1);
+
+  /** \brief apply a key policy action
+   *  \return true if the row should still be written
+   */
+  static bool apply(util::MapKeyPolicy::Action action, const char* warning) {
+    if (action == util::MapKeyPolicy::WARN) { std::cerr << warning; }
+    return action != util::MapKeyPolicy::SKIP_ROW;
+  }
+
+  char m_delim;
+  std::string m_line_terminator;
+  util::MapKeyPolicy m_policy;
+
+  std::vector<std::string> m_header_names;
+  std::unordered_map<std::string, std::size_t> m_slots;
+  std::vector<std::size_t> m_order;
+  std::vector<string_view> m_fields;
+  std::vector<std::uint64_t> m_stamps;
+  std::uint64_t m_stamp{0};
+  std::string m_data;
+
+  LineWriter& m_csv_line_writer;
+};
+
+/** \class CSVTransform
+ *  \ingroup transform
+ *  \brief Streams csv rows from a LineReader to a LineWriter, selecting, reordering and renaming
+ *  columns and adding constant columns
+ *
+ *  Rows are split with util::DelimSplitLazy and fields are copied to the output as the raw
+ *  escaped bytes of the input, without unescaping and escaping them again. Only when the
+ *  output delimiter differs from the input delimiter are unquoted fields scanned, and quoted
+ *  when they contain the new delimiter. Formatted rows are handed to the LineWriter in chunks
+ *  when it supports writelines().
+ *
+ *  Without any add_column() or add_constant() call every input column is copied. Blank lines
+ *  are skipped.
+ */
+template <typename LineReader = csvio::util::CSVLineReader,
+          typename LineWriter = csvio::util::CSVLineWriter>
+class CSVTransform {
+public:
+  /** \brief construct a CSVTransform, reads the header if there is one
+   *  \param line_reader reference to a LineReader of the input
+   *  \param line_writer reference to a LineWriter of the output
+   *  \param delimiter input delimiter, also the output delimiter until set_output_delimiter
+   *  \param has_header the input starts with a header, which is written to the output too
+   *  \param warn_columns warn about mismatched or unknown columns
+   *  \param line_terminator sequence that denotes the end of an output row
+   */
+  explicit CSVTransform(LineReader& line_reader, LineWriter& line_writer,
+                        const char delimiter = ',', bool has_header = true,
+                        bool warn_columns = true, std::string line_terminator = "\r\n")
+      : m_csv_reader(line_reader, delimiter, has_header, warn_columns),
+        m_has_header(has_header), m_warn_columns(warn_columns), m_out_delim(delimiter),
+        m_line_terminator(std::move(line_terminator)), m_csv_line_writer(line_writer) {}
+
+  /** \brief append an input column to the output, found by its header name
+   *  \param name header name of the input column
+   *  \param output_name name in the output header, empty keeps the input name
+   */
+  void add_column(const std::string& name, std::string output_name = "") {
+    const std::size_t index =
+        util::find_column(m_csv_reader.get_header_names(), name, m_warn_columns);
+    add_column(index, output_name.empty() ? name : std::move(output_name));
+  }
+
+  /** \brief append an input column to the output, found by its position
+   *  \param index position of the input column, columns past the end of a row are empty
+   *  \param output_name name in the output header, empty keeps the input name
+   */
+  void add_column(std::size_t index, std::string output_name = "") {
+    const auto& header = m_csv_reader.get_header_names();
+    if (output_name.empty() && index < header.size()) { output_name = header[index]; }
+    m_columns.push_back({index, std::move(output_name), {}});
+  }
+
+  /** \brief append a column with the same value in every row
+   *  \param name name in the output header
+   *  \param value unescaped value of the column
+   */
+  void add_constant(std::string name, std::string value) {
+    m_columns.push_back({constant_column, std::move(name), std::move(value)});
+  }
+
+  /** \brief rename an output column, selects every input column first if none was added
+   *  \param from current output name
+   *  \param to new output name
+   */
+  void rename_column(const std::string& from, std::string to) {
+    if (m_columns.empty()) {
+      for (std::size_t i = 0; i < m_csv_reader.get_header_names().size(); i++) { add_column(i); }
+    }
+    for (auto& column : m_columns) {
+      if (column.name == from) {
+        column.name = std::move(to);
+        return;
+      }
+    }
+    if (m_warn_columns) { std::cerr << "[warning] Column " << from << " not found in output\n"; }
+  }
+
+  /** \brief set a different delimiter for the output
+   *  \param delim new output delimiter
+   */
+  void set_output_delimiter(const char delim) { m_out_delim = delim; }
+
+  /** \brief get the output delimiter
+   *  \return constant char delimiter value
+   */
+  [[nodiscard]] char get_output_delimiter() const { return m_out_delim; }
+
+  /** \brief get the input header names
+   *  \return the input header, empty without a header
+   */
+  const util::LazyRow<std::string>& get_header_names() { return m_csv_reader.get_header_names(); }
+
+  /** \brief transform every remaining row of the input
+   *  \return number of rows written, not counting the header
+   */
+  std::size_t run() {
+    const bool same_delim = m_out_delim == m_csv_reader.get_delimiter();
+    std::size_t rows{0};
+    std::size_t pending{0};
+    m_data.clear();
+
+    if (m_has_header) {
+      if (m_columns.empty()) {
+        const auto& header = m_csv_reader.get_header_names();
+        for (std::size_t i = 0; i < header.size(); i++) {
+          if (i != 0) { m_data.push_back(m_out_delim); }
+          append_raw(header, i, same_delim);
+        }
+      } else {
+        for (std::size_t i = 0; i < m_columns.size(); i++) {
+          if (i != 0) { m_data.push_back(m_out_delim); }
+          util::escape_append(m_data, m_columns[i].name, m_out_delim);
+        }
+      }
+      m_data.append(m_line_terminator);
+      pending++;
+      if (!util::has_writelines<LineWriter>::value) { emit(pending); }
+    }
+
+    for (auto& column : m_columns) {
+      column.escaped.clear();
+      util::escape_append(column.escaped, column.value, m_out_delim);
+    }
+
+    while (m_csv_reader.good()) {
+      const auto& row = m_csv_reader.read();
+      if (util::is_blank_row(row)) { continue; }
+
+      if (m_columns.empty()) {
+        for (std::size_t i = 0; i < row.size(); i++) {
+          if (i != 0) { m_data.push_back(m_out_delim); }
+          append_raw(row, i, same_delim);
+        }
+      } else {
+        for (std::size_t i = 0; i < m_columns.size(); i++) {
+          if (i != 0) { m_data.push_back(m_out_delim); }
+          const Column& column = m_columns[i];
+          if (column.index == constant_column) {
+            m_data.append(column.escaped);
+          } else if (column.index < row.size()) {
+            append_raw(row, column.index, same_delim);
+          }
+        }
+      }
+      m_data.append(m_line_terminator);
+      rows++;
+      pending++;
+
+      if (m_data.size() >= util::default_chunk_size || !util::has_writelines<LineWriter>::value) {
+        emit(pending);
+      }
+    }
+    if (pending != 0) { emit(pending); }
+    return rows;
+  }
+
+  /** \brief Get number of csv lines written so far
+   *  \return number of csv lines written so far
+   */
+  [[nodiscard]] std::size_t lcount() const { return m_csv_line_writer.lcount(); }
+
+protected:
+  static constexpr std::size_t constant_column = static_cast<std::size_t>(-1);
+
+  struct Column {
+    std::size_t index;
+    std::string name;
+    std::string value;
+    std::string escaped{};
+  };
+
+  /** \brief copy a field as it appeared in the input, quoting it only if the new delimiter
+   *  requires it
+   */
+  void append_raw(const util::LazyRow<std::string>& row, std::size_t index, bool same_delim) {
+    const string_view raw = row.raw(index);
+    if (same_delim || (!raw.empty() && raw.front() == '\"')) {
+      m_data.append(raw.data(), raw.size());
+    } else {
+      util::escape_append(m_data, raw, m_out_delim);
+    }
+  }
+
+  /** \brief hand the formatted lines to the LineWriter, one line at a time without writelines()
+   */
+  void emit(std::size_t& pending) {
+    if constexpr (util::has_writelines<LineWriter>::value) {
+      m_csv_line_writer.writelines(m_data, pending);
+    } else {
+      m_csv_line_writer.writeline(m_data);
+    }
+    m_data.clear();
+    pending = 0;
+  }
+
+  CSVReader<util::LazyRow, LineReader, util::DelimSplitLazy<util::LazyRow>> m_csv_reader;
+
+  bool m_has_header;
+  bool m_warn_columns;
+  char m_out_delim;
+  std::string m_line_terminator;
+  std::vector<Column> m_columns;
+  std::string m_data;
+
+  LineWriter& m_csv_line_writer;
+};
+
 }  // namespace csvio
 
 #endif  // MGUID_CSV_IO_HPP
@@ -0,0 +1,601 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Matthew Guidry
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef MGUID_CSV_IO_GROUP_BY_HPP
+#define MGUID_CSV_IO_GROUP_BY_HPP
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "csvio/csvio.hpp"
+#include "csvio/sort.hpp"
+
+namespace csvio {
+
+/** \brief aggregate function of a CSVGroupBy column
+ *  \ingroup group_by
+ *
+ *  COUNT counts the rows of a group. SUM and MEAN use the fields which parse as numbers.
+ *  MIN and MAX compare according to the KeyType of the aggregate. COUNT_DISTINCT counts the
+ *  different unescaped values of the column.
+ */
+enum AggregateOp { COUNT, SUM, MIN, MAX, MEAN, COUNT_DISTINCT };
+
+/** \struct Aggregate
+ *  \ingroup group_by
+ *  \brief An aggregate output column
+ */
+struct Aggregate {
+  AggregateOp op;
+  std::size_t index;
+  KeyType type{NUMERIC};
+  std::string name{};
+};
+
+/** \internal */
+namespace util {
+
+/** \brief hash a byte string, 8 bytes at a time
+ *  \ingroup group_by
+ *  \param data bytes to hash
+ *  \return 64 bit hash
+ */
+inline std::uint64_t hash_bytes(string_view data) {
+  std::uint64_t hash = 0x9e3779b97f4a7c15ull ^ data.size();
+  const char* pos = data.data();
+  std::size_t remaining = data.size();
+  for (; remaining >= 8; pos += 8, remaining -= 8) {
+    std::uint64_t word{0};
+    std::memcpy(&word, pos, sizeof(word));
+    hash = (hash ^ word) * 0xff51afd7ed558ccdull;
+    hash ^= hash >> 32;
+  }
+  std::uint64_t word{0};
+  std::memcpy(&word, pos, remaining);
+  hash = (hash ^ word) * 0xc4ceb9fe1a85ec53ull;
+  return hash ^ (hash >> 29);
+}
+
+/** \class RawKeyMap
+ *  \ingroup group_by
+ *  \brief Open addressing hash set of byte strings numbering every key in insertion order
+ *
+ *  Keys are copied into one arena, slots only hold the hash and the key number, so probing
+ *  with linear steps touches a single cache line in the common case.
+ */
+class RawKeyMap {
+public:
+  /** \brief returned by find for a missing key */
+  static constexpr std::uint32_t npos = static_cast<std::uint32_t>(-1);
+
+  /** \brief find a key, inserting it if it is new
+   *  \param key bytes of the key
+   *  \return number of the key and whether it was inserted
+   */
+  std::pair<std::uint32_t, bool> insert(string_view key) {
+    if ((m_keys.size() + 1) * 4 > m_slots.size() * 3) { grow(); }
+    const std::uint64_t hash = hash_bytes(key);
+    const std::size_t mask = m_slots.size() - 1;
+    for (std::size_t i = hash & mask;; i = (i + 1) & mask) {
+      Slot& slot = m_slots[i];
+      if (slot.index == npos) {
+        slot = {hash, static_cast<std::uint32_t>(m_keys.size())};
+        m_keys.push_back({m_arena.size(), key.size()});
+        m_arena.append(key.data(), key.size());
+        return {slot.index, true};
+      }
+      if (slot.hash == hash && this->key(slot.index) == key) { return {slot.index, false}; }
+    }
+  }
+
+  /** \brief find a key without inserting it
+   *  \param key bytes of the key
+   *  \return number of the key, or npos if it is missing
+   */
+  [[nodiscard]] std::uint32_t find(string_view key) const {
+    if (m_slots.empty()) { return npos; }
+    const std::uint64_t hash = hash_bytes(key);
+    const std::size_t mask = m_slots.size() - 1;
+    for (std::size_t i = hash & mask;; i = (i + 1) & mask) {
+      const Slot& slot = m_slots[i];
+      if (slot.index == npos) { return npos; }
+      if (slot.hash == hash && this->key(slot.index) == key) { return slot.index; }
+    }
+  }
+
+  /** \brief get a key by its number
+   *  \param index number of the key
+   *  \return view of the key, valid until the next insert
+   */
+  [[nodiscard]] string_view key(std::uint32_t index) const {
+    const Span& span = m_keys[index];
+    return string_view(m_arena).substr(span.offset, span.size);
+  }
+
+  /** \brief number of keys */
+  [[nodiscard]] std::size_t size() const { return m_keys.size(); }
+
+private:
+  struct Slot {
+    std::uint64_t hash;
+    std::uint32_t index;
+  };
+
+  struct Span {
+    std::size_t offset;
+    std::size_t size;
+  };
+
+  void grow() {
+    std::vector<Slot> slots(std::max<std::size_t>(64, m_slots.size() * 2), Slot{0, npos});
+    const std::size_t mask = slots.size() - 1;
+    for (const Slot& slot : m_slots) {
+      if (slot.index == npos) { continue; }
+      std::size_t i = slot.hash & mask;
+      while (slots[i].index != npos) { i = (i + 1) & mask; }
+      slots[i] = slot;
+    }
+    m_slots = std::move(slots);
+  }
+
+  std::vector<Slot> m_slots;
+  std::vector<Span> m_keys;
+  std::string m_arena;
+};
+
+/** \struct AggregateState
+ *  \ingroup group_by
+ *  \brief Running value of one aggregate of one group
+ */
+struct AggregateState {
+  double number{0.0};
+  std::uint64_t count{0};
+  std::string text{};
+  std::string sort_text{};
+};
+
+/** \class GroupByTable
+ *  \ingroup group_by
+ *  \brief Partial group by result, one per thread, which can be merged with others
+ *
+ *  Groups are keyed on the bytes of their key fields, fields without quotes are used
+ *  straight from the raw line. Every group remembers the first row it was seen in so that
+ *  merged results can be put back in input order.
+ */
+class GroupByTable {
+public:
+  /** \brief construct an empty table
+   *  \param keys key column positions
+   *  \param aggregates aggregate columns
+   */
+  GroupByTable(std::vector<std::size_t> keys, std::vector<Aggregate> aggregates)
+      : m_keys(std::move(keys)), m_aggregates(std::move(aggregates)) {}
+
+  /** \brief add a row to its group
+   *  \param row split row, missing fields are treated as empty
+   *  \param row_number position of the row in the input
+   */
+  void add(const LazyRow<std::string>& row, std::uint64_t row_number) {
+    m_scratch.clear();
+    for (const std::size_t index : m_keys) {
+      append_key_field(m_scratch, index < row.size() ? row[index] : string_view{});
+    }
+    const std::uint32_t group = group_of(m_scratch, row_number);
+
+    for (std::uint32_t a = 0; a < m_aggregates.size(); a++) {
+      const Aggregate& aggregate = m_aggregates[a];
+      const string_view field =
+          aggregate.index < row.size() ? row[aggregate.index] : string_view{};
+      AggregateState& state = m_states[group * m_aggregates.size() + a];
+      if (aggregate.op == COUNT) {
+        state.count++;
+      } else if (aggregate.op == COUNT_DISTINCT) {
+        m_scratch.clear();
+        m_scratch.append(reinterpret_cast<const char*>(&group), sizeof(group));
+        m_scratch.append(reinterpret_cast<const char*>(&a), sizeof(a));
+        m_scratch.append(field.data(), field.size());
+        if (m_distinct.insert(m_scratch).second) { state.count++; }
+      } else {
+        update(aggregate, state, field);
+      }
+    }
+  }
+
+  /** \brief fold another table into this one
+   *  \param other table built with the same keys and aggregates
+   */
+  void merge(const GroupByTable& other) {
+    std::vector<std::uint32_t> groups(other.size());
+    for (std::uint32_t g = 0; g < other.size(); g++) {
+      groups[g] = group_of(other.m_groups.key(g), other.m_first_rows[g]);
+      for (std::size_t a = 0; a < m_aggregates.size(); a++) {
+        combine(m_aggregates[a], m_states[groups[g] * m_aggregates.size() + a],
+                other.m_states[g * m_aggregates.size() + a]);
+      }
+    }
+
+    for (std::uint32_t i = 0; i < other.m_distinct.size(); i++) {
+      const string_view key = other.m_distinct.key(i);
+      std::uint32_t group{0};
+      std::uint32_t a{0};
+      std::memcpy(&group, key.data(), sizeof(group));
+      std::memcpy(&a, key.data() + sizeof(group), sizeof(a));
+      group = groups[group];
+      m_scratch.clear();
+      m_scratch.append(reinterpret_cast<const char*>(&group), sizeof(group));
+      m_scratch.append(key.data() + sizeof(group), key.size() - sizeof(group));
+      if (m_distinct.insert(m_scratch).second) {
+        m_states[group * m_aggregates.size() + a].count++;
+      }
+    }
+  }
+
+  /** \brief number of groups */
+  [[nodiscard]] std::size_t size() const { return m_groups.size(); }
+
+  /** \brief get the position of the first row of a group
+   *  \param group group number
+   *  \return row number passed to add()
+   */
+  [[nodiscard]] std::uint64_t first_row(std::uint32_t group) const {
+    return m_first_rows[group];
+  }
+
+  /** \brief get the key fields of a group
+   *  \param group group number
+   *  \param fields receives one unescaped value per key column
+   */
+  void key_fields(std::uint32_t group, std::vector<std::string>& fields) const {
+    const string_view key = m_groups.key(group);
+    fields.clear();
+    for (std::size_t pos = 0; pos < key.size();) {
+      std::uint32_t size{0};
+      std::memcpy(&size, key.data() + pos, sizeof(size));
+      pos += sizeof(size);
+      fields.emplace_back(key.substr(pos, size));
+      pos += size;
+    }
+  }
+
+  /** \brief format the value of an aggregate of a group
+   *  \param out string to append to
+   *  \param group group number
+   *  \param a position of the aggregate
+   */
+  void append_result(std::string& out, std::uint32_t group, std::size_t a) const {
+    const Aggregate& aggregate = m_aggregates[a];
+    const AggregateState& state = m_states[group * m_aggregates.size() + a];
+    if (aggregate.op == COUNT || aggregate.op == COUNT_DISTINCT) {
+      append_field(out, state.count, ',');
+    } else if (state.count == 0) {
+      return;
+    } else if (aggregate.op == MEAN) {
+      append_field(out, state.number / static_cast<double>(state.count), ',');
+    } else if (aggregate.op == SUM || aggregate.type == NUMERIC) {
+      append_field(out, state.number, ',');
+    } else {
+      out.append(state.text);
+    }
+  }
+
+private:
+  static void append_key_field(std::string& out, string_view field) {
+    const auto size = static_cast<std::uint32_t>(field.size());
+    out.append(reinterpret_cast<const char*>(&size), sizeof(size));
+    out.append(field.data(), field.size());
+  }
+
+  std::uint32_t group_of(string_view key, std::uint64_t row_number) {
+    const auto [group, inserted] = m_groups.insert(key);
+    if (inserted) {
+      m_first_rows.push_back(row_number);
+      m_states.resize(m_states.size() + m_aggregates.size());
+    } else if (row_number < m_first_rows[group]) {
+      m_first_rows[group] = row_number;
+    }
+    return group;
+  }
+
+  /** \brief true if a is a better MIN or MAX candidate than the current state */
+  static bool replaces(const Aggregate& aggregate, const AggregateState& state, double number,
+                       string_view text) {
+    if (state.count == 0) { return true; }
+    if (aggregate.type == NUMERIC) {
+      return aggregate.op == MIN ? number < state.number : number > state.number;
+    }
+    const string_view current = aggregate.type == DATE ? state.sort_text : state.text;
+    return aggregate.op == MIN ? text < current : text > current;
+  }
+
+  void update(const Aggregate& aggregate, AggregateState& state, string_view field) {
+    if (aggregate.op == SUM || aggregate.op == MEAN || aggregate.type == NUMERIC) {
+      double number{0.0};
+      if (field.empty() || !parse_field(field, number) || number != number) { return; }
+      if (aggregate.op == SUM || aggregate.op == MEAN) {
+        state.number += number;
+      } else if (replaces(aggregate, state, number, {})) {
+        state.number = number;
+      }
+    } else if (aggregate.type == DATE) {
+      m_date.clear();
+      append_sortable_date(m_date, field);
+      if (replaces(aggregate, state, 0.0, m_date)) {
+        state.text.assign(field.data(), field.size());
+        state.sort_text = m_date;
+      }
+    } else if (replaces(aggregate, state, 0.0, field)) {
+      state.text.assign(field.data(), field.size());
+    }
+    state.count++;
+  }
+
+  static void combine(const Aggregate& aggregate, AggregateState& state,
+                      const AggregateState& other) {
+    if (other.count == 0 || aggregate.op == COUNT_DISTINCT) { return; }
+    if (aggregate.op == COUNT || aggregate.op == SUM || aggregate.op == MEAN) {
+      state.number += other.number;
+    } else if (replaces(aggregate, state, other.number,
+                        aggregate.type == DATE ? other.sort_text : other.text)) {
+      state.number = other.number;
+      state.text = other.text;
+      state.sort_text = other.sort_text;
+    }
+    state.count += other.count;
+  }
+
+  std::vector<std::size_t> m_keys;
+  std::vector<Aggregate> m_aggregates;
+
+  RawKeyMap m_groups;
+  RawKeyMap m_distinct;
+  std::vector<std::uint64_t> m_first_rows;
+  std::vector<AggregateState> m_states;
+  std::string m_scratch;
+  std::string m_date;
+};
+
+}  // namespace util
+
+/** \class CSVGroupBy
+ *  \ingroup group_by
+ *  \brief Groups the rows of a csv by key columns and writes one row of aggregates per group
+ *
+ *  With one thread rows are read through a CSVReader. With more threads the calling thread
+ *  only reads raw lines in batches, worker threads split them with util::DelimSplitLazy and
+ *  aggregate into their own util::GroupByTable, and the tables are merged at the end.
+ *  Either way groups are written through a CSVWriter in the order they first appear, after
+ *  a header of the key names followed by the aggregate names. Blank lines are skipped.
+ */
+template <typename LineReader = csvio::util::CSVLineReader,
+          typename LineWriter = csvio::util::CSVLineWriter>
+class CSVGroupBy {
+public:
+  /** \brief construct a CSVGroupBy, reads the header if there is one
+   *  \param line_reader reference to a LineReader of the input
+   *  \param line_writer reference to a LineWriter of the output
+   *  \param delimiter input and output delimiter
+   *  \param has_header the input starts with a header
+   *  \param warn_columns warn about mismatched or unknown columns
+   *  \param line_terminator sequence that denotes the end of an output row
+   */
+  explicit CSVGroupBy(LineReader& line_reader, LineWriter& line_writer,
+                      const char delimiter = ',', bool has_header = true,
+                      bool warn_columns = true, std::string line_terminator = "\r\n")
+      : m_csv_line_reader(line_reader), m_csv_reader(line_reader, delimiter, has_header,
+                                                     warn_columns),
+        m_warn_columns(warn_columns),
+        m_csv_writer(line_writer, delimiter, warn_columns, std::move(line_terminator)) {}
+
+  /** \brief group by a column found by its header name, after the keys added before
+   *  \param name header name of the column
+   *  \param output_name name in the output header, empty keeps the input name
+   */
+  void add_key(const std::string& name, std::string output_name = "") {
+    add_key(util::find_column(m_csv_reader.get_header_names(), name, m_warn_columns),
+            output_name.empty() ? name : std::move(output_name));
+  }
+
+  /** \brief group by a column found by its position, after the keys added before
+   *  \param index position of the column, missing fields are treated as empty
+   *  \param output_name name in the output header, empty keeps the input name
+   */
+  void add_key(std::size_t index, std::string output_name = "") {
+    m_keys.push_back(index);
+    m_names.insert(m_names.begin() + static_cast<std::ptrdiff_t>(m_keys.size() - 1),
+                   output_name.empty() ? column_name(index) : std::move(output_name));
+  }
+
+  /** \brief add an aggregate of a column found by its header name
+   *  \param op aggregate function
+   *  \param name header name of the column, ignored by COUNT
+   *  \param type how MIN and MAX compare values
+   *  \param output_name name in the output header, empty names it after op and column
+   */
+  void add_aggregate(AggregateOp op, const std::string& name, KeyType type = NUMERIC,
+                     std::string output_name = "") {
+    const std::size_t index =
+        op == COUNT ? 0 : util::find_column(m_csv_reader.get_header_names(), name, m_warn_columns);
+    add_aggregate(op, index, type, std::move(output_name));
+  }
+
+  /** \brief add an aggregate of a column found by its position
+   *  \param op aggregate function
+   *  \param index position of the column, ignored by COUNT
+   *  \param type how MIN and MAX compare values
+   *  \param output_name name in the output header, empty names it after op and column
+   */
+  void add_aggregate(AggregateOp op, std::size_t index, KeyType type = NUMERIC,
+                     std::string output_name = "") {
+    static constexpr const char* prefixes[]{"count", "sum", "min", "max", "mean",
+                                            "count_distinct"};
+    if (output_name.empty()) {
+      output_name = op == COUNT ? "count" : std::string(prefixes[op]) + "_" + column_name(index);
+    }
+    m_aggregates.push_back({op, index, type, output_name});
+    m_names.push_back(std::move(output_name));
+  }
+
+  /** \brief set the number of threads aggregating rows
+   *  \param threads number of threads, 0 uses the hardware concurrency
+   */
+  void set_threads(unsigned threads) { m_threads = threads; }
+
+  /** \brief aggregate every remaining row of the input and write the groups
+   *  \return number of groups written
+   */
+  std::size_t run() {
+    if (m_threads == 0) { m_threads = std::max(1u, std::thread::hardware_concurrency()); }
+    util::GroupByTable table(m_keys, m_aggregates);
+    if (m_threads == 1) {
+      std::uint64_t row_number{0};
+      while (m_csv_reader.good()) {
+        const auto& row = m_csv_reader.read();
+        if (!util::is_blank_row(row)) { table.add(row, row_number); }
+        row_number++;
+      }
+    } else {
+      run_parallel(table);
+    }
+
+    std::vector<std::uint32_t> order(table.size());
+    for (std::uint32_t g = 0; g < order.size(); g++) { order[g] = g; }
+    std::sort(order.begin(), order.end(), [&table](std::uint32_t a, std::uint32_t b) {
+      return table.first_row(a) < table.first_row(b);
+    });
+
+    m_csv_writer.write_header(m_names);
+    std::vector<std::string> fields;
+    std::vector<std::string> row;
+    for (const std::uint32_t group : order) {
+      table.key_fields(group, fields);
+      row.assign(fields.begin(), fields.end());
+      for (std::size_t a = 0; a < m_aggregates.size(); a++) {
+        row.emplace_back();
+        table.append_result(row.back(), group, a);
+      }
+      m_csv_writer.write(row);
+    }
+    return order.size();
+  }
+
+  /** \brief Get number of csv lines written so far
+   *  \return number of csv lines written so far
+   */
+  [[nodiscard]] std::size_t lcount() const { return m_csv_writer.lcount(); }
+
+protected:
+  static constexpr std::size_t batch_lines = 4096;
+
+  struct Batch {
+    std::vector<std::string> lines;
+    std::uint64_t first_row;
+  };
+
+  void run_parallel(util::GroupByTable& table) {
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<Batch> batches;
+    bool finished{false};
+    const char delim = m_csv_reader.get_delimiter();
+
+    std::vector<util::GroupByTable> tables(m_threads - 1, table);
+    const auto aggregate_batches = [&](util::GroupByTable& partial) {
+      util::DelimSplitLazy<util::LazyRow> parser;
+      while (true) {
+        Batch batch;
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          changed.wait(lock, [&] { return !batches.empty() || finished; });
+          if (batches.empty()) { return; }
+          batch = std::move(batches.front());
+          batches.pop_front();
+        }
+        changed.notify_all();
+        for (std::size_t i = 0; i < batch.lines.size(); i++) {
+          if (batch.lines[i].empty()) { continue; }
+          const auto& row = parser(batch.lines[i], delim);
+          if (!util::is_blank_row(row)) { partial.add(row, batch.first_row + i); }
+        }
+      }
+    };
+
+    std::vector<std::thread> workers;
+    workers.emplace_back(aggregate_batches, std::ref(table));
+    for (auto& partial : tables) { workers.emplace_back(aggregate_batches, std::ref(partial)); }
+
+    std::uint64_t row_number{0};
+    while (m_csv_line_reader.good()) {
+      Batch batch{{}, row_number};
+      batch.lines.reserve(batch_lines);
+      while (batch.lines.size() < batch_lines && m_csv_line_reader.good()) {
+        batch.lines.push_back(m_csv_line_reader.readline());
+      }
+      row_number += batch.lines.size();
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [&] { return batches.size() < m_threads * 2; });
+        batches.push_back(std::move(batch));
+      }
+      changed.notify_all();
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      finished = true;
+    }
+    changed.notify_all();
+    for (auto& worker : workers) { worker.join(); }
+
+    for (const auto& partial : tables) { table.merge(partial); }
+  }
+
+  std::string column_name(std::size_t index) {
+    const auto& header = m_csv_reader.get_header_names();
+    if (index < header.size()) { return std::string(header[index]); }
+    return "column_" + std::to_string(index);
+  }
+
+  LineReader& m_csv_line_reader;
+  CSVReader<util::LazyRow, LineReader, util::DelimSplitLazy<util::LazyRow>> m_csv_reader;
+
+  bool m_warn_columns;
+  unsigned m_threads{0};
+  std::vector<std::size_t> m_keys;
+  std::vector<Aggregate> m_aggregates;
+  std::vector<std::string> m_names;
+
+  CSVWriter<std::vector, LineWriter> m_csv_writer;
+};
+
+}  // namespace csvio
+
+#endif  // MGUID_CSV_IO_GROUP_BY_HPP
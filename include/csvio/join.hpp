@@ -0,0 +1,259 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Matthew Guidry
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef MGUID_CSV_IO_JOIN_HPP
+#define MGUID_CSV_IO_JOIN_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "csvio/csvio.hpp"
+#include "csvio/group_by.hpp"
+
+namespace csvio {
+
+/** \brief which probe rows a CSVJoin writes
+ *  \ingroup join
+ *
+ *  INNER writes a probe row once per matching build row and drops rows without a match.
+ *  LEFT also writes probe rows without a match, with empty build columns.
+ */
+enum JoinType { INNER, LEFT };
+
+/** \class CSVJoin
+ *  \ingroup join
+ *  \brief Joins a csv streamed through a CSVReader with a smaller csv held in memory
+ *
+ *  The whole build side is read first. Its unescaped fields are copied into one arena and
+ *  its keys into a util::RawKeyMap, rows sharing a key are chained in input order. The probe
+ *  side is then read row by row and every output row is written through a CSVWriter as the
+ *  probe fields followed by the build fields that are not keys. Blank lines are skipped.
+ */
+template <typename LineReader = csvio::util::CSVLineReader,
+          typename LineWriter = csvio::util::CSVLineWriter>
+class CSVJoin {
+public:
+  /** \brief construct a CSVJoin, reads the headers of both inputs if there are any
+   *  \param build_reader reference to a LineReader of the smaller input, held in memory
+   *  \param probe_reader reference to a LineReader of the streamed input
+   *  \param line_writer reference to a LineWriter of the output
+   *  \param type INNER or LEFT join
+   *  \param delimiter input and output delimiter
+   *  \param has_header both inputs start with a header, which is joined into the output
+   *  \param warn_columns warn about mismatched or unknown columns
+   *  \param line_terminator sequence that denotes the end of an output row
+   */
+  explicit CSVJoin(LineReader& build_reader, LineReader& probe_reader, LineWriter& line_writer,
+                   JoinType type = INNER, const char delimiter = ',', bool has_header = true,
+                   bool warn_columns = true, std::string line_terminator = "\r\n")
+      : m_build_reader(build_reader, delimiter, has_header, warn_columns),
+        m_probe_reader(probe_reader, delimiter, has_header, warn_columns), m_type(type),
+        m_has_header(has_header), m_warn_columns(warn_columns),
+        m_csv_writer(line_writer, delimiter, warn_columns, std::move(line_terminator)) {}
+
+  /** \brief join on a pair of columns found by their header names, after the keys added before
+   *  \param build_name header name of the column in the build input
+   *  \param probe_name header name of the column in the probe input, empty uses build_name
+   */
+  void add_key(const std::string& build_name, const std::string& probe_name = "") {
+    add_key(util::find_column(m_build_reader.get_header_names(), build_name, m_warn_columns),
+            util::find_column(m_probe_reader.get_header_names(),
+                              probe_name.empty() ? build_name : probe_name, m_warn_columns));
+  }
+
+  /** \brief join on a pair of columns found by their positions, after the keys added before
+   *  \param build_index position of the column in the build input
+   *  \param probe_index position of the column in the probe input
+   */
+  void add_key(std::size_t build_index, std::size_t probe_index) {
+    m_build_keys.push_back(build_index);
+    m_probe_keys.push_back(probe_index);
+  }
+
+  /** \brief set which probe rows are written
+   *  \param type INNER or LEFT join
+   */
+  void set_join_type(JoinType type) { m_type = type; }
+
+  /** \brief get which probe rows are written
+   *  \return INNER or LEFT join
+   */
+  [[nodiscard]] JoinType get_join_type() const { return m_type; }
+
+  /** \brief read the build input, then join every remaining row of the probe input
+   *  \return number of rows written, not counting the header
+   *  \throw std::logic_error if no key was added, every row would match every other row
+   */
+  std::size_t run() {
+    if (m_build_keys.empty()) { throw std::logic_error("CSVJoin::run called without add_key"); }
+    build();
+
+    const auto& probe_header = m_probe_reader.get_header_names();
+    std::size_t probe_columns{0};
+    if (m_has_header) {
+      probe_columns = probe_header.size();
+      std::vector<std::string> header(probe_header.begin(), probe_header.end());
+      const auto& build_header = m_build_reader.get_header_names();
+      for (const std::size_t index : m_build_columns) {
+        header.emplace_back(index < build_header.size() ? build_header[index] : string_view{});
+      }
+      m_csv_writer.write_header(header);
+    }
+
+    std::size_t rows{0};
+    std::vector<string_view> out;
+    while (m_probe_reader.good()) {
+      const auto& row = m_probe_reader.read();
+      if (util::is_blank_row(row)) { continue; }
+      if (probe_columns == 0) { probe_columns = row.size(); }
+
+      out.clear();
+      for (std::size_t i = 0; i < probe_columns; i++) {
+        out.push_back(i < row.size() ? row[i] : string_view{});
+      }
+      append_key(m_key, row, m_probe_keys);
+      const std::uint32_t match = m_keys.find(m_key);
+
+      if (match == util::RawKeyMap::npos) {
+        if (m_type == INNER) { continue; }
+        out.resize(probe_columns + m_build_columns.size());
+        m_csv_writer.write(out);
+        rows++;
+        continue;
+      }
+      for (std::uint32_t build_row = m_heads[match]; build_row != util::RawKeyMap::npos;
+           build_row = m_next[build_row]) {
+        out.resize(probe_columns);
+        for (std::size_t c = 0; c < m_build_columns.size(); c++) {
+          const Span& span = m_fields[build_row * m_build_columns.size() + c];
+          out.push_back(string_view(m_arena).substr(span.offset, span.size));
+        }
+        m_csv_writer.write(out);
+        rows++;
+      }
+    }
+    return rows;
+  }
+
+  /** \brief Get number of rows held from the build input
+   *  \return number of build rows
+   */
+  [[nodiscard]] std::size_t build_rows() const { return m_next.size(); }
+
+  /** \brief Get number of csv lines written so far
+   *  \return number of csv lines written so far
+   */
+  [[nodiscard]] std::size_t lcount() const { return m_csv_writer.lcount(); }
+
+protected:
+  using Reader = CSVReader<util::LazyRow, LineReader, util::DelimSplitLazy<util::LazyRow>>;
+
+  struct Span {
+    std::size_t offset;
+    std::size_t size;
+  };
+
+  static void append_key(std::string& out, const util::LazyRow<std::string>& row,
+                         const std::vector<std::size_t>& keys) {
+    out.clear();
+    for (const std::size_t index : keys) {
+      const string_view field = index < row.size() ? row[index] : string_view{};
+      const auto size = static_cast<std::uint32_t>(field.size());
+      out.append(reinterpret_cast<const char*>(&size), sizeof(size));
+      out.append(field.data(), field.size());
+    }
+  }
+
+  void build() {
+    std::vector<std::uint32_t> tails;
+    bool columns_known{false};
+    if (m_has_header) {
+      set_build_columns(m_build_reader.get_header_names().size());
+      columns_known = true;
+    }
+
+    while (m_build_reader.good()) {
+      const auto& row = m_build_reader.read();
+      if (util::is_blank_row(row)) { continue; }
+      if (!columns_known) {
+        set_build_columns(row.size());
+        columns_known = true;
+      }
+
+      for (const std::size_t index : m_build_columns) {
+        const string_view field = index < row.size() ? row[index] : string_view{};
+        m_fields.push_back({m_arena.size(), field.size()});
+        m_arena.append(field.data(), field.size());
+      }
+
+      const auto build_row = static_cast<std::uint32_t>(m_next.size());
+      m_next.push_back(util::RawKeyMap::npos);
+      append_key(m_key, row, m_build_keys);
+      const auto [key, inserted] = m_keys.insert(m_key);
+      if (inserted) {
+        m_heads.push_back(build_row);
+        tails.push_back(build_row);
+      } else {
+        m_next[tails[key]] = build_row;
+        tails[key] = build_row;
+      }
+    }
+  }
+
+  void set_build_columns(std::size_t columns) {
+    for (std::size_t index = 0; index < columns; index++) {
+      if (std::find(m_build_keys.begin(), m_build_keys.end(), index) == m_build_keys.end()) {
+        m_build_columns.push_back(index);
+      }
+    }
+  }
+
+  Reader m_build_reader;
+  Reader m_probe_reader;
+
+  JoinType m_type;
+  bool m_has_header;
+  bool m_warn_columns;
+  std::vector<std::size_t> m_build_keys;
+  std::vector<std::size_t> m_probe_keys;
+  std::vector<std::size_t> m_build_columns;
+
+  util::RawKeyMap m_keys;
+  std::vector<std::uint32_t> m_heads;
+  std::vector<std::uint32_t> m_next;
+  std::vector<Span> m_fields;
+  std::string m_arena;
+  std::string m_key;
+
+  CSVWriter<std::vector, LineWriter> m_csv_writer;
+};
+
+}  // namespace csvio
+
+#endif  // MGUID_CSV_IO_JOIN_HPP
@@ -0,0 +1,313 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Matthew Guidry
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef MGUID_CSV_IO_LOGGER_HPP
+#define MGUID_CSV_IO_LOGGER_HPP
+
+#include <chrono>
+#include <ctime>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "csvio/csvio.hpp"
+
+namespace csvio {
+
+/** \brief severity of a log entry
+ *  \ingroup logger
+ */
+enum LogLevel { LOG_DEBUG, LOG_INFO, LOG_WARN, LOG_ERROR, LOG_FATAL };
+
+/** \internal */
+namespace util {
+
+/** \brief name of a log level as written to the LEVEL column
+ *  \ingroup logger
+ *  \param level log level
+ *  \return upper case level name
+ */
+inline string_view log_level_name(LogLevel level) {
+  static constexpr const char* names[]{"DEBUG", "INFO", "WARN", "ERROR", "FATAL"};
+  return names[level];
+}
+
+/** \class TimestampCache
+ *  \ingroup logger
+ *  \brief Formats local time as "YYYY-MM-DD HH:MM:SS.ffffff"
+ *
+ *  The date and time prefix is only rebuilt through localtime when the second changes,
+ *  every other call just writes the microseconds.
+ */
+class TimestampCache {
+public:
+  /** \brief length of a formatted timestamp */
+  static constexpr std::size_t length = 26;
+
+  /** \brief format a point in time
+   *  \param now point in time to format
+   *  \return view of the formatted timestamp, valid until the next call
+   */
+  string_view format(std::chrono::system_clock::time_point now) {
+    const auto since_epoch = now.time_since_epoch();
+    const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(since_epoch);
+    auto micros =
+        std::chrono::duration_cast<std::chrono::microseconds>(since_epoch - seconds).count();
+
+    const auto second = static_cast<std::time_t>(seconds.count());
+    if (second != m_second) {
+      std::tm local{};
+#if defined(_WIN32)
+      localtime_s(&local, &second);
+#else
+      localtime_r(&second, &local);
+#endif
+      std::strftime(m_text, sizeof(m_text), "%Y-%m-%d %H:%M:%S", &local);
+      m_text[19] = '.';
+      m_second = second;
+    }
+    for (std::size_t i = length; i > 20; i--) {
+      m_text[i - 1] = static_cast<char>('0' + micros % 10);
+      micros /= 10;
+    }
+    return {m_text, length};
+  }
+
+private:
+  std::time_t m_second{-1};
+  char m_text[length + 1]{};
+};
+
+/** \brief detect LineWriters which repeat a header at the start of every file they create
+ *  \ingroup logger
+ */
+template <typename LineWriter, typename = void>
+struct has_set_header : std::false_type {};
+
+template <typename LineWriter>
+struct has_set_header<LineWriter, std::void_t<decltype(std::declval<LineWriter&>().set_header(
+                                      std::declval<std::string>()))>> : std::true_type {};
+
+}  // namespace util
+
+/** \class CSVLogger
+ *  \ingroup logger
+ *  \brief Structured csv log with TIME, LEVEL, FUNC and MESSAGE columns
+ *
+ *  The calling thread formats the whole csv line into a thread local buffer and swaps it
+ *  onto a CSVAsyncWriter's queue for a buffer the background thread has already written, so
+ *  once the queue has cycled a log call does not allocate. The LineWriter is only ever used
+ *  by the background thread. Combine
+ *  with RotatingFileLineWriter for size based rotation, the header is repeated in every file.
+ */
+template <class LineWriter = csvio::util::CSVLineWriter>
+class CSVLogger {
+public:
+  /** \class Message
+   *  \brief Collects a streamed message and logs it when destroyed
+   */
+  class Message {
+  public:
+    /** \brief start a message, nothing is collected when the level is disabled
+     *  \param logger logger to log to
+     *  \param level level of the message
+     *  \param location value of the FUNC column, must outlive the message
+     */
+    Message(CSVLogger& logger, LogLevel level, string_view location)
+        : m_logger(logger), m_level(level), m_location(location),
+          m_enabled(logger.enabled(level)) {
+      if (!m_enabled) { return; }
+      // reuse the thread's buffer unless a message is logged while streaming another one
+      auto& buffer = thread_buffer();
+      if (!buffer.in_use) {
+        buffer.in_use = true;
+        buffer.text.clear();
+        m_text = &buffer.text;
+      } else {
+        m_text = &m_own_text;
+      }
+    }
+
+    Message(const Message&) = delete;
+    Message& operator=(const Message&) = delete;
+
+    /** \brief log the collected message
+     */
+    ~Message() {
+      if (!m_enabled) { return; }
+      m_logger.log(m_level, m_location, *m_text);
+      if (m_text != &m_own_text) { thread_buffer().in_use = false; }
+    }
+
+    /** \brief append a string, character, bool or number to the message
+     *  \param value value to append
+     *  \return this message
+     */
+    template <typename T>
+    Message& operator<<(const T& value) {
+      if (!m_enabled) { return *this; }
+      if constexpr (std::is_same_v<T, char>) {
+        m_text->push_back(value);
+      } else if constexpr (std::is_arithmetic_v<T>) {
+        util::append_field(*m_text, value, ',');
+      } else {
+        const string_view text(value);
+        m_text->append(text.data(), text.size());
+      }
+      return *this;
+    }
+
+  private:
+    struct ThreadBuffer {
+      std::string text;
+      bool in_use{false};
+    };
+
+    static ThreadBuffer& thread_buffer() {
+      thread_local ThreadBuffer buffer;
+      return buffer;
+    }
+
+    CSVLogger& m_logger;
+    LogLevel m_level;
+    string_view m_location;
+    bool m_enabled;
+    std::string* m_text{nullptr};
+    std::string m_own_text;
+  };
+
+  /** \brief construct a CSVLogger and write the header
+   *  \param line_writer reference to a LineWriter, used from a background thread
+   *  \param level lowest level which is logged
+   *  \param policy what log calls do when the queue is full, GROW never blocks the caller
+   *  \param capacity minimum number of entries the queue can hold
+   *  \param delimiter output delimiter
+   */
+  explicit CSVLogger(LineWriter& line_writer, LogLevel level = LOG_DEBUG,
+                     util::QueueFullPolicy policy = util::GROW,
+                     std::size_t capacity = util::default_async_queue_capacity,
+                     const char delimiter = ',')
+      : m_level(level), m_delim(delimiter),
+        m_writer(line_writer, delimiter, false, "\r\n", policy, capacity) {
+    std::string header;
+    for (const char* name : {"TIME", "LEVEL", "FUNC", "MESSAGE"}) {
+      if (!header.empty()) { header.push_back(m_delim); }
+      header.append(name);
+    }
+    header.append("\r\n");
+    // a log call should not pay for waking the background thread, let it poll instead
+    m_writer.set_wake_backlog(capacity / 2);
+    // nothing is queued yet, so the background thread has not touched the LineWriter
+    if constexpr (util::has_set_header<LineWriter>::value) { line_writer.set_header(header); }
+    m_writer.write_line(std::move(header));
+  }
+
+  /** \brief log a message
+   *  \param level level of the message
+   *  \param location value of the FUNC column
+   *  \param message value of the MESSAGE column
+   *  \return true if queued, false if filtered out or dropped
+   */
+  bool log(LogLevel level, string_view location, string_view message) {
+    if (!enabled(level)) { return false; }
+    thread_local util::TimestampCache timestamp;
+    thread_local std::string line;
+
+    line.clear();
+    const auto time = timestamp.format(std::chrono::system_clock::now());
+    line.append(time.data(), time.size());
+    line.push_back(m_delim);
+    const auto name = util::log_level_name(level);
+    line.append(name.data(), name.size());
+    line.push_back(m_delim);
+    util::escape_append(line, location, m_delim);
+    line.push_back(m_delim);
+    util::escape_append(line, message, m_delim);
+    line.append("\r\n");
+    return m_writer.exchange_line(line);
+  }
+
+  /** \brief start a DEBUG message */
+  Message debug(string_view location = "") { return {*this, LOG_DEBUG, location}; }
+  /** \brief start an INFO message */
+  Message info(string_view location = "") { return {*this, LOG_INFO, location}; }
+  /** \brief start a WARN message */
+  Message warn(string_view location = "") { return {*this, LOG_WARN, location}; }
+  /** \brief start an ERROR message */
+  Message error(string_view location = "") { return {*this, LOG_ERROR, location}; }
+  /** \brief start a FATAL message */
+  Message fatal(string_view location = "") { return {*this, LOG_FATAL, location}; }
+
+  /** \brief check if a level is logged
+   *  \param level level to check
+   *  \return true if level is at or above the current level
+   */
+  [[nodiscard]] bool enabled(LogLevel level) const {
+    return level >= m_level.load(std::memory_order_relaxed);
+  }
+
+  /** \brief set the lowest level which is logged
+   *  \param level new level
+   */
+  void set_level(LogLevel level) { m_level.store(level, std::memory_order_relaxed); }
+
+  /** \brief get the lowest level which is logged
+   *  \return current level
+   */
+  [[nodiscard]] LogLevel get_level() const { return m_level.load(std::memory_order_relaxed); }
+
+  /** \brief block until every entry logged before this call has been handed to the LineWriter
+   */
+  void flush() { m_writer.flush(); }
+
+  /** \brief write all queued entries and stop the background thread
+   */
+  void close() { m_writer.close(); }
+
+  /** \brief Get number of lines written so far, including the header
+   *  \return number of lines written so far
+   */
+  [[nodiscard]] std::size_t lcount() const { return m_writer.lcount(); }
+
+  /** \brief Get number of entries dropped because the queue was full
+   *  \return number of dropped entries
+   */
+  [[nodiscard]] std::size_t dropped() const { return m_writer.dropped(); }
+
+private:
+  std::atomic<LogLevel> m_level;
+  char m_delim;
+  CSVAsyncWriter<std::vector, LineWriter> m_writer;
+};
+
+}  // namespace csvio
+
+#define CSVIO_LOG_DEBUG(logger) (logger).debug(__func__)
+#define CSVIO_LOG_INFO(logger) (logger).info(__func__)
+#define CSVIO_LOG_WARN(logger) (logger).warn(__func__)
+#define CSVIO_LOG_ERROR(logger) (logger).error(__func__)
+#define CSVIO_LOG_FATAL(logger) (logger).fatal(__func__)
+
+#endif  // MGUID_CSV_IO_LOGGER_HPP
@@ -0,0 +1,331 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Matthew Guidry
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef MGUID_CSV_IO_MULTI_FILE_HPP
+#define MGUID_CSV_IO_MULTI_FILE_HPP
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "csvio/csvio.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <glob.h>
+#endif
+
+/** \internal */
+namespace csvio::util {
+
+/** \brief default number of bytes read from the next file while the current one is parsed
+ *  \ingroup line_reader
+ */
+inline constexpr std::size_t default_prefetch_size = 4 * default_block_size;
+
+/** \brief list the files matching a shell pattern
+ *  \ingroup line_reader
+ *
+ *  Without POSIX glob() the pattern is returned as the only path.
+ *
+ *  \param pattern shell pattern, e.g. "data/part-*.csv"
+ *  \return matching paths in lexicographic order
+ */
+inline std::vector<std::string> glob_files(const std::string& pattern) {
+  std::vector<std::string> paths;
+#if defined(__unix__) || defined(__APPLE__)
+  glob_t matches{};
+  if (::glob(pattern.c_str(), 0, nullptr, &matches) == 0) {
+    for (std::size_t i = 0; i < matches.gl_pathc; i++) { paths.emplace_back(matches.gl_pathv[i]); }
+  }
+  ::globfree(&matches);
+  std::sort(paths.begin(), paths.end());
+#else
+  paths.push_back(pattern);
+#endif
+  return paths;
+}
+
+/** \struct PrefetchedFile
+ *  \ingroup byte_source
+ *  \brief An opened file together with its first bytes, read ahead of time
+ */
+struct PrefetchedFile {
+  struct Closer {
+    void operator()(std::FILE* file) const { std::fclose(file); }
+  };
+
+  /** \brief open a file and read its first bytes
+   *  \param path file to open
+   *  \param count number of bytes to read ahead, at least one byte is read
+   *  \return the file, not open if path could not be opened
+   */
+  static PrefetchedFile open(std::string path, std::size_t count) {
+    PrefetchedFile prefetched{std::move(path), nullptr, {}};
+    prefetched.file.reset(std::fopen(prefetched.path.c_str(), "rb"));
+    if (prefetched.file) {
+      count = std::max<std::size_t>(count, 1);
+      prefetched.head.resize(count);
+      prefetched.head.resize(std::fread(prefetched.head.data(), 1, count, prefetched.file.get()));
+    }
+    return prefetched;
+  }
+
+  std::string path;
+  std::unique_ptr<std::FILE, Closer> file;
+  std::string head;
+};
+
+/** \class PrefetchedFileByteSource
+ *  \ingroup byte_source
+ *  \brief ByteSource handing out the prefetched head of a file, then the rest of it in blocks
+ */
+class PrefetchedFileByteSource {
+public:
+  /** \brief Construct a PrefetchedFileByteSource, taking ownership of the file
+   *  \param file opened file and its first bytes
+   */
+  explicit PrefetchedFileByteSource(PrefetchedFile file) : m_file(std::move(file)) {}
+
+  /** \brief get the next bytes of the file
+   *  \return view valid until the next call, empty once the file is exhausted
+   */
+  string_view next_view() {
+    if (!m_head_read) {
+      m_head_read = true;
+      if (!m_file.head.empty()) { return m_file.head; }
+    }
+    if (!m_file.file) { return {}; }
+    if (m_block.empty()) {
+      m_file.head = std::string();
+      m_block.resize(default_block_size);
+    }
+    const std::size_t n = std::fread(m_block.data(), 1, m_block.size(), m_file.file.get());
+    return string_view(m_block.data(), n);
+  }
+
+  /** \brief check whether the file could be opened */
+  [[nodiscard]] bool is_open() const { return m_file.file != nullptr; }
+
+  /** \brief check whether the file turned out to be empty when it was prefetched */
+  [[nodiscard]] bool empty() const { return !m_head_read && m_file.head.empty(); }
+
+  /** \brief path of the file */
+  [[nodiscard]] const std::string& path() const { return m_file.path; }
+
+private:
+  PrefetchedFile m_file;
+  std::vector<char> m_block;
+  bool m_head_read{false};
+};
+
+/** \class MultiFileLineReader
+ *  \ingroup line_reader
+ *  \brief Reads the lines of several files sharing a header as if they were one csv
+ *
+ *  The header of the first file is returned like any other line, so a CSVReader built on
+ *  top of this reader handles it as usual. The first line of every later file is compared
+ *  with it and skipped, a std::runtime_error is thrown if it differs. While a file is read
+ *  a background thread opens the next one and reads its first bytes, so crossing into the
+ *  next file does not wait on a cold open and read. Files which cannot be opened are skipped
+ *  with a warning.
+ */
+class MultiFileLineReader {
+public:
+  /** \brief Construct a MultiFileLineReader and start opening the first file
+   *  \param paths files to read, in order
+   *  \param has_header every file starts with the same header
+   *  \param prefetch_size number of bytes read ahead from the next file
+   */
+  explicit MultiFileLineReader(std::vector<std::string> paths, bool has_header = true,
+                               std::size_t prefetch_size = default_prefetch_size)
+      : m_paths(std::move(paths)), m_has_header(has_header), m_prefetch_size(prefetch_size),
+        m_prefetcher([this] { prefetch_files(); }) {
+    try {
+      next_file();
+    } catch (...) {
+      stop();
+      throw;
+    }
+  }
+
+  MultiFileLineReader(const MultiFileLineReader&) = delete;
+  MultiFileLineReader& operator=(const MultiFileLineReader&) = delete;
+
+  ~MultiFileLineReader() { stop(); }
+
+  /** \brief read a csv line, moving on to the next file when the current one is exhausted
+   *  \return a string with the contents of the csv line
+   */
+  std::string readline() {
+    if (m_first_header) {
+      std::string line = std::move(*m_first_header);
+      m_first_header.reset();
+      m_lines_read++;
+      return line;
+    }
+    if (!m_reader) { return {}; }
+    std::string line = m_reader->readline();
+    m_lines_read++;
+    if (!m_reader->good()) { next_file(); }
+    return line;
+  }
+
+  /** \brief set the sequence which terminates a line, applies from the next line on
+   *  \param terminator single or multi byte terminating sequence, e.g. "\r\n" or "\x01"
+   *  \param keep_terminator keep the sequence at the end of returned lines
+   */
+  void set_line_terminator(std::string terminator, bool keep_terminator = false) {
+    m_terminator = std::move(terminator);
+    m_keep_terminator = keep_terminator;
+    if (m_reader) { m_reader->set_line_terminator(*m_terminator, m_keep_terminator); }
+  }
+
+  /** \brief Get number of csv lines read so far, skipped headers are not counted
+   *  \return number of csv lines read so far
+   */
+  [[nodiscard]] std::size_t lcount() const { return m_lines_read; }
+
+  /** \brief check if there are lines left in any file
+   *  \return true if good, otherwise false
+   */
+  bool good() { return m_first_header || m_reader; }
+
+  /** \brief path of the file the next line is read from
+   *  \return path, empty once every file is exhausted
+   */
+  [[nodiscard]] std::string current_path() const {
+    return m_reader ? m_reader->source().path() : std::string();
+  }
+
+  /** \brief position of the file the next line is read from in the list of paths
+   *  \return index into the paths, the number of paths once every file is exhausted
+   */
+  [[nodiscard]] std::size_t file_index() const { return m_file_index; }
+
+private:
+  using Reader = BasicCSVLineReader<PrefetchedFileByteSource>;
+
+  void stop() {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stop = true;
+    }
+    m_changed.notify_all();
+    m_prefetcher.join();
+  }
+
+  /** \brief runs on the background thread, keeps the next file opened and prefetched */
+  void prefetch_files() {
+    for (const auto& path : m_paths) {
+      PrefetchedFile file = PrefetchedFile::open(path, m_prefetch_size);
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_changed.wait(lock, [this] { return !m_next || m_stop; });
+      if (m_stop) { return; }
+      m_next = std::move(file);
+      lock.unlock();
+      m_changed.notify_all();
+    }
+  }
+
+  /** \brief take the next file from the background thread, waiting for it if needed */
+  PrefetchedFile take_next() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_changed.wait(lock, [this] { return m_next.has_value(); });
+    PrefetchedFile file = std::move(*m_next);
+    m_next.reset();
+    lock.unlock();
+    m_changed.notify_all();
+    return file;
+  }
+
+  /** \brief open files until one has a line after its header, or none are left */
+  void next_file() {
+    m_reader.reset();
+    while (m_next_path < m_paths.size()) {
+      m_file_index = m_next_path++;
+      auto reader = std::make_unique<Reader>(take_next());
+      if (!reader->source().is_open()) {
+        std::cerr << "[warning] Could not open " << reader->source().path() << "\n";
+        continue;
+      }
+      if (m_terminator) { reader->set_line_terminator(*m_terminator, m_keep_terminator); }
+      if (reader->source().empty()) { continue; }
+      if (m_has_header && !check_header(*reader)) { continue; }
+      m_reader = std::move(reader);
+      return;
+    }
+    m_file_index = m_paths.size();
+  }
+
+  /** \brief read the header of a file and compare it with the first header
+   *  \return true if the file has lines after its header
+   */
+  bool check_header(Reader& reader) {
+    std::string line = reader.readline();
+    std::string header = line;
+    while (!header.empty() && (header.back() == '\n' || header.back() == '\r')) {
+      header.pop_back();
+    }
+    if (!m_header) {
+      m_header = std::move(header);
+      m_first_header = std::move(line);  // returned by the first readline
+    } else if (header != *m_header) {
+      throw std::runtime_error("MultiFileLineReader header of " + reader.source().path() +
+                               " does not match the first file");
+    }
+    return reader.good();
+  }
+
+  std::vector<std::string> m_paths;
+  bool m_has_header;
+  std::size_t m_prefetch_size;
+  std::optional<std::string> m_terminator;
+  bool m_keep_terminator{false};
+
+  std::size_t m_next_path{0};
+  std::size_t m_file_index{0};
+  std::unique_ptr<Reader> m_reader;
+  std::optional<std::string> m_header;
+  std::optional<std::string> m_first_header;
+  std::size_t m_lines_read{0};
+
+  std::mutex m_mutex;
+  std::condition_variable m_changed;
+  std::optional<PrefetchedFile> m_next;
+  bool m_stop{false};
+  std::thread m_prefetcher;
+};
+
+}  // namespace csvio::util
+
+#endif  // MGUID_CSV_IO_MULTI_FILE_HPP
@@ -0,0 +1,444 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Matthew Guidry
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef MGUID_CSV_IO_SNAPSHOT_HPP
+#define MGUID_CSV_IO_SNAPSHOT_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "csvio/csvio.hpp"
+
+namespace csvio {
+
+/** \internal */
+namespace util {
+
+/** \struct SnapshotHeader
+ *  \ingroup snapshot
+ *  \brief Fixed size start of a snapshot file
+ *
+ *  A snapshot is the header, the unescaped bytes of every field back to back, padding to a
+ *  multiple of 8 bytes and an index of 64 bit offsets: rows + 1 row starts counted in fields,
+ *  then the end of every field counted in bytes from the start of the data. Numbers are in
+ *  native byte order, a file written on a machine of the other byte order is rejected. If
+ *  the csv had a header it is stored as the first row.
+ */
+struct SnapshotHeader {
+  static constexpr char snapshot_magic[8]{'C', 'S', 'V', 'I', 'O', 'S', 'N', 'P'};
+  static constexpr std::uint32_t snapshot_version = 1;
+  static constexpr std::uint32_t snapshot_byte_order = 0x01020304;
+  static constexpr std::uint64_t has_header_flag = 1;
+
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t byte_order;
+  std::uint64_t flags;
+  std::uint64_t rows;
+  std::uint64_t fields;
+  std::uint64_t data_size;
+  std::uint64_t index_offset;
+};
+
+/** \brief read a 64 bit number from a possibly unaligned position
+ *  \ingroup snapshot
+ */
+inline std::uint64_t load_u64(const char* pos) {
+  std::uint64_t value{0};
+  std::memcpy(&value, pos, sizeof(value));
+  return value;
+}
+
+/** \class SnapshotRow
+ *  \ingroup snapshot
+ *  \brief A row of a snapshot, its fields are views into the mapped file
+ */
+class SnapshotRow {
+public:
+  using value_type = string_view;
+  using size_type = std::size_t;
+
+  /** \class const_iterator
+   *  \brief iterates the fields of a SnapshotRow as string_view
+   */
+  struct const_iterator {
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = string_view;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const string_view*;
+    using reference = string_view;
+
+    string_view operator*() const { return (*m_row)[m_index]; }
+    const_iterator& operator++() {
+      ++m_index;
+      return *this;
+    }
+    bool operator==(const const_iterator& other) const { return m_index == other.m_index; }
+    bool operator!=(const const_iterator& other) const { return m_index != other.m_index; }
+
+    const SnapshotRow* m_row;
+    size_type m_index;
+  };
+
+  SnapshotRow() = default;
+
+  /** \brief construct a row over the data and field ends of a snapshot
+   *  \param data start of the field bytes
+   *  \param ends start of the field end offsets of the whole snapshot
+   *  \param first index of the first field of the row
+   *  \param count number of fields in the row
+   */
+  SnapshotRow(const char* data, const char* ends, size_type first, size_type count)
+      : m_data(data), m_ends(ends), m_first(first), m_count(count) {}
+
+  /** \brief number of fields */
+  [[nodiscard]] size_type size() const { return m_count; }
+
+  /** \brief check whether the row has no fields */
+  [[nodiscard]] bool empty() const { return m_count == 0; }
+
+  /** \brief get the value of a field
+   *  \param index field index, must be less than size()
+   *  \return view valid as long as the snapshot is open
+   */
+  string_view operator[](size_type index) const {
+    const size_type field = m_first + index;
+    const auto start = field == 0 ? 0 : load_u64(m_ends + (field - 1) * sizeof(std::uint64_t));
+    const auto end = load_u64(m_ends + field * sizeof(std::uint64_t));
+    return string_view(m_data + start, static_cast<size_type>(end - start));
+  }
+
+  /** \brief get the value of a field with bounds checking
+   *  \param index field index
+   *  \return view valid as long as the snapshot is open
+   */
+  string_view at(size_type index) const {
+    if (index >= m_count) { throw std::out_of_range("SnapshotRow::at index out of range"); }
+    return (*this)[index];
+  }
+
+  const_iterator begin() const { return {this, 0}; }
+  const_iterator end() const { return {this, m_count}; }
+
+  /** \brief copy all fields into a vector
+   *  \return vector of fields
+   */
+  [[nodiscard]] std::vector<std::string> to_vector() const {
+    std::vector<std::string> result;
+    result.reserve(size());
+    for (const auto field : *this) { result.emplace_back(field); }
+    return result;
+  }
+
+private:
+  const char* m_data{nullptr};
+  const char* m_ends{nullptr};
+  size_type m_first{0};
+  size_type m_count{0};
+};
+
+}  // namespace util
+
+/** \class CSVSnapshotWriter
+ *  \ingroup snapshot
+ *  \brief Writes split and unescaped csv rows to a snapshot file read by CSVSnapshotReader
+ *
+ *  Field bytes are streamed to the file as rows are written, the index is kept in memory
+ *  and appended by close().
+ */
+class CSVSnapshotWriter {
+public:
+  /** \brief create or truncate a snapshot file
+   *  \param path file to write to
+   */
+  explicit CSVSnapshotWriter(const std::string& path)
+      : m_file(path, std::ios::binary | std::ios::trunc) {
+    util::SnapshotHeader header{};
+    m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    m_row_starts.push_back(0);
+    m_buffer.reserve(buffer_size);
+  }
+
+  CSVSnapshotWriter(const CSVSnapshotWriter&) = delete;
+  CSVSnapshotWriter& operator=(const CSVSnapshotWriter&) = delete;
+
+  ~CSVSnapshotWriter() { close(); }
+
+  /** \brief write the csv header, must come before any row
+   *  \param header range of names convertible to string_view
+   */
+  template <typename Row, typename = std::enable_if_t<util::is_string_row<Row>::value>>
+  void write_header(const Row& header) {
+    if (m_row_starts.size() != 1) { return; }
+    write(header);
+    m_lines_written--;
+    m_flags |= util::SnapshotHeader::has_header_flag;
+  }
+
+  /** \brief write a row of unescaped fields
+   *  \param values range of values convertible to string_view, e.g. a LazyRow
+   */
+  template <typename Row, typename = std::enable_if_t<util::is_string_row<Row>::value>>
+  void write(const Row& values) {
+    for (const auto& value : values) {
+      const string_view field(value);
+      if (m_buffer.size() + field.size() > buffer_size) { flush(); }
+      m_buffer.append(field.data(), field.size());
+      m_data_size += field.size();
+      m_field_ends.push_back(m_data_size);
+    }
+    m_row_starts.push_back(m_field_ends.size());
+    m_lines_written++;
+  }
+
+  /** \brief write the index and finish the file, called by the destructor
+   *  \return true if the whole snapshot was written
+   */
+  bool close() {
+    if (m_closed) { return m_good; }
+    m_closed = true;
+
+    m_buffer.append((8 - m_data_size % 8) % 8, '\0');
+    flush();
+    const std::uint64_t index_offset = sizeof(util::SnapshotHeader) + m_data_size +
+                                       (8 - m_data_size % 8) % 8;
+    m_file.write(reinterpret_cast<const char*>(m_row_starts.data()),
+                 static_cast<std::streamsize>(m_row_starts.size() * sizeof(std::uint64_t)));
+    m_file.write(reinterpret_cast<const char*>(m_field_ends.data()),
+                 static_cast<std::streamsize>(m_field_ends.size() * sizeof(std::uint64_t)));
+
+    util::SnapshotHeader header{};
+    std::memcpy(header.magic, util::SnapshotHeader::snapshot_magic, sizeof(header.magic));
+    header.version = util::SnapshotHeader::snapshot_version;
+    header.byte_order = util::SnapshotHeader::snapshot_byte_order;
+    header.flags = m_flags;
+    header.rows = m_row_starts.size() - 1;
+    header.fields = m_field_ends.size();
+    header.data_size = m_data_size;
+    header.index_offset = index_offset;
+    m_file.seekp(0);
+    m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    m_file.close();
+    m_good = !m_file.fail();
+    return m_good;
+  }
+
+  /** \brief check if the file is still good
+   *  \return true if good, otherwise false
+   */
+  bool good() { return m_closed ? m_good : m_file.good(); }
+
+  /** \brief Get number of rows written so far, not counting the header
+   *  \return number of rows written so far
+   */
+  [[nodiscard]] std::size_t lcount() const { return m_lines_written; }
+
+private:
+  static constexpr std::size_t buffer_size = std::size_t{1} << 20;
+
+  void flush() {
+    m_file.write(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+    m_buffer.clear();
+  }
+
+  std::ofstream m_file;
+  std::string m_buffer;
+  std::vector<std::uint64_t> m_row_starts;
+  std::vector<std::uint64_t> m_field_ends;
+  std::uint64_t m_data_size{0};
+  std::uint64_t m_flags{0};
+  std::size_t m_lines_written{0};
+  bool m_closed{false};
+  bool m_good{false};
+};
+
+/** \brief parse a csv once and store it as a snapshot
+ *  \ingroup snapshot
+ *  \param line_reader reference to a LineReader of the csv
+ *  \param path snapshot file to write
+ *  \param delimiter csv delimiter
+ *  \param has_header the csv starts with a header
+ *  \return true if the whole snapshot was written
+ */
+template <typename LineReader>
+bool write_snapshot(LineReader& line_reader, const std::string& path, const char delimiter = ',',
+                    bool has_header = true) {
+  CSVReader<util::LazyRow, LineReader, util::DelimSplitLazy<util::LazyRow>> reader(
+      line_reader, delimiter, has_header);
+  CSVSnapshotWriter writer(path);
+  if (has_header) { writer.write_header(reader.get_header_names()); }
+  while (reader.good()) {
+    const auto& row = reader.read();
+    if (util::is_blank_row(row)) { continue; }
+    writer.write(row);
+  }
+  return writer.close();
+}
+
+/** \class CSVSnapshotReader
+ *  \ingroup snapshot
+ *  \brief Reads the rows of a snapshot without parsing, through the interface of a CSVReader
+ *
+ *  The file is memory mapped where available and read into memory otherwise. Rows are only
+ *  views into it, so opening takes constant time and rows can also be accessed at random.
+ *  Like std::ifstream, a missing file is not an error by itself, a missing, truncated or
+ *  foreign snapshot simply has no rows and is_open() returns false, which lets callers fall
+ *  back to parsing the csv and rewriting the snapshot. Only the size of the index is checked
+ *  on open, its offsets are trusted.
+ */
+class CSVSnapshotReader {
+public:
+  /** \brief open a snapshot
+   *  \param path snapshot file written by CSVSnapshotWriter
+   */
+  explicit CSVSnapshotReader(const std::string& path)
+#if defined(__unix__) || defined(__APPLE__)
+      // rows are read in order and at random, so keep the default read ahead
+      : m_source(path, MADV_NORMAL) {
+    if (m_source.is_open()) { m_file = m_source.next_view(); }
+#else
+  {
+    std::ifstream file(path, std::ios::binary);
+    m_buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    m_file = m_buffer;
+#endif
+    m_open = validate();
+    if (!m_open) { return; }
+    if (m_header.flags & util::SnapshotHeader::has_header_flag) {
+      m_header_names = row(0);
+      m_next = 1;
+    }
+  }
+
+  CSVSnapshotReader(const CSVSnapshotReader&) = delete;
+  CSVSnapshotReader& operator=(const CSVSnapshotReader&) = delete;
+
+  /** \brief check whether a valid snapshot was opened
+   *  \return true if open, otherwise false
+   */
+  [[nodiscard]] bool is_open() const { return m_open; }
+
+  /** \brief check if there are rows left to read
+   *  \return true if good, otherwise false
+   */
+  bool good() { return m_next < m_rows; }
+
+  /** \brief Return the header names, empty if the csv had no header
+   *  \return a reference to the header row
+   */
+  const util::SnapshotRow& get_header_names() { return m_header_names; }
+
+  /** \brief Return the row returned by the last read()
+   *  \return a reference to the current row
+   */
+  const util::SnapshotRow& current() { return m_current; }
+
+  /** \brief Advance to the next row and return it
+   *  \return a reference to the current row
+   */
+  const util::SnapshotRow& read() {
+    if (good()) { m_current = row(m_next++); }
+    return m_current;
+  }
+
+  /** \brief Get number of rows read so far
+   *  \return number of rows read so far
+   */
+  [[nodiscard]] std::size_t lcount() const {
+    return m_next - ((m_header.flags & util::SnapshotHeader::has_header_flag) ? 1 : 0);
+  }
+
+  /** \brief number of rows in the snapshot, the header included */
+  [[nodiscard]] std::size_t rows() const { return m_rows; }
+
+  /** \brief access any row of the snapshot
+   *  \param index row position, the header is row 0 if there is one
+   *  \return row of views into the snapshot
+   */
+  [[nodiscard]] util::SnapshotRow row(std::size_t index) const {
+    const auto first = util::load_u64(m_row_starts + index * sizeof(std::uint64_t));
+    const auto last = util::load_u64(m_row_starts + (index + 1) * sizeof(std::uint64_t));
+    return {m_data, m_field_ends, static_cast<std::size_t>(first),
+            static_cast<std::size_t>(last - first)};
+  }
+
+private:
+  bool validate() {
+    if (m_file.size() < sizeof(util::SnapshotHeader)) { return false; }
+    std::memcpy(&m_header, m_file.data(), sizeof(m_header));
+    if (std::memcmp(m_header.magic, util::SnapshotHeader::snapshot_magic,
+                    sizeof(m_header.magic)) != 0 ||
+        m_header.version != util::SnapshotHeader::snapshot_version ||
+        m_header.byte_order != util::SnapshotHeader::snapshot_byte_order) {
+      return false;
+    }
+    const std::uint64_t size = m_file.size();
+    const std::uint64_t data_end = sizeof(util::SnapshotHeader) + m_header.data_size;
+    if (m_header.data_size > size || data_end > m_header.index_offset ||
+        m_header.rows >= size / sizeof(std::uint64_t) ||
+        m_header.fields >= size / sizeof(std::uint64_t) ||
+        m_header.index_offset > size ||
+        (m_header.rows + 1 + m_header.fields) * sizeof(std::uint64_t) >
+            size - m_header.index_offset) {
+      return false;
+    }
+
+    m_data = m_file.data() + sizeof(util::SnapshotHeader);
+    m_row_starts = m_file.data() + m_header.index_offset;
+    m_field_ends = m_row_starts + (m_header.rows + 1) * sizeof(std::uint64_t);
+    m_rows = static_cast<std::size_t>(m_header.rows);
+    return util::load_u64(m_row_starts + m_header.rows * sizeof(std::uint64_t)) ==
+               m_header.fields &&
+           (m_header.fields == 0 ||
+            util::load_u64(m_field_ends + (m_header.fields - 1) * sizeof(std::uint64_t)) ==
+                m_header.data_size);
+  }
+
+#if defined(__unix__) || defined(__APPLE__)
+  util::MMapByteSource m_source;
+#else
+  std::string m_buffer;
+#endif
+  string_view m_file{};
+  util::SnapshotHeader m_header{};
+  const char* m_data{nullptr};
+  const char* m_row_starts{nullptr};
+  const char* m_field_ends{nullptr};
+  std::size_t m_rows{0};
+  std::size_t m_next{0};
+  bool m_open{false};
+
+  util::SnapshotRow m_header_names;
+  util::SnapshotRow m_current;
+};
+
+}  // namespace csvio
+
+#endif  // MGUID_CSV_IO_SNAPSHOT_HPP
@@ -0,0 +1,603 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Matthew Guidry
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef MGUID_CSV_IO_SORT_HPP
+#define MGUID_CSV_IO_SORT_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "csvio/csvio.hpp"
+
+namespace csvio {
+
+/** \brief how the values of a key column are compared
+ *  \ingroup sort
+ *
+ *  STRING compares the unescaped bytes. NUMERIC compares fields as doubles, empty or invalid
+ *  fields order before every number. DATE compares YYYY-MM-DD dates as written and reorders
+ *  MM/DD/YYYY dates to YYYY-MM-DD first, anything after the date is compared as a string.
+ */
+enum KeyType { STRING, NUMERIC, DATE };
+
+/** \struct SortKey
+ *  \ingroup sort
+ *  \brief A column to sort by
+ */
+struct SortKey {
+  std::size_t index;
+  KeyType type{STRING};
+  bool descending{false};
+};
+
+/** \internal */
+namespace util {
+
+/** \brief default memory a CSVSorter may fill with rows before it spills a sorted run
+ *  \ingroup sort
+ */
+inline constexpr std::size_t default_sort_memory = std::size_t{256} << 20;
+
+/** \brief default number of runs a CSVSorter merges at once
+ *  \ingroup sort
+ */
+inline constexpr std::size_t default_merge_fan_in = 64;
+
+/** \brief append a date to a buffer as YYYY-MM-DD, reordering MM/DD/YYYY dates
+ *  \ingroup sort
+ *  \param out buffer to append to
+ *  \param field date as written in the csv
+ */
+inline void append_sortable_date(std::string& out, string_view field) {
+  const std::size_t first = field.find('/');
+  const std::size_t second = first == string_view::npos ? first : field.find('/', first + 1);
+  if (second == string_view::npos) {
+    out.append(field.data(), field.size());
+    return;
+  }
+
+  std::size_t year_end = second + 1;
+  while (year_end < field.size() && field[year_end] >= '0' && field[year_end] <= '9') {
+    year_end++;
+  }
+  const auto append_padded = [&out](string_view part, std::size_t width) {
+    for (std::size_t i = part.size(); i < width; i++) { out.push_back('0'); }
+    out.append(part.data(), part.size());
+  };
+  append_padded(field.substr(second + 1, year_end - second - 1), 4);
+  out.push_back('-');
+  append_padded(field.substr(0, first), 2);
+  out.push_back('-');
+  append_padded(field.substr(first + 1, second - first - 1), 2);
+  out.append(field.data() + year_end, field.size() - year_end);
+}
+
+/** \brief append the keys of a row to a buffer as bytes which compare like the keys
+ *  \ingroup sort
+ *
+ *  Two rows order like the byte wise comparison of their encoded keys, so sorting never
+ *  looks at key types again. Text is written with zero bytes escaped and a two byte
+ *  terminator, numbers as a validity byte followed by the big endian bits of the double with
+ *  the sign flipped. Descending keys have every byte inverted.
+ *
+ *  \param out buffer to append to
+ *  \param row split row, missing fields are treated as empty
+ *  \param keys key columns
+ */
+inline void append_sort_key(std::string& out, const LazyRow<std::string>& row,
+                            const std::vector<SortKey>& keys) {
+  for (const auto& key : keys) {
+    const std::size_t start = out.size();
+    const string_view field = key.index < row.size() ? row[key.index] : string_view{};
+    if (key.type == NUMERIC) {
+      double number{0.0};
+      if (field.empty() || !parse_field(field, number) || number != number) {
+        out.push_back('\0');
+      } else {
+        std::uint64_t bits{0};
+        number = number == 0.0 ? 0.0 : number;
+        std::memcpy(&bits, &number, sizeof(bits));
+        bits = (bits >> 63) != 0 ? ~bits : bits | (std::uint64_t{1} << 63);
+        out.push_back('\1');
+        for (int shift = 56; shift >= 0; shift -= 8) {
+          out.push_back(static_cast<char>((bits >> shift) & 0xff));
+        }
+      }
+    } else {
+      std::string date;
+      if (key.type == DATE) { append_sortable_date(date, field); }
+      for (const char c : key.type == DATE ? string_view(date) : field) {
+        out.push_back(c);
+        if (c == '\0') { out.push_back('\xff'); }
+      }
+      out.append(2, '\0');
+    }
+    if (key.descending) {
+      for (std::size_t i = start; i < out.size(); i++) { out[i] = static_cast<char>(~out[i]); }
+    }
+  }
+}
+
+/** \brief load up to 8 bytes of an encoded key as a big endian integer, zero padded
+ *  \ingroup sort
+ *  \param key encoded key
+ *  \param offset first byte to load
+ *  \return integer ordering like the loaded bytes
+ */
+inline std::uint64_t key_prefix(string_view key, std::size_t offset) {
+  std::uint64_t prefix{0};
+  for (std::size_t i = offset; i < offset + sizeof(prefix); i++) {
+    prefix = (prefix << 8) | (i < key.size() ? static_cast<unsigned char>(key[i]) : 0u);
+  }
+  return prefix;
+}
+
+/** \brief get the whole raw line a LazyRow was split from, without its line terminator
+ *  \ingroup sort
+ *  \param row split row with at least one field
+ *  \return view into the row
+ */
+inline string_view raw_line(const LazyRow<std::string>& row) {
+  const string_view first = row.raw(0);
+  const string_view last = row.raw(row.size() - 1);
+  return string_view(first.data(), static_cast<std::size_t>(last.data() + last.size() -
+                                                            first.data()));
+}
+
+/** \class LoserTree
+ *  \ingroup sort
+ *  \brief Tournament tree selecting the smallest of k sources with log2(k) comparisons
+ *
+ *  Every inner node keeps the loser of the match played there, so after the winning source
+ *  advances only the matches on its path to the root are replayed. Less compares two source
+ *  indexes and must order exhausted sources last.
+ */
+template <typename Less>
+class LoserTree {
+public:
+  /** \brief build the tree over sources 0 to count - 1
+   *  \param count number of sources, at least 1
+   *  \param less strict ordering of two source indexes
+   */
+  LoserTree(std::size_t count, Less less) : m_count(count), m_nodes(count), m_less(less) {
+    std::vector<std::size_t> winners(count * 2);
+    for (std::size_t i = 0; i < count; i++) { winners[count + i] = i; }
+    for (std::size_t node = count - 1; node > 0; node--) {
+      const std::size_t left = winners[node * 2];
+      const std::size_t right = winners[node * 2 + 1];
+      const bool right_wins = m_less(right, left);
+      winners[node] = right_wins ? right : left;
+      m_nodes[node] = right_wins ? left : right;
+    }
+    m_nodes[0] = winners[1];
+  }
+
+  /** \brief get the source holding the smallest value
+   *  \return source index
+   */
+  [[nodiscard]] std::size_t top() const { return m_nodes[0]; }
+
+  /** \brief restore the order after the value of the top source changed */
+  void replay() {
+    std::size_t winner = m_nodes[0];
+    for (std::size_t node = (winner + m_count) / 2; node > 0; node /= 2) {
+      if (m_less(m_nodes[node], winner)) { std::swap(m_nodes[node], winner); }
+    }
+    m_nodes[0] = winner;
+  }
+
+private:
+  std::size_t m_count;
+  std::vector<std::size_t> m_nodes;
+  Less m_less;
+};
+
+}  // namespace util
+
+/** \class CSVSorter
+ *  \ingroup sort
+ *  \brief External merge sort of a csv by key columns with bounded memory
+ *
+ *  Rows are read with util::DelimSplitLazy, so quoted fields spanning several lines stay
+ *  intact, and are kept as raw escaped lines together with their encoded keys. Once the rows
+ *  use the memory limit they are sorted on several threads and spilled to a temporary file
+ *  as a run. The runs are merged with a util::LoserTree, at most the merge fan in at once:
+ *  whenever that many runs of the same generation pile up they are merged into one run of
+ *  the next generation, and passes merge the remaining runs down to the fan in before the
+ *  final merge, so the number of open temporary files grows only logarithmically with the
+ *  input. If everything fits the rows are written straight from memory.
+ *
+ *  The sort is stable, the header is written first and blank lines are dropped. Without any
+ *  add_key() call the first column is compared as a string.
+ */
+template <typename LineReader = csvio::util::CSVLineReader,
+          typename LineWriter = csvio::util::CSVLineWriter>
+class CSVSorter {
+public:
+  /** \brief construct a CSVSorter, reads the header if there is one
+   *  \param line_reader reference to a LineReader of the input
+   *  \param line_writer reference to a LineWriter of the output
+   *  \param delimiter input and output delimiter
+   *  \param has_header the input starts with a header, which is written to the output first
+   *  \param warn_columns warn about mismatched or unknown columns
+   *  \param line_terminator sequence that denotes the end of an output row
+   */
+  explicit CSVSorter(LineReader& line_reader, LineWriter& line_writer, const char delimiter = ',',
+                     bool has_header = true, bool warn_columns = true,
+                     std::string line_terminator = "\r\n")
+      : m_csv_reader(line_reader, delimiter, has_header, warn_columns),
+        m_has_header(has_header), m_warn_columns(warn_columns),
+        m_line_terminator(std::move(line_terminator)), m_csv_line_writer(line_writer) {}
+
+  /** \brief sort by a column found by its header name, after the keys added before
+   *  \param name header name of the column
+   *  \param type how values are compared
+   *  \param descending sort from largest to smallest
+   */
+  void add_key(const std::string& name, KeyType type = STRING, bool descending = false) {
+    add_key(util::find_column(m_csv_reader.get_header_names(), name, m_warn_columns), type,
+            descending);
+  }
+
+  /** \brief sort by a column found by its position, after the keys added before
+   *  \param index position of the column, missing fields compare as empty
+   *  \param type how values are compared
+   *  \param descending sort from largest to smallest
+   */
+  void add_key(std::size_t index, KeyType type = STRING, bool descending = false) {
+    m_keys.push_back({index, type, descending});
+  }
+
+  /** \brief set how many bytes of rows and keys are held before a run is spilled
+   *  \param bytes memory limit
+   */
+  void set_memory_limit(std::size_t bytes) { m_memory_limit = bytes; }
+
+  /** \brief get the memory limit
+   *  \return memory limit in bytes
+   */
+  [[nodiscard]] std::size_t get_memory_limit() const { return m_memory_limit; }
+
+  /** \brief set how many runs are merged at once, which bounds the open temporary files
+   *  \param runs merge fan in, at least 2
+   */
+  void set_merge_fan_in(std::size_t runs) { m_merge_fan_in = std::max<std::size_t>(2, runs); }
+
+  /** \brief get the merge fan in
+   *  \return number of runs merged at once
+   */
+  [[nodiscard]] std::size_t get_merge_fan_in() const { return m_merge_fan_in; }
+
+  /** \brief set the number of threads sorting a run
+   *  \param threads number of threads, 0 uses the hardware concurrency
+   */
+  void set_threads(unsigned threads) { m_threads = threads; }
+
+  /** \brief sort every remaining row of the input and write it
+   *  \return number of rows written, not counting the header
+   */
+  std::size_t run() {
+    if (m_keys.empty()) { add_key(std::size_t{0}); }
+    m_runs.clear();
+    m_run_generations.clear();
+    m_spilled_runs = 0;
+    if (m_threads == 0) { m_threads = std::max(1u, std::thread::hardware_concurrency()); }
+
+    if (m_has_header) {
+      const auto& header = m_csv_reader.get_header_names();
+      if (!header.empty() && !util::raw_line(header).empty()) { emit(util::raw_line(header)); }
+    }
+
+    std::size_t rows{0};
+    while (m_csv_reader.good()) {
+      const auto& row = m_csv_reader.read();
+      if (util::is_blank_row(row)) { continue; }
+      add_record(row);
+      rows++;
+      if (memory_used() >= m_memory_limit) { spill_run(); }
+    }
+
+    sort_records();
+    if (m_runs.empty()) {
+      for (const auto& record : m_records) {
+        emit(string_view(m_arena).substr(record.offset + record.key_size, record.line_size));
+      }
+    } else {
+      spill_run();
+      while (m_runs.size() > m_merge_fan_in) {
+        for (std::size_t first = 0; first < m_runs.size(); first++) {
+          merge_into_run(first, std::min(m_merge_fan_in, m_runs.size() - first));
+        }
+      }
+      merge_runs(0, m_runs.size(), [this](const RunCursor& cursor) { emit(cursor.line); });
+    }
+    clear_records();
+    flush();
+    return rows;
+  }
+
+  /** \brief get the number of runs spilled to temporary files by the last run()
+   *  \return number of runs
+   */
+  [[nodiscard]] std::size_t spilled_runs() const { return m_spilled_runs; }
+
+  /** \brief Get number of csv lines written so far
+   *  \return number of csv lines written so far
+   */
+  [[nodiscard]] std::size_t lcount() const { return m_csv_line_writer.lcount(); }
+
+protected:
+  /** \brief a buffered row, its encoded key followed by its raw line in the arena */
+  struct Record {
+    std::uint64_t prefix[2];
+    std::size_t offset;
+    std::uint32_t key_size;
+    std::uint32_t line_size;
+  };
+
+  struct FileCloser {
+    void operator()(std::FILE* file) const { std::fclose(file); }
+  };
+
+  using RunFile = std::unique_ptr<std::FILE, FileCloser>;
+
+  /** \brief a spilled run being merged, holds its current row and keys */
+  struct RunCursor {
+    std::FILE* file;
+    std::string key;
+    std::string line;
+    bool done{false};
+  };
+
+  void add_record(const util::LazyRow<std::string>& row) {
+    const std::size_t offset = m_arena.size();
+    util::append_sort_key(m_arena, row, m_keys);
+    const string_view key = string_view(m_arena).substr(offset);
+    const string_view line = util::raw_line(row);
+    m_records.push_back({{util::key_prefix(key, 0), util::key_prefix(key, 8)},
+                         offset,
+                         static_cast<std::uint32_t>(key.size()),
+                         static_cast<std::uint32_t>(line.size())});
+    m_arena.append(line.data(), line.size());
+  }
+
+  [[nodiscard]] std::size_t memory_used() const {
+    return m_arena.size() + m_records.size() * sizeof(Record);
+  }
+
+  void clear_records() {
+    m_arena.clear();
+    m_records.clear();
+  }
+
+  /** \brief stable sort of the buffered records, slices are sorted and merged on m_threads */
+  void sort_records() {
+    // most comparisons are decided by the first 16 key bytes kept in the record
+    const auto less = [this](const Record& a, const Record& b) {
+      if (a.prefix[0] != b.prefix[0]) { return a.prefix[0] < b.prefix[0]; }
+      if (a.prefix[1] != b.prefix[1]) { return a.prefix[1] < b.prefix[1]; }
+      return string_view(m_arena).substr(a.offset, a.key_size) <
+             string_view(m_arena).substr(b.offset, b.key_size);
+    };
+
+    const std::size_t count = m_records.size();
+    const std::size_t slices =
+        std::min<std::size_t>(m_threads, std::max<std::size_t>(1, count / 16384));
+    if (slices < 2) {
+      std::stable_sort(m_records.begin(), m_records.end(), less);
+      return;
+    }
+
+    const auto bound = [&](std::size_t slice) {
+      return m_records.begin() + static_cast<std::ptrdiff_t>(slice * count / slices);
+    };
+    std::vector<std::thread> workers;
+    for (std::size_t i = 0; i < slices; i++) {
+      workers.emplace_back([&, i] { std::stable_sort(bound(i), bound(i + 1), less); });
+    }
+    for (auto& worker : workers) { worker.join(); }
+
+    for (std::size_t width = 1; width < slices; width *= 2) {
+      workers.clear();
+      for (std::size_t i = 0; i + width < slices; i += width * 2) {
+        workers.emplace_back([&, i, width] {
+          std::inplace_merge(bound(i), bound(i + width), bound(std::min(slices, i + width * 2)),
+                             less);
+        });
+      }
+      for (auto& worker : workers) { worker.join(); }
+    }
+  }
+
+  /** \brief sort the buffered records and write them to a temporary file, every record as
+   *  its key size, line size, encoded key and raw line
+   */
+  void spill_run() {
+    if (m_records.empty()) { return; }
+    sort_records();
+
+    RunFile file = create_run();
+    std::string buffer;
+    const string_view arena(m_arena);
+    for (const auto& record : m_records) {
+      append_run_record(buffer, arena.substr(record.offset, record.key_size),
+                        arena.substr(record.offset + record.key_size, record.line_size));
+      if (buffer.size() >= util::default_chunk_size) { write_run(file.get(), buffer); }
+    }
+    write_run(file.get(), buffer);
+    std::rewind(file.get());
+
+    m_runs.push_back(std::move(file));
+    m_run_generations.push_back(0);
+    m_spilled_runs++;
+    clear_records();
+
+    // runs are ordered oldest first and generations never increase along m_runs, so the
+    // last fan in runs share a generation exactly when the first of them has the last one's
+    while (m_runs.size() >= m_merge_fan_in &&
+           m_run_generations[m_runs.size() - m_merge_fan_in] == m_run_generations.back()) {
+      merge_into_run(m_runs.size() - m_merge_fan_in, m_merge_fan_in);
+    }
+  }
+
+  static RunFile create_run() {
+    RunFile file(std::tmpfile());
+    if (!file) { throw std::runtime_error("CSVSorter could not create a temporary file"); }
+    return file;
+  }
+
+  static void append_run_record(std::string& buffer, string_view key, string_view line) {
+    const auto key_size = static_cast<std::uint32_t>(key.size());
+    const auto line_size = static_cast<std::uint32_t>(line.size());
+    buffer.append(reinterpret_cast<const char*>(&key_size), sizeof(key_size));
+    buffer.append(reinterpret_cast<const char*>(&line_size), sizeof(line_size));
+    buffer.append(key.data(), key.size());
+    buffer.append(line.data(), line.size());
+  }
+
+  /** \brief merge count runs starting at first into one run of the next generation, which
+   *  takes their place
+   */
+  void merge_into_run(std::size_t first, std::size_t count) {
+    if (count < 2) { return; }
+    RunFile file = create_run();
+    std::string buffer;
+    merge_runs(first, count, [&](const RunCursor& cursor) {
+      append_run_record(buffer, cursor.key, cursor.line);
+      if (buffer.size() >= util::default_chunk_size) { write_run(file.get(), buffer); }
+    });
+    write_run(file.get(), buffer);
+    std::rewind(file.get());
+
+    const auto begin = static_cast<std::ptrdiff_t>(first);
+    const auto end = static_cast<std::ptrdiff_t>(first + count);
+    const std::size_t generation =
+        *std::max_element(m_run_generations.begin() + begin, m_run_generations.begin() + end) +
+        1;
+    m_runs.erase(m_runs.begin() + begin + 1, m_runs.begin() + end);
+    m_run_generations.erase(m_run_generations.begin() + begin + 1,
+                            m_run_generations.begin() + end);
+    m_runs[first] = std::move(file);
+    m_run_generations[first] = generation;
+  }
+
+  static void write_run(std::FILE* file, std::string& buffer) {
+    if (std::fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size()) {
+      throw std::runtime_error("CSVSorter could not write a temporary file");
+    }
+    buffer.clear();
+  }
+
+  static void next_row(RunCursor& cursor) {
+    std::uint32_t sizes[2]{};
+    if (std::fread(sizes, sizeof(sizes[0]), 2, cursor.file) != 2) {
+      cursor.done = true;
+      return;
+    }
+    cursor.key.resize(sizes[0]);
+    cursor.line.resize(sizes[1]);
+    if (std::fread(cursor.key.data(), 1, sizes[0], cursor.file) != sizes[0] ||
+        std::fread(cursor.line.data(), 1, sizes[1], cursor.file) != sizes[1]) {
+      throw std::runtime_error("CSVSorter could not read a temporary file");
+    }
+  }
+
+  /** \brief k-way merge of count runs starting at first, passing each row to output */
+  template <typename Output>
+  void merge_runs(std::size_t first, std::size_t count, Output output) {
+    std::vector<RunCursor> cursors(count);
+    for (std::size_t i = 0; i < count; i++) {
+      cursors[i].file = m_runs[first + i].get();
+      next_row(cursors[i]);
+    }
+
+    // equal keys are taken from the earlier run, which keeps the sort stable
+    const auto less = [&](std::size_t a, std::size_t b) {
+      if (cursors[a].done || cursors[b].done) { return !cursors[a].done && cursors[b].done; }
+      const int result = cursors[a].key.compare(cursors[b].key);
+      return result < 0 || (result == 0 && a < b);
+    };
+
+    util::LoserTree<decltype(less)> tree(cursors.size(), less);
+    while (!cursors[tree.top()].done) {
+      RunCursor& cursor = cursors[tree.top()];
+      output(cursor);
+      next_row(cursor);
+      tree.replay();
+    }
+  }
+
+  void emit(string_view line) {
+    m_out.append(line.data(), line.size());
+    m_out.append(m_line_terminator);
+    m_pending++;
+    if (m_out.size() >= util::default_chunk_size || !util::has_writelines<LineWriter>::value) {
+      flush();
+    }
+  }
+
+  void flush() {
+    if (m_pending == 0) { return; }
+    if constexpr (util::has_writelines<LineWriter>::value) {
+      m_csv_line_writer.writelines(m_out, m_pending);
+    } else {
+      m_csv_line_writer.writeline(m_out);
+    }
+    m_out.clear();
+    m_pending = 0;
+  }
+
+  CSVReader<util::LazyRow, LineReader, util::DelimSplitLazy<util::LazyRow>> m_csv_reader;
+
+  bool m_has_header;
+  bool m_warn_columns;
+  std::string m_line_terminator;
+  std::vector<SortKey> m_keys;
+  std::size_t m_memory_limit{util::default_sort_memory};
+  unsigned m_threads{0};
+  std::size_t m_merge_fan_in{util::default_merge_fan_in};
+
+  std::string m_arena;
+  std::vector<Record> m_records;
+  std::vector<RunFile> m_runs;
+  std::vector<std::size_t> m_run_generations;
+  std::size_t m_spilled_runs{0};
+
+  std::string m_out;
+  std::size_t m_pending{0};
+
+  LineWriter& m_csv_line_writer;
+};
+
+}  // namespace csvio
+
+#endif  // MGUID_CSV_IO_SORT_HPP
@@ -0,0 +1,347 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Matthew Guidry
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef MGUID_CSV_IO_SPLIT_HPP
+#define MGUID_CSV_IO_SPLIT_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "csvio/csvio.hpp"
+#include "csvio/group_by.hpp"
+
+namespace csvio {
+
+/** \brief how a CSVSplitter picks the shard of a row
+ *  \ingroup split
+ *
+ *  HASH sends rows with equal unescaped key fields to the same shard, ROUND_ROBIN deals rows
+ *  out in turn and ROW_LIMIT fills a shard with a fixed number of rows before starting the
+ *  next one.
+ */
+enum SplitMode { HASH, ROUND_ROBIN, ROW_LIMIT };
+
+/** \class CSVSplitter
+ *  \ingroup split
+ *  \brief Routes the rows of a csv to several outputs, each starting with the input header
+ *
+ *  The calling thread reads raw lines in batches and worker threads route every line of a
+ *  batch into one buffer per shard. Buffers are handed to the LineWriters of the shards in
+ *  input order, so every shard keeps the order of its rows and the output does not depend on
+ *  the number of threads. Rows are copied as they appear in the input, only their line
+ *  terminator is replaced. The header of every shard is written through a CSVWriter when the
+ *  shard is created. Blank lines are skipped.
+ */
+template <typename LineReader = csvio::util::CSVLineReader,
+          typename LineWriter = csvio::util::CSVLineWriter>
+class CSVSplitter {
+public:
+  /** \brief creates the LineWriter of a shard, called once per shard with its number */
+  using WriterFactory = std::function<std::unique_ptr<LineWriter>(std::size_t)>;
+
+  /** \brief construct a CSVSplitter, reads the header if there is one
+   *  \param line_reader reference to a LineReader of the input
+   *  \param make_writer creates the LineWriter of a shard
+   *  \param mode how rows are routed to shards
+   *  \param count number of shards for HASH and ROUND_ROBIN, rows per shard for ROW_LIMIT
+   *  \param delimiter input and output delimiter
+   *  \param has_header the input starts with a header, which starts every shard
+   *  \param warn_columns warn about unknown columns
+   *  \param line_terminator sequence that denotes the end of an output row
+   */
+  explicit CSVSplitter(LineReader& line_reader, WriterFactory make_writer,
+                       SplitMode mode = HASH, std::size_t count = 2,
+                       const char delimiter = ',', bool has_header = true,
+                       bool warn_columns = true, std::string line_terminator = "\r\n")
+      : m_csv_line_reader(line_reader),
+        m_csv_reader(line_reader, delimiter, has_header, warn_columns),
+        m_make_writer(std::move(make_writer)), m_mode(mode),
+        m_count(std::max<std::size_t>(1, count)),
+        m_has_header(has_header), m_warn_columns(warn_columns),
+        m_line_terminator(std::move(line_terminator)) {}
+
+  /** \brief hash a column found by its header name, after the keys added before
+   *  \param name header name of the column
+   */
+  void add_key(const std::string& name) {
+    add_key(util::find_column(m_csv_reader.get_header_names(), name, m_warn_columns));
+  }
+
+  /** \brief hash a column found by its position, after the keys added before
+   *  \param index position of the column, missing fields are treated as empty
+   */
+  void add_key(std::size_t index) { m_keys.push_back(index); }
+
+  /** \brief set the number of threads routing rows
+   *  \param threads number of threads, 0 uses the hardware concurrency
+   */
+  void set_threads(unsigned threads) { m_threads = threads; }
+
+  /** \brief route every remaining row of the input to the shards
+   *
+   *  HASH and ROUND_ROBIN create all of their shards, even empty ones, ROW_LIMIT creates
+   *  shards as they are needed. Shards are always created on the calling thread. If the
+   *  WriterFactory, the LineReader or a LineWriter throws, the worker threads are stopped
+   *  and the first exception is rethrown.
+   *
+   *  \return number of rows written, not counting headers
+   */
+  std::size_t run() {
+    if (m_threads == 0) { m_threads = std::max(1u, std::thread::hardware_concurrency()); }
+    if (m_mode != ROW_LIMIT) {
+      for (std::size_t shard = 0; shard < m_count; shard++) { open_shard(shard); }
+    }
+
+    if (m_threads == 1) {
+      Router router;
+      while (m_csv_line_reader.good()) {
+        route(read_batch(0), router);
+        write(router.buffers);
+      }
+      return m_rows;
+    }
+
+    // mutex only guards the queue of batches, shard output is serialized by m_shard_mutex
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<Batch> batches;
+    bool finished{false};
+    std::exception_ptr failure;
+    std::atomic<bool> stop{false};
+    std::size_t next_batch{0};
+    std::condition_variable written;
+
+    const auto fail = [&](std::exception_ptr error) {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!failure) { failure = error; }
+        stop = true;
+      }
+      { std::lock_guard<std::mutex> lock(m_shard_mutex); }
+      changed.notify_all();
+      written.notify_all();
+    };
+
+    // routes a batch, then waits for the batches before it to be written
+    const auto route_batches = [&]() {
+      try {
+        Router router;
+        while (true) {
+          Batch batch;
+          {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [&] { return stop || !batches.empty() || finished; });
+            if (stop || batches.empty()) { return; }
+            batch = std::move(batches.front());
+            batches.pop_front();
+          }
+          changed.notify_all();
+
+          route(batch, router);
+          {
+            std::unique_lock<std::mutex> lock(m_shard_mutex);
+            written.wait(lock, [&] { return stop || next_batch == batch.sequence; });
+            if (stop) { return; }
+            write(router.buffers);
+            next_batch++;
+          }
+          written.notify_all();
+        }
+      } catch (...) {
+        fail(std::current_exception());
+      }
+    };
+
+    std::vector<std::thread> workers;
+    try {
+      for (unsigned i = 0; i < m_threads; i++) { workers.emplace_back(route_batches); }
+      for (std::size_t sequence = 0; m_csv_line_reader.good(); sequence++) {
+        Batch batch = read_batch(sequence);
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          changed.wait(lock, [&] { return stop || batches.size() < m_threads * 2; });
+          if (stop) { break; }
+          batches.push_back(std::move(batch));
+        }
+        changed.notify_all();
+      }
+    } catch (...) {
+      fail(std::current_exception());
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      finished = true;
+    }
+    changed.notify_all();
+    for (auto& worker : workers) { worker.join(); }
+    if (failure) { std::rethrow_exception(failure); }
+    return m_rows;
+  }
+
+  /** \brief Get number of shards created so far
+   *  \return number of shards
+   */
+  [[nodiscard]] std::size_t shards() const { return m_writers.size(); }
+
+  /** \brief access the LineWriter of a shard, e.g. to flush it
+   *  \param shard shard number, less than shards()
+   *  \return reference to the LineWriter
+   */
+  LineWriter& line_writer(std::size_t shard) { return *m_line_writers[shard]; }
+
+protected:
+  static constexpr std::size_t batch_lines = 4096;
+
+  struct Batch {
+    std::vector<std::string> lines;
+    std::uint64_t first_row;
+    std::size_t sequence;
+  };
+
+  struct ShardBuffer {
+    std::string data;
+    std::vector<std::size_t> ends;
+  };
+
+  /** \brief state of a thread routing batches */
+  struct Router {
+    util::DelimSplitLazy<util::LazyRow> parser;
+    std::string key;
+    std::vector<ShardBuffer> buffers;
+  };
+
+  /** \brief read the next lines of the input without their terminators, skipping blank lines
+   */
+  Batch read_batch(std::size_t sequence) {
+    Batch batch{{}, m_rows, sequence};
+    batch.lines.reserve(batch_lines);
+    while (batch.lines.size() < batch_lines && m_csv_line_reader.good()) {
+      std::string line = m_csv_line_reader.readline();
+      if (!line.empty() && line.back() == '\n') { line.pop_back(); }
+      if (!line.empty() && line.back() == '\r') { line.pop_back(); }
+      if (!line.empty()) { batch.lines.push_back(std::move(line)); }
+    }
+    m_rows += batch.lines.size();
+    if (m_mode == ROW_LIMIT) {
+      while (m_line_writers.size() * m_count < m_rows) { open_shard(m_line_writers.size()); }
+    }
+    return batch;
+  }
+
+  std::size_t shard_of(const std::string& line, std::uint64_t row_number,
+                       Router& router) const {
+    if (m_mode == ROUND_ROBIN) { return static_cast<std::size_t>(row_number % m_count); }
+    if (m_mode == ROW_LIMIT) { return static_cast<std::size_t>(row_number / m_count); }
+
+    std::string& key = router.key;
+    const auto& row = router.parser(line, m_csv_reader.get_delimiter());
+    key.clear();
+    for (const std::size_t index : m_keys) {
+      const string_view field = index < row.size() ? row[index] : string_view{};
+      const auto size = static_cast<std::uint32_t>(field.size());
+      key.append(reinterpret_cast<const char*>(&size), sizeof(size));
+      key.append(field.data(), field.size());
+    }
+    return static_cast<std::size_t>(util::hash_bytes(key) % m_count);
+  }
+
+  void route(const Batch& batch, Router& router) const {
+    std::vector<ShardBuffer>& buffers = router.buffers;
+    for (auto& buffer : buffers) {
+      buffer.data.clear();
+      buffer.ends.clear();
+    }
+    for (std::size_t i = 0; i < batch.lines.size(); i++) {
+      const std::size_t shard = shard_of(batch.lines[i], batch.first_row + i, router);
+      if (shard >= buffers.size()) { buffers.resize(shard + 1); }
+      buffers[shard].data.append(batch.lines[i]);
+      buffers[shard].data.append(m_line_terminator);
+      buffers[shard].ends.push_back(buffers[shard].data.size());
+    }
+  }
+
+  void write(const std::vector<ShardBuffer>& buffers) {
+    for (std::size_t shard = 0; shard < buffers.size(); shard++) {
+      const ShardBuffer& buffer = buffers[shard];
+      if (buffer.ends.empty()) { continue; }
+      LineWriter& line_writer = *m_line_writers[shard];
+      if constexpr (util::has_writelines<LineWriter>::value) {
+        line_writer.writelines(buffer.data, buffer.ends.size());
+      } else {
+        std::size_t start{0};
+        for (const std::size_t end : buffer.ends) {
+          line_writer.writeline(string_view(buffer.data).substr(start, end - start));
+          start = end;
+        }
+      }
+    }
+  }
+
+  /** \brief create the next shard, only called from the thread calling run() */
+  void open_shard(std::size_t shard) {
+    auto line_writer = m_make_writer(shard);
+    auto writer = std::make_unique<CSVWriter<std::vector, LineWriter>>(
+        *line_writer, m_csv_reader.get_delimiter(), m_warn_columns, m_line_terminator);
+    if (m_has_header) {
+      const auto& header = m_csv_reader.get_header_names();
+      writer->write_header(std::vector<std::string>(header.begin(), header.end()));
+    }
+    // workers index m_line_writers while they write
+    std::lock_guard<std::mutex> lock(m_shard_mutex);
+    m_line_writers.push_back(std::move(line_writer));
+    m_writers.push_back(std::move(writer));
+  }
+
+  LineReader& m_csv_line_reader;
+  CSVReader<util::LazyRow, LineReader, util::DelimSplitLazy<util::LazyRow>> m_csv_reader;
+
+  WriterFactory m_make_writer;
+  SplitMode m_mode;
+  std::size_t m_count;
+  bool m_has_header;
+  bool m_warn_columns;
+  std::string m_line_terminator;
+  unsigned m_threads{0};
+  std::size_t m_rows{0};
+  std::vector<std::size_t> m_keys;
+
+  std::mutex m_shard_mutex;
+  std::vector<std::unique_ptr<LineWriter>> m_line_writers;
+  std::vector<std::unique_ptr<CSVWriter<std::vector, LineWriter>>> m_writers;
+};
+
+}  // namespace csvio
+
+#endif  // MGUID_CSV_IO_SPLIT_HPP
@@ -0,0 +1,197 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Matthew Guidry
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "csvio/csvio.hpp"
+#include "gtest/gtest.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+/** ByteSource handing out a single byte per read, forces lines across block boundaries */
+class OneByteSource {
+public:
+  explicit OneByteSource(std::string data) : m_data(std::move(data)) {}
+
+  std::size_t read(char* dest, std::size_t count) {
+    if (count == 0 || m_pos == m_data.size()) { return 0; }
+    *dest = m_data[m_pos++];
+    return 1;
+  }
+
+private:
+  std::string m_data;
+  std::size_t m_pos{0};
+};
+
+template <typename LineReader>
+std::vector<std::string> read_all(LineReader& reader) {
+  std::vector<std::string> lines;
+  while (reader.good()) { lines.push_back(reader.readline()); }
+  return lines;
+}
+
+TEST(ByteSourceTest, MemoryByteSourceRead) {
+  std::string data{"abcdef"};
+  csvio::util::MemoryByteSource source(data);
+
+  char buf[4];
+  EXPECT_EQ(4u, source.read(buf, 4));
+  EXPECT_EQ("abcd", std::string(buf, 4));
+  EXPECT_EQ(2u, source.read(buf, 4));
+  EXPECT_EQ("ef", std::string(buf, 2));
+  EXPECT_EQ(0u, source.read(buf, 4));
+}
+
+TEST(ByteSourceTest, MemoryByteSourceNextView) {
+  std::string data{"abcdef"};
+  csvio::util::MemoryByteSource source(data);
+
+  EXPECT_EQ(true, csvio::util::has_next_view<csvio::util::MemoryByteSource>::value);
+  EXPECT_EQ(false, csvio::util::has_next_view<csvio::util::IStreamByteSource>::value);
+
+  auto view = source.next_view();
+  EXPECT_EQ(data.data(), view.data());
+  EXPECT_EQ("abcdef", view);
+  EXPECT_EQ(true, source.next_view().empty());
+}
+
+TEST(ByteSourceTest, LineReaderOverMemory) {
+  std::string data{"1,\"a\nb\",2\n3,4,5\n"};
+  csvio::util::BasicCSVLineReader<csvio::util::MemoryByteSource> csv_lr(data.data(), data.size());
+
+  EXPECT_EQ("1,\"a\nb\",2\n", csv_lr.readline());
+  EXPECT_EQ(true, csv_lr.good());
+  EXPECT_EQ("3,4,5\n", csv_lr.readline());
+  EXPECT_EQ(2u, csv_lr.lcount());
+  EXPECT_EQ(false, csv_lr.good());
+}
+
+TEST(ByteSourceTest, LineReaderAcrossBlocks) {
+  csvio::util::BasicCSVLineReader<OneByteSource> csv_lr(std::string{"\"x\ny\",z\r\nw"});
+
+  EXPECT_EQ("\"x\ny\",z\r\n", csv_lr.readline());
+  EXPECT_EQ("w", csv_lr.readline());
+  EXPECT_EQ(2u, csv_lr.lcount());
+  EXPECT_EQ(false, csv_lr.good());
+}
+
+TEST(ByteSourceTest, SimpleLineReaderAcrossBlocks) {
+  csvio::util::BasicCSVSimpleLineReader<OneByteSource> csv_lr(std::string{"ab,c\nd\ne"});
+
+  std::vector<std::string> expected{"ab,c", "d", "e"};
+  EXPECT_EQ(expected, read_all(csv_lr));
+  EXPECT_EQ(3u, csv_lr.lcount());
+}
+
+TEST(ByteSourceTest, LineReaderShortLastLine) {
+  std::istringstream data("1,2\n3");
+  csvio::util::CSVLineReader csv_lr(data);
+
+  std::vector<std::string> expected{"1,2\n", "3"};
+  EXPECT_EQ(expected, read_all(csv_lr));
+}
+
+TEST(ByteSourceTest, ReaderOverFile) {
+  std::FILE* file = std::fopen("data/test_data.csv", "rb");
+  ASSERT_NE(nullptr, file);
+  {
+    csvio::util::BasicCSVLineReader<csvio::util::FileByteSource> csv_lr(file);
+    csvio::CSVReader csv_reader(csv_lr, ',', true);
+
+    std::vector<std::string> expected{"100", "Henry", "59", "Zuzabuner", "YELLOW", "11/09/2017"};
+    std::vector<std::string> row;
+    while (csv_reader.good()) { row = csv_reader.read(); }
+
+    EXPECT_EQ(expected, row);
+    EXPECT_EQ(101u, csv_reader.lcount());
+  }
+  std::fclose(file);
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+
+TEST(ByteSourceTest, ReaderOverFd) {
+  const int fd = ::open("data/test_data.csv", O_RDONLY);
+  ASSERT_GE(fd, 0);
+  {
+    csvio::util::BasicCSVSimpleLineReader<csvio::util::FdByteSource> csv_lr(fd);
+    csvio::CSVReader csv_reader(csv_lr, ',', true);
+
+    std::vector<std::string> expected{"100", "Henry", "59", "Zuzabuner", "YELLOW", "11/09/2017"};
+    std::vector<std::string> row;
+    while (csv_reader.good()) { row = csv_reader.read(); }
+
+    EXPECT_EQ(expected, row);
+    EXPECT_EQ(101u, csv_reader.lcount());
+  }
+  ::close(fd);
+}
+
+TEST(ByteSourceTest, ReaderOverMMap) {
+  csvio::util::BasicCSVLineReader<csvio::util::MMapByteSource> csv_lr("data/test_data.csv");
+  ASSERT_EQ(true, csv_lr.source().is_open());
+
+  csvio::CSVReader csv_reader(csv_lr, ',', true);
+
+  std::vector<std::string> expected_header{"seq", "name/first", "age", "city", "pick", "date"};
+  std::vector<std::string> expected{"100", "Henry", "59", "Zuzabuner", "YELLOW", "11/09/2017"};
+  std::vector<std::string> row;
+  while (csv_reader.good()) { row = csv_reader.read(); }
+
+  EXPECT_EQ(expected_header, csv_reader.get_header_names());
+  EXPECT_EQ(expected, row);
+  EXPECT_EQ(101u, csv_reader.lcount());
+}
+
+TEST(ByteSourceTest, MMapWithRandomAdvice) {
+  csvio::util::MMapByteSource sequential("data/test_data.csv");
+  csvio::util::MMapByteSource random("data/test_data.csv", MADV_RANDOM);
+  ASSERT_EQ(true, random.is_open());
+
+  const std::string expected(sequential.next_view());
+  EXPECT_FALSE(expected.empty());
+  EXPECT_EQ(expected, std::string(random.next_view()));
+}
+
+TEST(ByteSourceTest, MMapMissingFile) {
+  csvio::util::BasicCSVLineReader<csvio::util::MMapByteSource> csv_lr("data/does_not_exist.csv");
+
+  EXPECT_EQ(false, csv_lr.source().is_open());
+  EXPECT_EQ("", csv_lr.readline());
+  EXPECT_EQ(false, csv_lr.good());
+}
+
+#endif
+
+}  // namespace
@@ -0,0 +1,197 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Matthew Guidry
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "csvio/compress.hpp"
+#include "csvio/csvio.hpp"
+#include "gtest/gtest.h"
+
+namespace {
+
+#if defined(CSVIO_WITH_ZLIB)
+
+// inflate one gzip member, return the number of compressed bytes consumed
+std::size_t gunzip_member(const std::string& data, std::size_t offset, std::string& out) {
+  z_stream stream{};
+  inflateInit2(&stream, 15 + 16);
+  stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data() + offset));
+  stream.avail_in = static_cast<uInt>(data.size() - offset);
+  char buffer[4096];
+  int rc{Z_OK};
+  while (rc == Z_OK) {
+    stream.next_out = reinterpret_cast<Bytef*>(buffer);
+    stream.avail_out = sizeof(buffer);
+    rc = inflate(&stream, Z_NO_FLUSH);
+    out.append(buffer, sizeof(buffer) - stream.avail_out);
+  }
+  EXPECT_EQ(Z_STREAM_END, rc);
+  const std::size_t consumed = stream.total_in;
+  inflateEnd(&stream);
+  return consumed;
+}
+
+std::string gunzip(const std::string& data) {
+  std::string out;
+  for (std::size_t offset = 0; offset < data.size();) {
+    offset += gunzip_member(data, offset, out);
+  }
+  return out;
+}
+
+std::string make_csv(int rows) {
+  std::ostringstream outstream;
+  csvio::util::CSVLineWriter csv_lw(outstream);
+  csvio::CSVWriter csv_writer(csv_lw);
+  for (int i = 0; i < rows; i++) {
+    csv_writer.write(
+        {std::to_string(i), "sometext", "some,text", std::to_string(i * 7919 % 1000)});
+  }
+  return outstream.str();
+}
+
+using BgzfSink = csvio::util::BgzfByteSink<csvio::util::OStreamByteSink>;
+using BgzfWriter = csvio::util::BasicCSVBufferedLineWriter<BgzfSink>;
+
+TEST(BgzfByteSinkTest, RoundTrip) {
+  for (unsigned threads : {1u, 3u}) {
+    std::ostringstream compressed;
+    const std::string csv = make_csv(20000);
+    {
+      BgzfSink sink(csvio::util::OStreamByteSink(compressed), 6, threads);
+      // odd write sizes straddle block boundaries
+      for (std::size_t offset = 0; offset < csv.size(); offset += 1000) {
+        const auto count = std::min<std::size_t>(1000, csv.size() - offset);
+        EXPECT_TRUE(sink.write(csv.data() + offset, count));
+      }
+      EXPECT_TRUE(sink.close());
+    }
+    EXPECT_LT(compressed.str().size(), csv.size());
+    EXPECT_EQ(csv, gunzip(compressed.str()));
+  }
+}
+
+TEST(BgzfByteSinkTest, IndependentBlocks) {
+  std::ostringstream compressed;
+  const std::string csv = make_csv(50000);
+  {
+    BgzfWriter line_writer(csvio::util::OStreamByteSink(compressed), 1, 2u);
+    std::istringstream instream(csv);
+    std::string line;
+    while (std::getline(instream, line)) { line_writer.writeline(line + '\n'); }
+  }
+
+  // every block names its own size and decompresses on its own
+  const std::string data = compressed.str();
+  std::string out;
+  std::size_t blocks{0};
+  for (std::size_t offset = 0; offset < data.size(); blocks++) {
+    ASSERT_GE(data.size() - offset, 18u);
+    EXPECT_EQ('B', data[offset + 12]);
+    EXPECT_EQ('C', data[offset + 13]);
+    const std::size_t size = (static_cast<unsigned char>(data[offset + 16]) |
+                              static_cast<unsigned char>(data[offset + 17]) << 8) + 1u;
+    EXPECT_EQ(size, gunzip_member(data.substr(offset, size), 0, out));
+    offset += size;
+  }
+  EXPECT_GT(blocks, 2u);
+  EXPECT_EQ(data.size() - 28, data.rfind(csvio::util::BgzfDeflater::eof_block()));
+
+  std::string expected;
+  std::istringstream instream(csv);
+  std::string line;
+  while (std::getline(instream, line)) { expected += line + '\n'; }
+  EXPECT_EQ(expected, out);
+}
+
+TEST(BgzfByteSinkTest, EmptyStream) {
+  std::ostringstream compressed;
+  { BgzfSink sink{csvio::util::OStreamByteSink(compressed)}; }
+  EXPECT_EQ(std::string(csvio::util::BgzfDeflater::eof_block()), compressed.str());
+  EXPECT_EQ("", gunzip(compressed.str()));
+}
+
+#endif  // CSVIO_WITH_ZLIB
+
+#if defined(CSVIO_WITH_ZSTD)
+
+TEST(ZstdByteSinkTest, RoundTrip) {
+  std::string csv;
+  for (int i = 0; i < 20000; i++) { csv += std::to_string(i) + ",sometext,\"some,text\"\r\n"; }
+
+  for (unsigned threads : {0u, 2u}) {
+    std::ostringstream compressed;
+    {
+      csvio::util::ZstdByteSink<csvio::util::OStreamByteSink> sink(
+          csvio::util::OStreamByteSink(compressed), 3, threads);
+      EXPECT_TRUE(sink.write(csv.data(), csv.size() / 2));
+      EXPECT_TRUE(sink.flush());
+      EXPECT_TRUE(sink.write(csv.data() + csv.size() / 2, csv.size() - csv.size() / 2));
+    }
+
+    const std::string data = compressed.str();
+    ZSTD_DCtx* context = ZSTD_createDCtx();
+    ZSTD_inBuffer input{data.data(), data.size(), 0};
+    std::string out;
+    std::vector<char> buffer(ZSTD_DStreamOutSize());
+    while (input.pos < input.size) {
+      ZSTD_outBuffer output{buffer.data(), buffer.size(), 0};
+      ASSERT_FALSE(ZSTD_isError(ZSTD_decompressStream(context, &output, &input)));
+      out.append(buffer.data(), output.pos);
+    }
+    ZSTD_freeDCtx(context);
+    EXPECT_EQ(csv, out);
+  }
+}
+
+TEST(ZstdByteSinkTest, BufferedLineWriter) {
+  using ZstdSink = csvio::util::ZstdByteSink<csvio::util::OStreamByteSink>;
+  std::ostringstream compressed;
+  std::string expected;
+  {
+    csvio::util::BasicCSVBufferedLineWriter<ZstdSink> line_writer(
+        csvio::util::OStreamByteSink(compressed), 1, 2u);
+    csvio::CSVWriter<std::vector, csvio::util::BasicCSVBufferedLineWriter<ZstdSink>>
+        csv_writer(line_writer);
+    for (int i = 0; i < 50000; i++) {
+      csv_writer.write({std::to_string(i), "some,text"});
+      expected += std::to_string(i) + ",\"some,text\"\r\n";
+    }
+  }
+
+  const std::string data = compressed.str();
+  EXPECT_LT(data.size(), expected.size());
+  std::string out(expected.size() + 1, '\0');
+  const std::size_t size = ZSTD_decompress(out.data(), out.size(), data.data(), data.size());
+  ASSERT_FALSE(ZSTD_isError(size));
+  out.resize(size);
+  EXPECT_EQ(expected, out);
+}
+
+#endif  // CSVIO_WITH_ZSTD
+
+}  // namespace
@@ -0,0 +1,326 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Matthew Guidry
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <atomic>
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "csvio/csvio.hpp"
+#include "gtest/gtest.h"
+
+namespace {
+
+// LineWriter that holds the background thread until released
+class GatedLineWriter {
+public:
+  void writeline(std::string_view line) {
+    while (!m_open.load()) { std::this_thread::yield(); }
+    m_data.append(line);
+    m_lines++;
+  }
+  bool good() { return true; }
+  [[nodiscard]] std::size_t lcount() const { return m_lines; }
+
+  std::atomic<bool> m_open{false};
+  std::string m_data;
+  std::size_t m_lines{0};
+};
+
+std::vector<std::string> split_lines(const std::string& data) {
+  std::vector<std::string> lines;
+  std::istringstream instream(data);
+  std::string line;
+  while (std::getline(instream, line)) { lines.push_back(line); }
+  return lines;
+}
+
+// every producer writes "p,i" rows, check each producer's rows appear in order
+void expect_producer_order(const std::string& data, int producers, int rows) {
+  std::vector<int> next(static_cast<std::size_t>(producers), 0);
+  for (const auto& line : split_lines(data)) {
+    const auto comma = line.find(',');
+    const auto producer = static_cast<std::size_t>(std::stoi(line.substr(0, comma)));
+    EXPECT_EQ(next[producer], std::stoi(line.substr(comma + 1)));
+    next[producer]++;
+  }
+  for (const auto count : next) { EXPECT_EQ(rows, count); }
+}
+
+TEST(BoundedMPSCQueueTest, PushPop) {
+  csvio::util::BoundedMPSCQueue<int> queue(3);
+  EXPECT_EQ(4u, queue.capacity());
+  EXPECT_TRUE(queue.empty());
+
+  for (int i = 0; i < 4; i++) {
+    int value = i;
+    EXPECT_TRUE(queue.try_push(std::move(value)));
+  }
+  int extra{9};
+  EXPECT_FALSE(queue.try_push(std::move(extra)));
+
+  int value{-1};
+  for (int i = 0; i < 4; i++) {
+    ASSERT_TRUE(queue.try_pop(value));
+    EXPECT_EQ(i, value);
+  }
+  EXPECT_FALSE(queue.try_pop(value));
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST(CSVAsyncWriterTest, WriteAndFlush) {
+  std::ostringstream outstream;
+  csvio::util::CSVLineWriter csv_lw(outstream);
+  csvio::CSVAsyncWriter csv_writer(csv_lw);
+
+  EXPECT_TRUE(csv_writer.write_header({"a", "b"}));
+  const std::vector<std::string> row{"1", "x,y"};
+  EXPECT_TRUE(csv_writer.write(row));
+  EXPECT_TRUE(csv_writer.write_line("pre,formatted\r\n"));
+  csv_writer.flush();
+
+  EXPECT_EQ("a,b\r\n1,\"x,y\"\r\npre,formatted\r\n", outstream.str());
+  EXPECT_EQ(3u, csv_writer.lcount());
+  EXPECT_TRUE(csv_writer.good());
+}
+
+TEST(CSVAsyncWriterTest, ExchangeLineRecyclesBuffers) {
+  std::ostringstream outstream;
+  csvio::util::CSVLineWriter csv_lw(outstream);
+  csvio::CSVAsyncWriter csv_writer(csv_lw, ',', true, "\n", csvio::util::BLOCK, 2);
+
+  std::string line;
+  std::string expected;
+  for (int i = 0; i < 8; i++) {
+    line.append("row,").append(std::to_string(i)).append(std::string(64, 'x')).append("\n");
+    expected.append(line);
+    EXPECT_TRUE(csv_writer.exchange_line(line));
+    EXPECT_TRUE(line.empty());
+    csv_writer.flush();
+  }
+  // after the two slots have cycled the buffers handed back are ones already written
+  EXPECT_GE(line.capacity(), 64u);
+  EXPECT_EQ(expected, outstream.str());
+
+  csv_writer.close();
+  line = "late\n";
+  EXPECT_FALSE(csv_writer.exchange_line(line));
+  EXPECT_EQ("late\n", line);
+}
+
+TEST(CSVAsyncWriterTest, ManyProducers) {
+  const int producers{4};
+  const int rows{5000};
+  std::ostringstream outstream;
+  csvio::util::CSVLineWriter csv_lw(outstream);
+  {
+    csvio::CSVAsyncWriter csv_writer(csv_lw, ',', true, "\n", csvio::util::BLOCK, 64);
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++) {
+      threads.emplace_back([&csv_writer, p] {
+        for (int i = 0; i < rows; i++) {
+          csv_writer.write(std::vector<std::string>{std::to_string(p), std::to_string(i)});
+        }
+      });
+    }
+    for (auto& thread : threads) { thread.join(); }
+    csv_writer.close();
+    EXPECT_EQ(static_cast<std::size_t>(producers * rows), csv_writer.lcount());
+    EXPECT_EQ(0u, csv_writer.dropped());
+  }
+  expect_producer_order(outstream.str(), producers, rows);
+}
+
+TEST(CSVAsyncWriterTest, CloseWhileWriting) {
+  const int producers{4};
+  for (int run = 0; run < 50; run++) {
+    std::ostringstream outstream;
+    csvio::util::CSVLineWriter csv_lw(outstream);
+    csvio::CSVAsyncWriter csv_writer(csv_lw, ',', true, "\n", csvio::util::BLOCK, 64);
+    std::atomic<std::size_t> accepted{0};
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++) {
+      threads.emplace_back([&csv_writer, &accepted, p] {
+        const std::string line = std::to_string(p) + ",row\n";
+        while (csv_writer.write_line(line)) { accepted++; }
+      });
+    }
+    std::thread closer([&csv_writer] {
+      std::this_thread::sleep_for(std::chrono::microseconds(200));
+      csv_writer.close();
+    });
+    closer.join();
+    for (auto& thread : threads) { thread.join(); }
+
+    // every row write_line() accepted must reach the LineWriter
+    EXPECT_EQ(accepted.load(), csv_writer.lcount());
+    EXPECT_EQ(accepted.load(), split_lines(outstream.str()).size());
+  }
+}
+
+TEST(CSVAsyncWriterTest, DropWhenFull) {
+  GatedLineWriter line_writer;
+  csvio::CSVAsyncWriter<std::vector, GatedLineWriter> csv_writer(line_writer, ',', true, "\n",
+                                                                 csvio::util::DROP, 4);
+  std::size_t accepted{0};
+  for (int i = 0; i < 100; i++) {
+    if (csv_writer.write(std::vector<std::string>{std::to_string(i)})) { accepted++; }
+  }
+  EXPECT_GT(csv_writer.dropped(), 0u);
+  EXPECT_EQ(100u, accepted + csv_writer.dropped());
+
+  line_writer.m_open = true;
+  csv_writer.close();
+  EXPECT_EQ(accepted, csv_writer.lcount());
+  EXPECT_FALSE(csv_writer.write(std::vector<std::string>{"late"}));
+}
+
+TEST(CSVAsyncWriterTest, LineWriterCountsRows) {
+  const int rows{3000};
+  std::ostringstream outstream;
+  csvio::util::CSVLineWriter csv_lw(outstream);
+  GatedLineWriter gated_lw;
+  gated_lw.m_open = true;
+  {
+    csvio::CSVAsyncWriter csv_writer(csv_lw, ',', true, "\n", csvio::util::BLOCK, 64);
+    csvio::CSVAsyncWriter<std::vector, GatedLineWriter> gated_writer(gated_lw, ',', true, "\n",
+                                                                     csvio::util::BLOCK, 64);
+    for (int i = 0; i < rows; i++) {
+      csv_writer.write(std::vector<std::string>{"row", std::to_string(i)});
+      gated_writer.write(std::vector<std::string>{"row", std::to_string(i)});
+    }
+  }
+  // batches go through writelines() or one writeline() per row, never one line per batch
+  EXPECT_EQ(static_cast<std::size_t>(rows), csv_lw.lcount());
+  EXPECT_EQ(static_cast<std::size_t>(rows), gated_lw.lcount());
+  EXPECT_EQ(outstream.str(), gated_lw.m_data);
+}
+
+TEST(CSVAsyncWriterTest, BlockWaitsForFreeSlot) {
+  const std::size_t rows{50};
+  GatedLineWriter line_writer;
+  csvio::CSVAsyncWriter<std::vector, GatedLineWriter> csv_writer(line_writer, ',', true, "\n",
+                                                                 csvio::util::BLOCK, 2);
+  std::atomic<std::size_t> accepted{0};
+  std::thread producer([&] {
+    for (std::size_t i = 0; i < rows; i++) {
+      if (csv_writer.write(std::vector<std::string>{std::to_string(i)})) { accepted++; }
+    }
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_LT(accepted.load(), rows);
+
+  line_writer.m_open = true;
+  producer.join();
+  csv_writer.close();
+  EXPECT_EQ(rows, accepted.load());
+  EXPECT_EQ(rows, csv_writer.lcount());
+  EXPECT_EQ(0u, csv_writer.dropped());
+}
+
+TEST(CSVAsyncWriterTest, CloseReleasesBlockedProducer) {
+  GatedLineWriter line_writer;
+  csvio::CSVAsyncWriter<std::vector, GatedLineWriter> csv_writer(line_writer, ',', true, "\n",
+                                                                 csvio::util::BLOCK, 2);
+  std::atomic<std::size_t> accepted{0};
+  std::thread producer([&] {
+    while (csv_writer.write(std::vector<std::string>{"row"})) { accepted++; }
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+  std::thread opener([&line_writer] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    line_writer.m_open = true;
+  });
+  csv_writer.close();
+  producer.join();
+  opener.join();
+  EXPECT_EQ(accepted.load(), csv_writer.lcount());
+  EXPECT_EQ(1u, csv_writer.dropped());
+}
+
+// wait without flush() for the background thread to pick rows up on its own
+bool wait_for_lcount(const csvio::CSVAsyncWriter<>& csv_writer, std::size_t lines) {
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (csv_writer.lcount() < lines) {
+    if (std::chrono::steady_clock::now() > deadline) { return false; }
+    std::this_thread::yield();
+  }
+  return true;
+}
+
+TEST(CSVAsyncWriterTest, EveryWriteWakesByDefault) {
+  std::ostringstream outstream;
+  csvio::util::CSVLineWriter csv_lw(outstream);
+  csvio::CSVAsyncWriter csv_writer(csv_lw, ',', true, "\n");
+  for (std::size_t i = 0; i < 500; i++) {
+    csv_writer.write(std::vector<std::string>{std::to_string(i)});
+    ASSERT_TRUE(wait_for_lcount(csv_writer, i + 1));
+  }
+}
+
+TEST(CSVAsyncWriterTest, WakeBacklogPolls) {
+  std::ostringstream outstream;
+  csvio::util::CSVLineWriter csv_lw(outstream);
+  csvio::CSVAsyncWriter csv_writer(csv_lw, ',', true, "\n");
+  csv_writer.set_wake_backlog(64);
+  // below the backlog no write wakes the background thread, it still polls the row up
+  for (std::size_t i = 0; i < 5; i++) {
+    csv_writer.write(std::vector<std::string>{std::to_string(i)});
+    ASSERT_TRUE(wait_for_lcount(csv_writer, i + 1));
+  }
+  csv_writer.set_wake_backlog(1);
+  csv_writer.write(std::vector<std::string>{"last"});
+  EXPECT_TRUE(wait_for_lcount(csv_writer, 6));
+}
+
+TEST(CSVAsyncWriterTest, GrowWhenFull) {
+  const int producers{3};
+  const int rows{2000};
+  GatedLineWriter line_writer;
+  csvio::CSVAsyncWriter<std::vector, GatedLineWriter> csv_writer(line_writer, ',', true, "\n",
+                                                                 csvio::util::GROW, 8);
+  std::vector<std::thread> threads;
+  for (int p = 0; p < producers; p++) {
+    threads.emplace_back([&csv_writer, p] {
+      for (int i = 0; i < rows; i++) {
+        EXPECT_TRUE(
+            csv_writer.write(std::vector<std::string>{std::to_string(p), std::to_string(i)}));
+      }
+    });
+  }
+  for (auto& thread : threads) { thread.join(); }
+
+  line_writer.m_open = true;
+  csv_writer.flush();
+  EXPECT_EQ(static_cast<std::size_t>(producers * rows), csv_writer.lcount());
+  EXPECT_EQ(0u, csv_writer.dropped());
+  csv_writer.close();
+  expect_producer_order(line_writer.m_data, producers, rows);
+}
+
+}  // namespace
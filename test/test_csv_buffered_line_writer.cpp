@@ -0,0 +1,251 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Matthew Guidry
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "csvio/csvio.hpp"
+#include "gtest/gtest.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+namespace {
+
+TEST(CSVBufferedLineWriterTest, ConstructorFromOStream) {
+  std::ostringstream data;
+  csvio::util::CSVBufferedLineWriter csv_lw(data);
+
+  EXPECT_EQ(0u, csv_lw.lcount());
+  EXPECT_EQ(true, csv_lw.good());
+  EXPECT_EQ(csvio::util::default_write_buffer_size, csv_lw.get_buffer_size());
+}
+
+TEST(CSVBufferedLineWriterTest, ManualFlush) {
+  std::ostringstream data;
+  csvio::util::CSVBufferedLineWriter csv_lw(data);
+
+  csv_lw.writeline("1,1\r\n");
+  csv_lw.writeline("2,2\r\n");
+  EXPECT_EQ("", data.str());
+  EXPECT_EQ(10u, csv_lw.buffered());
+  EXPECT_EQ(2u, csv_lw.lcount());
+
+  EXPECT_EQ(true, csv_lw.flush());
+  EXPECT_EQ("1,1\r\n2,2\r\n", data.str());
+  EXPECT_EQ(0u, csv_lw.buffered());
+}
+
+TEST(CSVBufferedLineWriterTest, FlushOnDestruction) {
+  std::ostringstream data;
+  {
+    csvio::util::CSVBufferedLineWriter csv_lw(data);
+    csv_lw.writeline("1,1\r\n");
+  }
+  EXPECT_EQ("1,1\r\n", data.str());
+}
+
+TEST(CSVBufferedLineWriterTest, FlushByRows) {
+  std::ostringstream data;
+  csvio::util::CSVBufferedLineWriter csv_lw(data);
+  csv_lw.set_flush_policy(csvio::util::FlushPolicy::rows(2));
+
+  csv_lw.writeline("a\n");
+  EXPECT_EQ("", data.str());
+  csv_lw.writeline("b\n");
+  EXPECT_EQ("a\nb\n", data.str());
+  csv_lw.writeline("c\n");
+  EXPECT_EQ("a\nb\n", data.str());
+}
+
+TEST(CSVBufferedLineWriterTest, FlushByBytes) {
+  std::ostringstream data;
+  csvio::util::CSVBufferedLineWriter csv_lw(data);
+  csv_lw.set_flush_policy(csvio::util::FlushPolicy::bytes(5));
+
+  csv_lw.writeline("ab\n");
+  EXPECT_EQ("", data.str());
+  csv_lw.writeline("cd\n");
+  EXPECT_EQ("ab\ncd\n", data.str());
+}
+
+TEST(CSVBufferedLineWriterTest, FlushWhenFull) {
+  std::ostringstream data;
+  csvio::util::CSVBufferedLineWriter csv_lw(data);
+  csv_lw.set_buffer_size(8);
+
+  csv_lw.writeline("abc\n");
+  csv_lw.writeline("def\n");
+  EXPECT_EQ("", data.str());
+  csv_lw.writeline("g\n");
+  EXPECT_EQ("abc\ndef\n", data.str());
+  csv_lw.writeline("a line longer than the buffer\n");
+  EXPECT_EQ("abc\ndef\ng\na line longer than the buffer\n", data.str());
+  EXPECT_EQ(4u, csv_lw.lcount());
+}
+
+TEST(CSVBufferedLineWriterTest, WriteWithCSVWriter) {
+  std::ostringstream data;
+  csvio::util::CSVBufferedLineWriter csv_lw(data);
+  csvio::CSVWriter csv_writer(csv_lw);
+
+  csv_writer.write_header({"a", "b"});
+  csv_writer.write({"1", "2,3"});
+  csv_lw.flush();
+
+  EXPECT_EQ("a,b\r\n1,\"2,3\"\r\n", data.str());
+  EXPECT_EQ(2u, csv_writer.lcount());
+}
+
+TEST(CSVBufferedLineWriterTest, WriteToFile) {
+  std::FILE* file = std::tmpfile();
+  ASSERT_NE(nullptr, file);
+  {
+    csvio::util::BasicCSVBufferedLineWriter<csvio::util::FileByteSink> csv_lw(file);
+    csv_lw.writeline("1,2\n");
+    csv_lw.writeline("3,4\n");
+  }
+
+  std::rewind(file);
+  char buf[16]{};
+  EXPECT_EQ(8u, std::fread(buf, 1, sizeof(buf), file));
+  EXPECT_EQ("1,2\n3,4\n", std::string(buf, 8));
+  std::fclose(file);
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+
+TEST(CSVBufferedLineWriterTest, WriteToFd) {
+  int fds[2];
+  ASSERT_EQ(0, ::pipe(fds));
+  {
+    csvio::util::BasicCSVBufferedLineWriter<csvio::util::FdByteSink> csv_lw(fds[1]);
+    csv_lw.set_buffer_size(6);
+    csv_lw.writeline("1,2\n");
+    csv_lw.writeline("a line longer than the buffer\n");
+    EXPECT_EQ(true, csv_lw.good());
+  }
+  ::close(fds[1]);
+
+  std::string result;
+  char buf[64];
+  ssize_t n;
+  while ((n = ::read(fds[0], buf, sizeof(buf))) > 0) {
+    result.append(buf, static_cast<std::size_t>(n));
+  }
+  ::close(fds[0]);
+
+  EXPECT_EQ("1,2\na line longer than the buffer\n", result);
+}
+
+TEST(CSVBufferedLineWriterTest, FdSinkWritesMorePartsThanOneGroup) {
+  int fds[2];
+  ASSERT_EQ(0, ::pipe(fds));
+
+  std::vector<std::string> lines;
+  for (int i = 0; i < 200; i++) { lines.push_back(std::to_string(i) + "\n"); }
+  std::vector<csvio::string_view> parts(lines.begin(), lines.end());
+  std::string expected;
+  for (const auto& line : lines) { expected += line; }
+
+  {
+    csvio::util::FdByteSink sink(fds[1]);
+    EXPECT_EQ(true, sink.writev(parts.data(), parts.size()));
+    EXPECT_EQ(true, sink.good());
+  }
+  ::close(fds[1]);
+
+  std::string result;
+  char buf[256];
+  ssize_t n;
+  while ((n = ::read(fds[0], buf, sizeof(buf))) > 0) {
+    result.append(buf, static_cast<std::size_t>(n));
+  }
+  ::close(fds[0]);
+
+  EXPECT_EQ(expected, result);
+}
+
+std::string read_file(const std::string& path) {
+  std::ifstream infile(path, std::ios::binary);
+  std::ostringstream contents;
+  contents << infile.rdbuf();
+  return contents.str();
+}
+
+TEST(CSVBufferedLineWriterTest, WriteToPreallocatedFile) {
+  const std::string path{"data/CSV_PREALLOCATED_TEST_001.csv"};
+  {
+    csvio::util::BasicCSVBufferedLineWriter<csvio::util::PreallocatedFileByteSink> csv_lw(
+        path, 1u << 20);
+    EXPECT_EQ(true, csv_lw.sink().is_open());
+    csv_lw.writeline("a,b\r\n");
+    csv_lw.writeline("1,2\r\n");
+    EXPECT_EQ(true, csv_lw.good());
+  }
+
+  EXPECT_EQ("a,b\r\n1,2\r\n", read_file(path));
+  std::remove(path.c_str());
+}
+
+TEST(CSVBufferedLineWriterTest, PreallocatedFileDisjointRegions) {
+  const std::string path{"data/CSV_PREALLOCATED_TEST_002.csv"};
+  const std::size_t region = 4096;
+  const std::size_t threads = 4;
+  {
+    csvio::util::PreallocatedFileByteSink sink(path, region * threads * 2);
+    std::vector<std::uint64_t> offsets;
+    for (std::size_t i = 0; i < threads; i++) { offsets.push_back(sink.reserve(region)); }
+
+    std::vector<std::thread> workers;
+    for (std::size_t i = 0; i < threads; i++) {
+      workers.emplace_back([&, i] {
+        const std::string data(region, static_cast<char>('a' + i));
+        EXPECT_EQ(true, sink.write_at(data.data(), data.size(), offsets[i]));
+      });
+    }
+    for (auto& worker : workers) { worker.join(); }
+
+    EXPECT_EQ(region * threads, sink.size());
+    EXPECT_EQ(true, sink.close());
+  }
+
+  const std::string contents = read_file(path);
+  ASSERT_EQ(region * threads, contents.size());
+  for (std::size_t i = 0; i < threads; i++) {
+    EXPECT_EQ(std::string(region, static_cast<char>('a' + i)), contents.substr(i * region, region));
+  }
+  std::remove(path.c_str());
+}
+
+#endif
+
+}  // namespace
@@ -0,0 +1,143 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Matthew Guidry
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <functional>
+#include <random>
+#include <sstream>
+#include <string>
+
+#include "csvio/group_by.hpp"
+#include "gtest/gtest.h"
+
+namespace {
+
+using GroupBy = csvio::CSVGroupBy<>;
+
+std::string group_csv(const std::string& input, const std::function<void(GroupBy&)>& setup,
+                      unsigned threads = 1) {
+  std::istringstream instream(input);
+  std::ostringstream outstream;
+  csvio::util::CSVLineReader csv_lr(instream);
+  csvio::util::CSVLineWriter csv_lw(outstream);
+  GroupBy group_by(csv_lr, csv_lw, ',', true, true, "\n");
+  setup(group_by);
+  group_by.set_threads(threads);
+  group_by.run();
+  return outstream.str();
+}
+
+TEST(RawKeyMapTest, NumbersKeysInInsertionOrder) {
+  csvio::util::RawKeyMap map;
+  for (int i = 0; i < 1000; i++) {
+    const auto [index, inserted] = map.insert(std::to_string(i));
+    EXPECT_EQ(static_cast<std::uint32_t>(i), index);
+    EXPECT_TRUE(inserted);
+  }
+  EXPECT_EQ(std::make_pair(std::uint32_t{42}, false), map.insert("42"));
+  EXPECT_EQ(std::make_pair(std::uint32_t{1000}, true), map.insert(std::string("\0", 1)));
+  EXPECT_EQ(std::make_pair(std::uint32_t{1001}, true), map.insert(""));
+  EXPECT_EQ(1002u, map.size());
+  EXPECT_EQ("999", map.key(999));
+  EXPECT_EQ(7u, map.find("7"));
+  EXPECT_EQ(csvio::util::RawKeyMap::npos, map.find("1000"));
+  EXPECT_EQ(csvio::util::RawKeyMap::npos, csvio::util::RawKeyMap{}.find(""));
+}
+
+TEST(CSVGroupByTest, CountSumMeanInFirstSeenOrder) {
+  const std::string input{"g,v\nb,1\na,2\nb,3\n\na,n/a\nc,\n"};
+  const auto output = group_csv(input, [](GroupBy& group_by) {
+    group_by.add_key("g");
+    group_by.add_aggregate(csvio::COUNT, "");
+    group_by.add_aggregate(csvio::SUM, "v");
+    group_by.add_aggregate(csvio::MEAN, "v", csvio::NUMERIC, "avg");
+  });
+  EXPECT_EQ("g,count,sum_v,avg\nb,2,4,2\na,2,2,2\nc,1,,\n", output);
+}
+
+TEST(CSVGroupByTest, TypedMinMax) {
+  const std::string input{"g,n,s,d\nx,10,b,2/3/2001\nx,9,a,08/08/1962\nx,100,c,1999-12-31\n"};
+  const auto output = group_csv(input, [](GroupBy& group_by) {
+    group_by.add_key("g");
+    group_by.add_aggregate(csvio::MIN, "n");
+    group_by.add_aggregate(csvio::MAX, "n");
+    group_by.add_aggregate(csvio::MIN, "s", csvio::STRING);
+    group_by.add_aggregate(csvio::MAX, "s", csvio::STRING);
+    group_by.add_aggregate(csvio::MIN, "d", csvio::DATE);
+    group_by.add_aggregate(csvio::MAX, "d", csvio::DATE);
+  });
+  EXPECT_EQ("g,min_n,max_n,min_s,max_s,min_d,max_d\nx,9,100,a,c,08/08/1962,2/3/2001\n",
+            output);
+}
+
+TEST(CSVGroupByTest, SeveralKeysWithQuotedFields) {
+  const std::string input{"a,b,v\n\"x,y\",1,q\nx,\"y,1\",q\n\"x,y\",1,r\n\"x,y\",\"1\",q\n"};
+  const auto output = group_csv(input, [](GroupBy& group_by) {
+    group_by.add_key("a");
+    group_by.add_key("b", "second");
+    group_by.add_aggregate(csvio::COUNT_DISTINCT, "v");
+  });
+  EXPECT_EQ("a,second,count_distinct_v\n\"x,y\",1,2\nx,\"y,1\",1\n", output);
+}
+
+TEST(CSVGroupByTest, NoKeysAggregatesEverything) {
+  const std::string input{"v\n1\n2\n3\n"};
+  const auto output = group_csv(input, [](GroupBy& group_by) {
+    group_by.add_aggregate(csvio::SUM, 0);
+    group_by.add_aggregate(csvio::MAX, "v");
+  });
+  EXPECT_EQ("sum_v,max_v\n6,3\n", output);
+}
+
+TEST(CSVGroupByTest, EmptyInputWritesHeader) {
+  const auto output = group_csv("g,v\n", [](GroupBy& group_by) {
+    group_by.add_key("g");
+    group_by.add_aggregate(csvio::COUNT, "");
+  });
+  EXPECT_EQ("g,count\n", output);
+}
+
+TEST(CSVGroupByTest, ThreadsMatchSingleThread) {
+  std::mt19937 random(3);
+  std::string input{"g,v,w\n"};
+  for (int i = 0; i < 50000; i++) {
+    input += "g" + std::to_string(random() % 97) + "," + std::to_string(random() % 1000) +
+             ",\"w\n" + std::to_string(random() % 13) + "\"\n";
+    if (i % 10000 == 0) { input += "\n"; }
+  }
+  const auto setup = [](GroupBy& group_by) {
+    group_by.add_key("g");
+    group_by.add_aggregate(csvio::COUNT, "");
+    group_by.add_aggregate(csvio::SUM, "v");
+    group_by.add_aggregate(csvio::MIN, "v");
+    group_by.add_aggregate(csvio::MAX, "w", csvio::STRING);
+    group_by.add_aggregate(csvio::COUNT_DISTINCT, "w");
+  };
+  const auto expected = group_csv(input, setup, 1);
+  EXPECT_EQ(98, std::count(expected.begin(), expected.end(), '\n') -
+                    std::count(expected.begin(), expected.end(), '"') / 2);
+  EXPECT_EQ(expected, group_csv(input, setup, 4));
+}
+
+}  // namespace
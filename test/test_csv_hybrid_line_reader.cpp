@@ -0,0 +1,145 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Matthew Guidry
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "csvio/csvio.hpp"
+#include "gtest/gtest.h"
+
+namespace {
+
+TEST(CSVHybridLineReaderTest, ConstructorFromIStream) {
+  std::istringstream data("");
+  csvio::util::CSVHybridLineReader csv_lr(data);
+
+  EXPECT_EQ(0u, csv_lr.lcount());
+  EXPECT_EQ(true, csv_lr.good());
+  EXPECT_EQ("", csv_lr.readline());
+  EXPECT_EQ(1u, csv_lr.lcount());
+  EXPECT_EQ(false, csv_lr.good());
+}
+
+TEST(CSVHybridLineReaderTest, ReadTwoSampleCSVLines) {
+  std::istringstream data(
+      "1,1,1,1,1,1,1,1\n"
+      "2,2,2,2,2,2,2,2\n");
+  csvio::util::CSVHybridLineReader csv_lr(data);
+
+  EXPECT_EQ("1,1,1,1,1,1,1,1\n", csv_lr.readline());
+  EXPECT_EQ("2,2,2,2,2,2,2,2\n", csv_lr.readline());
+  EXPECT_EQ(2u, csv_lr.lcount());
+  EXPECT_EQ(false, csv_lr.good());
+}
+
+TEST(CSVHybridLineReaderTest, ReadOneSampleNoNewline) {
+  std::istringstream data("1,1,1,1,1,1,1,1");
+  csvio::util::CSVHybridLineReader csv_lr(data);
+
+  EXPECT_EQ("1,1,1,1,1,1,1,1", csv_lr.readline());
+  EXPECT_EQ(1u, csv_lr.lcount());
+  EXPECT_EQ(false, csv_lr.good());
+}
+
+TEST(CSVHybridLineReaderTest, ReadTwoLinesCRLF) {
+  std::istringstream data(
+      "1,1,1,1,1,1,1,1\r\n"
+      "2,2,2,2,2,2,2,2\r\n");
+  csvio::util::CSVHybridLineReader csv_lr(data);
+
+  EXPECT_EQ("1,1,1,1,1,1,1,1\r\n", csv_lr.readline());
+  EXPECT_EQ("2,2,2,2,2,2,2,2\r\n", csv_lr.readline());
+  EXPECT_EQ(2u, csv_lr.lcount());
+  EXPECT_EQ(false, csv_lr.good());
+}
+
+TEST(CSVHybridLineReaderTest, ReadOnePrematureEOF) {
+  std::istringstream data("1,1,1,\"1\n");
+  csvio::util::CSVHybridLineReader csv_lr(data);
+
+  EXPECT_EQ("", csv_lr.readline());
+  EXPECT_EQ(0u, csv_lr.lcount());
+  EXPECT_EQ(false, csv_lr.good());
+}
+
+TEST(CSVHybridLineReaderTest, ReadMultiMixed) {
+  std::istringstream data(
+      "1,1,1,1,1,1,1,1\n"
+      "\"1\n\",\"1\n\",\"1\n\",\"1\n\",\"1\n\",\"1\n\",\"1\n\",\"1\n\"\n"
+      "2,2,2,2,2,2,2,2\n"
+      "\"\"\"one\"\"\",\"tw\n"
+      "o\",\"\"\"th,r\n"
+      "ee\"\"\",\"\"\"fo\n"
+      "u\"\"r\"\"\",5,6,7,8\n"
+      "3,3,3,3,3,3,3,3\n");
+  csvio::util::CSVHybridLineReader csv_lr(data);
+
+  EXPECT_EQ("1,1,1,1,1,1,1,1\n", csv_lr.readline());
+  EXPECT_EQ("\"1\n\",\"1\n\",\"1\n\",\"1\n\",\"1\n\",\"1\n\",\"1\n\",\"1\n\"\n", csv_lr.readline());
+  EXPECT_EQ("2,2,2,2,2,2,2,2\n", csv_lr.readline());
+  EXPECT_EQ(
+      "\"\"\"one\"\"\",\"tw\n"
+      "o\",\"\"\"th,r\n"
+      "ee\"\"\",\"\"\"fo\n"
+      "u\"\"r\"\"\",5,6,7,8\n",
+      csv_lr.readline());
+  EXPECT_EQ("3,3,3,3,3,3,3,3\n", csv_lr.readline());
+  EXPECT_EQ(5u, csv_lr.lcount());
+  EXPECT_EQ(false, csv_lr.good());
+}
+
+TEST(CSVHybridLineReaderTest, MatchesConformingReaderAcrossBlocks) {
+  std::string data;
+  for (int i = 0; i < 20000; i++) {
+    data.append(std::to_string(i));
+    data.append(i % 1000 == 0 ? ",\"quoted\nfield, with \"\"quotes\"\"\"\n" : ",plain,field\n");
+  }
+
+  std::istringstream conforming_data(data);
+  std::istringstream hybrid_data(data);
+  csvio::util::CSVLineReader conforming(conforming_data);
+  csvio::util::CSVHybridLineReader hybrid(hybrid_data);
+
+  while (conforming.good()) {
+    ASSERT_EQ(true, hybrid.good());
+    ASSERT_EQ(conforming.readline(), hybrid.readline());
+  }
+  EXPECT_EQ(false, hybrid.good());
+  EXPECT_EQ(conforming.lcount(), hybrid.lcount());
+}
+
+TEST(CSVHybridLineReaderTest, ReadWithCSVReader) {
+  std::istringstream data("a,\"b\nc\",d\n1,2,3\n");
+  csvio::util::CSVHybridLineReader csv_lr(data);
+  csvio::CSVReader csv_reader(csv_lr, ',', true);
+
+  std::vector<std::string> expected_header{"a", "b\nc", "d"};
+  std::vector<std::string> expected{"1", "2", "3"};
+  EXPECT_EQ(expected_header, csv_reader.get_header_names());
+  EXPECT_EQ(expected, csv_reader.read());
+}
+
+}  // namespace
@@ -0,0 +1,104 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Matthew Guidry
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <functional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "csvio/join.hpp"
+#include "gtest/gtest.h"
+
+namespace {
+
+using Join = csvio::CSVJoin<>;
+
+std::string join_csv(const std::string& build, const std::string& probe,
+                     const std::function<void(Join&)>& setup, bool has_header = true) {
+  std::istringstream build_stream(build);
+  std::istringstream probe_stream(probe);
+  std::ostringstream outstream;
+  csvio::util::CSVLineReader build_lr(build_stream);
+  csvio::util::CSVLineReader probe_lr(probe_stream);
+  csvio::util::CSVLineWriter csv_lw(outstream);
+  Join join(build_lr, probe_lr, csv_lw, csvio::INNER, ',', has_header, true, "\n");
+  setup(join);
+  join.run();
+  return outstream.str();
+}
+
+const std::string products{"sku,name,price\n1,apple,0.5\n2,\"pear, green\",0.75\n\n3,plum,1\n"};
+const std::string sales{"id,sku\n10,2\n11,4\n12,1\n13,\"2\"\n"};
+
+TEST(CSVJoinTest, InnerJoinDropsUnmatched) {
+  const auto output = join_csv(products, sales, [](Join& join) { join.add_key("sku"); });
+  EXPECT_EQ("id,sku,name,price\n10,2,\"pear, green\",0.75\n12,1,apple,0.5\n"
+            "13,2,\"pear, green\",0.75\n",
+            output);
+}
+
+TEST(CSVJoinTest, LeftJoinKeepsUnmatched) {
+  const auto output = join_csv(products, sales, [](Join& join) {
+    join.set_join_type(csvio::LEFT);
+    join.add_key("sku");
+  });
+  EXPECT_EQ("id,sku,name,price\n10,2,\"pear, green\",0.75\n11,4,,\n12,1,apple,0.5\n"
+            "13,2,\"pear, green\",0.75\n",
+            output);
+}
+
+TEST(CSVJoinTest, DuplicateBuildKeysInBuildOrder) {
+  const std::string build{"k,v\na,1\nb,2\na,3\na,4\n"};
+  const std::string probe{"x,key\np,a\nq,b\n"};
+  const auto output = join_csv(build, probe, [](Join& join) { join.add_key("k", "key"); });
+  EXPECT_EQ("x,key,v\np,a,1\np,a,3\np,a,4\nq,b,2\n", output);
+}
+
+TEST(CSVJoinTest, SeveralKeysByIndexWithoutHeader) {
+  const std::string build{"a,b,1\na,c,2\n\"a,b\",,3\n"};
+  const std::string probe{"a,b\na,c\n\"a,b\",\nb,a\n"};
+  const auto output = join_csv(
+      build, probe,
+      [](Join& join) {
+        join.add_key(0, 0);
+        join.add_key(1, 1);
+      },
+      false);
+  EXPECT_EQ("a,b,1\na,c,2\n\"a,b\",,3\n", output);
+}
+
+TEST(CSVJoinTest, EmptyBuildSide) {
+  const auto output = join_csv("sku,name\n", sales, [](Join& join) {
+    join.set_join_type(csvio::LEFT);
+    join.add_key("sku");
+  });
+  EXPECT_EQ("id,sku,name\n10,2,\n11,4,\n12,1,\n13,2,\n", output);
+}
+
+TEST(CSVJoinTest, RunWithoutKeysThrows) {
+  EXPECT_THROW(join_csv(products, sales, [](Join&) {}), std::logic_error);
+}
+
+}  // namespace
@@ -0,0 +1,129 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Matthew Guidry
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "csvio/csvio.hpp"
+#include "gtest/gtest.h"
+
+namespace {
+
+using LazyReader = csvio::CSVReader<csvio::util::LazyRow, csvio::util::CSVLineReader,
+                                    csvio::util::DelimSplitLazy<csvio::util::LazyRow>>;
+
+TEST(LazyRowTest, SplitPlainFields) {
+  csvio::util::DelimSplitLazy<csvio::util::LazyRow> parser;
+  auto& row = parser("a,b,,d\r\n", ',');
+
+  std::vector<std::string> expected{"a", "b", "", "d"};
+  EXPECT_EQ(expected, row.to_vector());
+  for (std::size_t i = 0; i < row.size(); i++) { EXPECT_EQ(false, row.needs_unescape(i)); }
+}
+
+TEST(LazyRowTest, SplitQuotedFields) {
+  csvio::util::DelimSplitLazy<csvio::util::LazyRow> parser;
+  auto& row = parser("1,\"a,\"\"b\"\"\",\"x\ny\"\n", ',');
+
+  ASSERT_EQ(3u, row.size());
+  EXPECT_EQ(false, row.needs_unescape(0));
+  EXPECT_EQ(true, row.needs_unescape(1));
+  EXPECT_EQ("\"a,\"\"b\"\"\"", row.raw(1));
+  EXPECT_EQ("a,\"b\"", row[1]);
+  EXPECT_EQ("x\ny", row.at(2));
+  EXPECT_THROW(row.at(3), std::out_of_range);
+}
+
+TEST(LazyRowTest, UnescapeIsCached) {
+  csvio::util::DelimSplitLazy<csvio::util::LazyRow> parser;
+  auto& row = parser("\"a\"\"b\",c", ',');
+
+  const auto first = row[0];
+  const auto second = row[0];
+  EXPECT_EQ("a\"b", first);
+  EXPECT_EQ(first.data(), second.data());
+  EXPECT_EQ("c", row[1]);
+}
+
+TEST(LazyRowTest, MatchesDelimSplitUnescaped) {
+  const std::vector<std::string> lines{"a,b,c,d,e",
+                                       ",,,,",
+                                       "\"a\"|\"b\"",
+                                       "\"\"\"a\"\"\",\"\"\"b\"\"\"\r\n",
+                                       "1,\"tw\no\",3\n",
+                                       "x,y\r"};
+  csvio::util::DelimSplitLazy<csvio::util::LazyRow> lazy;
+  csvio::util::DelimSplitUnescaped<std::vector> eager;
+
+  for (const auto& line : lines) {
+    EXPECT_EQ(eager(line, ','), lazy(line, ',').to_vector()) << line;
+    EXPECT_EQ(eager(line, '|'), lazy(line, '|').to_vector()) << line;
+  }
+}
+
+TEST(LazyRowTest, ReadWithCSVReader) {
+  std::istringstream instream("h1,h2\n\"\"\"a\"\"\",b\n");
+  csvio::util::CSVLineReader csv_lr(instream);
+  LazyReader csv_reader(csv_lr, ',', true);
+
+  EXPECT_EQ((std::vector<std::string>{"h1", "h2"}), csv_reader.get_header_names().to_vector());
+
+  auto& row = csv_reader.read();
+  ASSERT_EQ(2u, row.size());
+  EXPECT_EQ("\"a\"", row[0]);
+  EXPECT_EQ("b", row[1]);
+  EXPECT_EQ(false, csv_reader.good());
+}
+
+TEST(LazyRowTest, ParseIntoReusesRow) {
+  csvio::util::LazyRow<> row;
+  csvio::util::DelimSplitLazy<>::parse_into(row, "\"x,y\",z", ',');
+  ASSERT_EQ(2u, row.size());
+  EXPECT_EQ("x,y", row[0]);
+
+  // a field cached from the previous line must not leak into the next one
+  csvio::util::DelimSplitLazy<>::parse_into(row, "\"\"\"q\"\"\",w,v", ',');
+  ASSERT_EQ(3u, row.size());
+  EXPECT_EQ("\"q\"", row[0]);
+  EXPECT_EQ("w", row[1]);
+  EXPECT_EQ("v", row[2]);
+}
+
+TEST(LazyRowTest, ReadWholeFile) {
+  std::ifstream infile("data/test_data.csv");
+  csvio::util::CSVLineReader csv_lr(infile);
+  LazyReader csv_reader(csv_lr, ',', true);
+
+  std::vector<std::string> expected{"100", "Henry", "59", "Zuzabuner", "YELLOW", "11/09/2017"};
+  std::vector<std::string> row;
+  while (csv_reader.good()) { row = csv_reader.read().to_vector(); }
+
+  EXPECT_EQ(expected, row);
+  EXPECT_EQ(101u, csv_reader.lcount());
+}
+
+}  // namespace
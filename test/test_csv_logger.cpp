@@ -0,0 +1,192 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Matthew Guidry
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "csvio/csvio.hpp"
+#include "csvio/logger.hpp"
+#include "gtest/gtest.h"
+
+namespace {
+
+std::vector<std::vector<std::string>> read_rows(const std::string& data) {
+  std::istringstream instream(data);
+  csvio::util::CSVLineReader csv_lr(instream);
+  csvio::CSVReader csv_reader(csv_lr);
+  std::vector<std::vector<std::string>> rows;
+  while (csv_reader.good()) {
+    auto row = csv_reader.read();
+    if (row.size() > 1) { rows.push_back(row); }
+  }
+  return rows;
+}
+
+std::string read_file(const std::string& path) {
+  std::ifstream infile(path, std::ios::binary);
+  std::ostringstream contents;
+  contents << infile.rdbuf();
+  return contents.str();
+}
+
+TEST(TimestampCacheTest, Format) {
+  csvio::util::TimestampCache cache;
+  const auto now = std::chrono::system_clock::now();
+  const auto first = std::string(cache.format(now));
+  ASSERT_EQ(csvio::util::TimestampCache::length, first.size());
+  EXPECT_EQ('-', first[4]);
+  EXPECT_EQ(' ', first[10]);
+  EXPECT_EQ('.', first[19]);
+
+  const auto later = std::string(cache.format(now + std::chrono::microseconds(1)));
+  EXPECT_EQ(first.substr(0, 19), later.substr(0, 19));
+  EXPECT_NE(first, later);
+}
+
+TEST(CSVLoggerTest, LogMessages) {
+  std::ostringstream outstream;
+  csvio::util::CSVLineWriter csv_lw(outstream);
+  csvio::CSVLogger logger(csv_lw);
+
+  CSVIO_LOG_INFO(logger) << "value, \"quoted\" " << 42 << ' ' << 1.5 << ' ' << true;
+  logger.log(csvio::LOG_ERROR, "handler", "plain");
+  logger.flush();
+
+  const auto rows = read_rows(outstream.str());
+  ASSERT_EQ(3u, rows.size());
+  EXPECT_EQ((std::vector<std::string>{"TIME", "LEVEL", "FUNC", "MESSAGE"}), rows[0]);
+  EXPECT_EQ(csvio::util::TimestampCache::length, rows[1][0].size());
+  EXPECT_EQ("INFO", rows[1][1]);
+  EXPECT_EQ("TestBody", rows[1][2]);
+  EXPECT_EQ("value, \"quoted\" 42 1.5 true", rows[1][3]);
+  EXPECT_EQ("ERROR", rows[2][1]);
+  EXPECT_EQ("handler", rows[2][2]);
+  EXPECT_EQ("plain", rows[2][3]);
+  EXPECT_EQ(3u, logger.lcount());
+}
+
+TEST(CSVLoggerTest, LevelFilter) {
+  std::ostringstream outstream;
+  csvio::util::CSVLineWriter csv_lw(outstream);
+  csvio::CSVLogger logger(csv_lw, csvio::LOG_WARN);
+
+  logger.debug() << "hidden";
+  logger.info() << "hidden";
+  logger.warn() << "shown";
+  EXPECT_FALSE(logger.log(csvio::LOG_DEBUG, "", "hidden"));
+  logger.set_level(csvio::LOG_DEBUG);
+  logger.debug() << "shown";
+  logger.close();
+
+  const auto rows = read_rows(outstream.str());
+  ASSERT_EQ(3u, rows.size());
+  EXPECT_EQ("WARN", rows[1][1]);
+  EXPECT_EQ("DEBUG", rows[2][1]);
+}
+
+TEST(CSVLoggerTest, ManyThreads) {
+  const int threads{4};
+  const int messages{1000};
+  std::ostringstream outstream;
+  csvio::util::CSVLineWriter csv_lw(outstream);
+  {
+    csvio::CSVLogger logger(csv_lw);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+      workers.emplace_back([&logger, t] {
+        for (int i = 0; i < messages; i++) { logger.info("worker") << t << ':' << i; }
+      });
+    }
+    for (auto& worker : workers) { worker.join(); }
+  }
+  EXPECT_EQ(static_cast<std::size_t>(threads * messages + 1), read_rows(outstream.str()).size());
+}
+
+TEST(CSVLoggerTest, Rotation) {
+  const std::string path{"data/CSV_LOGGER_TEST_001.csv"};
+  {
+    csvio::util::RotatingFileLineWriter line_writer(path, 256, 2);
+    csvio::CSVLogger<csvio::util::RotatingFileLineWriter> logger(line_writer);
+    for (int i = 0; i < 40; i++) {
+      logger.info("rotation") << "message " << i;
+      logger.flush();
+    }
+    logger.close();
+    line_writer.flush();
+    EXPECT_GT(line_writer.rotations(), 2u);
+
+    for (const auto& file : {path, line_writer.rotated_path(1), line_writer.rotated_path(2)}) {
+      const auto contents = read_file(file);
+      EXPECT_LE(contents.size(), 256u);
+      EXPECT_EQ(0u, contents.find("TIME,LEVEL,FUNC,MESSAGE\r\n"));
+    }
+    const auto newest = read_rows(read_file(path));
+    EXPECT_EQ("message 39", newest.back()[3]);
+    EXPECT_TRUE(read_file(line_writer.rotated_path(3)).empty());
+
+    std::remove(path.c_str());
+    std::remove(line_writer.rotated_path(1).c_str());
+    std::remove(line_writer.rotated_path(2).c_str());
+  }
+}
+
+TEST(CSVLoggerTest, RotationBetweenBatchedLines) {
+  const std::string path{"data/CSV_LOGGER_TEST_002.csv"};
+  {
+    csvio::util::RotatingFileLineWriter line_writer(path, 256, 0);
+    csvio::CSVLogger<csvio::util::RotatingFileLineWriter> logger(line_writer);
+    // without a flush per message the background thread hands over whole batches
+    for (int i = 0; i < 40; i++) { logger.info("rotation") << "message " << i; }
+    logger.close();
+    line_writer.flush();
+    EXPECT_EQ(41u, line_writer.lcount());
+    EXPECT_GT(line_writer.rotations(), 2u);
+    EXPECT_LE(read_file(path).size(), 256u);
+    std::remove(path.c_str());
+  }
+}
+
+TEST(RotatingFileLineWriterTest, WritelinesSplitsOnLineBoundaries) {
+  const std::string path{"data/CSV_ROTATING_TEST_001.csv"};
+  {
+    csvio::util::RotatingFileLineWriter line_writer(path, 16, 1);
+    line_writer.writelines("a,b\n", 1);
+    line_writer.writelines("1,\"x\ny\"\n2,two\n3,three\n", 3);
+    line_writer.flush();
+    EXPECT_EQ(4u, line_writer.lcount());
+    EXPECT_EQ(1u, line_writer.rotations());
+    EXPECT_EQ("a,b\n1,\"x\ny\"\n", read_file(line_writer.rotated_path(1)));
+    EXPECT_EQ("2,two\n3,three\n", read_file(path));
+    std::remove(path.c_str());
+    std::remove(line_writer.rotated_path(1).c_str());
+  }
+}
+
+}  // namespace
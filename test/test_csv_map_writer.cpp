@@ -0,0 +1,97 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Matthew Guidry
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <map>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "csvio/csvio.hpp"
+#include "gtest/gtest.h"
+
+namespace {
+
+TEST(CSVMapWriterTest, WriteInHeaderOrder) {
+  std::ostringstream outstream;
+  csvio::util::CSVLineWriter csv_lw(outstream);
+  csvio::CSVMapWriter csv_map_writer(csv_lw, {"c", "a", "b"});
+
+  EXPECT_TRUE(csv_map_writer.write({{"a", "1"}, {"b", "x,y"}, {"c", "3"}}));
+  EXPECT_TRUE(csv_map_writer.write({{"a", "4"}, {"b", "5"}, {"c", "6"}}));
+  EXPECT_EQ("c,a,b\r\n3,1,\"x,y\"\r\n6,4,5\r\n", outstream.str());
+  EXPECT_EQ(3u, csv_map_writer.lcount());
+  EXPECT_TRUE(csv_map_writer.good());
+}
+
+TEST(CSVMapWriterTest, UnorderedMapRows) {
+  std::ostringstream outstream;
+  csvio::util::CSVLineWriter csv_lw(outstream);
+  csvio::CSVMapWriter<std::unordered_map> csv_map_writer(csv_lw, {"id", "name", "score"}, ';');
+
+  for (int i = 0; i < 20; i++) {
+    std::unordered_map<std::string, std::string> row{{"score", std::to_string(i * 2)},
+                                                     {"id", std::to_string(i)},
+                                                     {"name", "n;" + std::to_string(i)}};
+    if (i % 5 == 0) { row.rehash(64); }
+    EXPECT_TRUE(csv_map_writer.write(row));
+  }
+
+  std::istringstream instream(outstream.str());
+  csvio::util::CSVLineReader csv_lr(instream);
+  csvio::CSVMapReader<std::map> csv_map_reader(csv_lr, ';');
+  EXPECT_EQ((std::vector<std::string>{"id", "name", "score"}), csv_map_reader.get_header_names());
+  for (int i = 0; i < 20; i++) {
+    std::map<std::string, std::string> expected{{"id", std::to_string(i)},
+                                                {"name", "n;" + std::to_string(i)},
+                                                {"score", std::to_string(i * 2)}};
+    EXPECT_EQ(expected, csv_map_reader.read());
+  }
+}
+
+TEST(CSVMapWriterTest, MissingAndExtraKeys) {
+  std::ostringstream outstream;
+  csvio::util::CSVLineWriter csv_lw(outstream);
+  csvio::util::MapKeyPolicy policy{csvio::util::MapKeyPolicy::IGNORE,
+                                   csvio::util::MapKeyPolicy::IGNORE};
+  csvio::CSVMapWriter csv_map_writer(csv_lw, {"a", "b", "c"}, ',', "\n", policy);
+
+  EXPECT_TRUE(csv_map_writer.write({{"a", "1"}, {"c", "3"}}));
+  EXPECT_TRUE(csv_map_writer.write({{"a", "1"}, {"b", "2"}, {"c", "3"}, {"d", "4"}}));
+
+  policy.missing = csvio::util::MapKeyPolicy::SKIP_ROW;
+  csv_map_writer.set_key_policy(policy);
+  EXPECT_FALSE(csv_map_writer.write({{"a", "1"}}));
+  EXPECT_TRUE(csv_map_writer.write({{"a", "5"}, {"b", "6"}, {"c", "7"}}));
+
+  policy.extra = csvio::util::MapKeyPolicy::SKIP_ROW;
+  csv_map_writer.set_key_policy(policy);
+  EXPECT_FALSE(csv_map_writer.write({{"a", "1"}, {"b", "2"}, {"c", "3"}, {"z", "4"}}));
+
+  EXPECT_EQ("a,b,c\n1,,3\n1,2,3\n5,6,7\n", outstream.str());
+  EXPECT_EQ(csvio::util::MapKeyPolicy::SKIP_ROW, csv_map_writer.get_key_policy().extra);
+}
+
+}  // namespace
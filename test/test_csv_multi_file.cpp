@@ -0,0 +1,121 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Matthew Guidry
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "csvio/multi_file.hpp"
+#include "gtest/gtest.h"
+
+namespace {
+
+std::vector<std::string> write_files(const std::string& prefix,
+                                     const std::vector<std::string>& contents) {
+  std::vector<std::string> paths;
+  for (std::size_t i = 0; i < contents.size(); i++) {
+    paths.push_back("data/CSV_MULTI_FILE_" + prefix + "_" + std::to_string(i) + ".csv");
+    std::ofstream file(paths.back(), std::ios::binary);
+    file << contents[i];
+  }
+  return paths;
+}
+
+void remove_files(const std::vector<std::string>& paths) {
+  for (const auto& path : paths) { std::remove(path.c_str()); }
+}
+
+std::vector<std::vector<std::string>> read_all(csvio::util::MultiFileLineReader& csv_lr) {
+  csvio::CSVReader<std::vector, csvio::util::MultiFileLineReader> reader(csv_lr, ',', true);
+  std::vector<std::vector<std::string>> rows{reader.get_header_names()};
+  while (reader.good()) { rows.push_back(reader.read()); }
+  return rows;
+}
+
+TEST(MultiFileLineReaderTest, SkipsRepeatedHeaders) {
+  const auto paths = write_files("001", {"a,b\n1,x\n2,\"y\ny\"\n", "a,b\r\n3,z\r\n",
+                                         "a,b\n", "", "a,b\n4,w"});
+  csvio::util::MultiFileLineReader csv_lr(paths, true, 4);
+  const auto rows = read_all(csv_lr);
+  const std::vector<std::vector<std::string>> expected{
+      {"a", "b"}, {"1", "x"}, {"2", "y\ny"}, {"3", "z"}, {"4", "w"}};
+  EXPECT_EQ(expected, rows);
+  EXPECT_EQ(5u, csv_lr.lcount());
+  EXPECT_EQ(paths.size(), csv_lr.file_index());
+  remove_files(paths);
+}
+
+TEST(MultiFileLineReaderTest, HeaderOnlyFirstFile) {
+  const auto paths = write_files("002", {"a,b\n", "a,b\n1,2\n"});
+  csvio::util::MultiFileLineReader csv_lr(paths);
+  const std::vector<std::vector<std::string>> expected{{"a", "b"}, {"1", "2"}};
+  EXPECT_EQ(expected, read_all(csv_lr));
+  remove_files(paths);
+}
+
+TEST(MultiFileLineReaderTest, WithoutHeader) {
+  const auto paths = write_files("003", {"1\n2\n", "3\n"});
+  csvio::util::MultiFileLineReader csv_lr(paths, false);
+  std::vector<std::string> lines;
+  while (csv_lr.good()) { lines.push_back(csv_lr.readline()); }
+  EXPECT_EQ(std::vector<std::string>({"1\n", "2\n", "3\n"}), lines);
+  remove_files(paths);
+}
+
+TEST(MultiFileLineReaderTest, MismatchedHeaderThrows) {
+  const auto paths = write_files("004", {"a,b\n1,2\n", "a,c\n3,4\n"});
+  csvio::util::MultiFileLineReader csv_lr(paths);
+  EXPECT_EQ("a,b\n", csv_lr.readline());
+  EXPECT_THROW(csv_lr.readline(), std::runtime_error);
+  remove_files(paths);
+}
+
+TEST(MultiFileLineReaderTest, MismatchedSecondFileThrowsOnConstruction) {
+  const auto paths = write_files("007", {"a,b\n", "a,c\n3,4\n"});
+  EXPECT_THROW(csvio::util::MultiFileLineReader csv_lr(paths), std::runtime_error);
+  remove_files(paths);
+}
+
+TEST(MultiFileLineReaderTest, MissingFilesAreSkipped) {
+  auto paths = write_files("005", {"a\n1\n"});
+  paths.insert(paths.begin(), "data/CSV_MULTI_FILE_MISSING.csv");
+  csvio::util::MultiFileLineReader csv_lr(paths);
+  EXPECT_EQ("data/CSV_MULTI_FILE_005_0.csv", csv_lr.current_path());
+  const std::vector<std::vector<std::string>> expected{{"a"}, {"1"}};
+  EXPECT_EQ(expected, read_all(csv_lr));
+  EXPECT_TRUE(csv_lr.current_path().empty());
+  remove_files(paths);
+}
+
+TEST(MultiFileLineReaderTest, GlobFilesSorted) {
+  const auto paths = write_files("006", {"a\n", "a\n", "a\n"});
+  EXPECT_EQ(paths, csvio::util::glob_files("data/CSV_MULTI_FILE_006_*.csv"));
+  EXPECT_TRUE(csvio::util::glob_files("data/CSV_MULTI_FILE_NONE_*.csv").empty());
+  remove_files(paths);
+}
+
+}  // namespace
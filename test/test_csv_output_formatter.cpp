@@ -185,4 +185,29 @@ TEST(CSVOutputFormatterTest, JoinSampleListInFieldDelimiterEscapedToStringEscape
       formatter(to_join, ',', "\r\n"));
 }
 
-}  // namespace
\ No newline at end of file
+TEST(CSVOutputFormatterTest, JoinSampleVectorAltDelimiterEscaped) {
+  std::vector<std::string> to_join{"a|b", "c,d", "e"};
+  std::string expected{"\"a|b\"|c,d|e\r\n"};
+  csvutil::DelimJoinEscapedFormat<std::vector> formatter;
+
+  EXPECT_EQ(expected, formatter(to_join, '|', "\r\n"));
+}
+
+TEST(CSVOutputFormatterTest, JoinStringViewVectorEscapedAndUnescaped) {
+  std::vector<std::string_view> to_join{"a", "b,c", "d"};
+  csvutil::DelimJoinEscapedFormat<std::vector> escaped;
+  csvutil::DelimJoinUnescapedFormat<std::vector> unescaped;
+
+  EXPECT_EQ("a,\"b,c\",d\r\n", escaped(to_join, ',', "\r\n"));
+  EXPECT_EQ("a,b,c,d\r\n", unescaped(to_join, ',', "\r\n"));
+}
+
+TEST(CSVOutputFormatterTest, JoinVectorWithColumnEscapePolicy) {
+  std::vector<std::string> to_join{"1,5", "a", "b\"c", "d,e"};
+  csvutil::DelimJoinEscapedFormat<std::vector> formatter;
+  formatter.set_column_escape({csvutil::NEVER, csvutil::ALWAYS, csvutil::ALWAYS});
+
+  EXPECT_EQ("1,5,\"a\",\"b\"\"c\",\"d,e\"\r\n", formatter(to_join, ',', "\r\n"));
+}
+
+}  // namespace
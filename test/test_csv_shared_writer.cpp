@@ -0,0 +1,194 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Matthew Guidry
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "csvio/csvio.hpp"
+#include "gtest/gtest.h"
+
+namespace {
+
+std::vector<std::string> split_lines(const std::string& data) {
+  std::vector<std::string> lines;
+  std::istringstream instream(data);
+  std::string line;
+  while (std::getline(instream, line)) { lines.push_back(line); }
+  return lines;
+}
+
+TEST(CSVSharedWriterTest, SingleThread) {
+  std::ostringstream outstream;
+  csvio::util::CSVLineWriter csv_lw(outstream);
+  csvio::CSVSharedWriter csv_writer(csv_lw);
+
+  csv_writer.write_header({"a", "b"});
+  {
+    auto local = csv_writer.local();
+    local.write({"1", "x,y"});
+    local.write({"2", "z"});
+    EXPECT_EQ("a,b\r\n", outstream.str());
+    EXPECT_GT(local.buffered(), 0u);
+  }
+  EXPECT_EQ("a,b\r\n1,\"x,y\"\r\n2,z\r\n", outstream.str());
+  EXPECT_EQ(3u, csv_writer.lcount());
+  EXPECT_TRUE(csv_writer.good());
+}
+
+TEST(CSVSharedWriterTest, UnorderedManyThreads) {
+  const int threads{4};
+  const int rows{5000};
+  std::ostringstream outstream;
+  csvio::util::CSVLineWriter csv_lw(outstream);
+  csvio::CSVSharedWriter csv_writer(csv_lw, ',', true, "\n", 256);
+
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; t++) {
+    workers.emplace_back([&csv_writer, t] {
+      auto local = csv_writer.local();
+      for (int i = 0; i < rows; i++) {
+        local.write({std::to_string(t), std::to_string(i), "padding padding"});
+      }
+    });
+  }
+  for (auto& worker : workers) { worker.join(); }
+
+  EXPECT_EQ(static_cast<std::size_t>(threads * rows), csv_writer.lcount());
+  std::vector<int> next(threads, 0);
+  for (const auto& line : split_lines(outstream.str())) {
+    const auto first = line.find(',');
+    const auto second = line.find(',', first + 1);
+    const auto thread = static_cast<std::size_t>(std::stoi(line.substr(0, first)));
+    EXPECT_EQ(next[thread]++, std::stoi(line.substr(first + 1, second - first - 1)));
+    EXPECT_EQ("padding padding", line.substr(second + 1));
+  }
+}
+
+TEST(CSVSharedWriterTest, OrderedManyThreads) {
+  const int threads{4};
+  const int chunks{200};
+  std::ostringstream outstream;
+  csvio::util::CSVLineWriter csv_lw(outstream);
+  csvio::CSVSharedWriter csv_writer(csv_lw, ',', true, "\n", 0);
+
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; t++) {
+    workers.emplace_back([&csv_writer, t] {
+      auto local = csv_writer.local();
+      for (int chunk = t; chunk < chunks; chunk += threads) {
+        for (int i = 0; i < 3; i++) { local.write({std::to_string(chunk * 3 + i)}); }
+        local.commit(static_cast<std::uint64_t>(chunk));
+      }
+    });
+  }
+  for (auto& worker : workers) { worker.join(); }
+
+  EXPECT_EQ(static_cast<std::uint64_t>(chunks), csv_writer.next_sequence());
+  const auto lines = split_lines(outstream.str());
+  ASSERT_EQ(static_cast<std::size_t>(chunks * 3), lines.size());
+  for (std::size_t i = 0; i < lines.size(); i++) { EXPECT_EQ(std::to_string(i), lines[i]); }
+}
+
+TEST(CSVSharedWriterTest, OrderedOutOfOrderCommits) {
+  std::ostringstream outstream;
+  csvio::util::CSVLineWriter csv_lw(outstream);
+  csvio::CSVSharedWriter csv_writer(csv_lw, ',', true, "\n", 0);
+
+  auto local = csv_writer.local();
+  local.write({"c"});
+  local.commit(2);
+  local.write({"b"});
+  local.commit(1);
+  EXPECT_EQ("", outstream.str());
+  EXPECT_EQ(0u, csv_writer.next_sequence());
+
+  local.commit(0);
+  EXPECT_EQ("b\nc\n", outstream.str());
+  EXPECT_EQ(3u, csv_writer.next_sequence());
+  EXPECT_EQ(2u, csv_writer.lcount());
+}
+
+TEST(CSVSharedWriterTest, OrderedLocalDropsUncommittedRows) {
+  std::ostringstream outstream;
+  csvio::util::CSVLineWriter csv_lw(outstream);
+  csvio::CSVSharedWriter csv_writer(csv_lw, ',', true, "\n", 0);
+
+  {
+    auto local = csv_writer.local();
+    local.write({"b"});
+    local.commit(1);
+    local.write({"stray"});
+  }
+  // the stray row has no sequence, appending it would put it ahead of sequence 0
+  EXPECT_EQ("", outstream.str());
+
+  auto local = csv_writer.local();
+  local.write({"a"});
+  local.commit(0);
+  EXPECT_EQ("a\nb\n", outstream.str());
+  EXPECT_EQ(2u, csv_writer.lcount());
+}
+
+TEST(CSVSharedWriterTest, ChunksCountRowsOnLineWriter) {
+  std::ostringstream outstream;
+  csvio::util::CSVLineWriter csv_lw(outstream);
+  {
+    csvio::CSVSharedWriter csv_writer(csv_lw, ',', true, "\n", 16);
+    csv_writer.write_header({"a", "b"});
+    auto local = csv_writer.local();
+    for (int i = 0; i < 100; i++) { local.write({std::to_string(i), "value"}); }
+  }
+  EXPECT_EQ(101u, csv_lw.lcount());
+}
+
+TEST(CSVSharedWriterTest, SequencedLocalNeverAutoCommits) {
+  std::ostringstream outstream;
+  csvio::util::CSVLineWriter csv_lw(outstream);
+  csvio::CSVSharedWriter csv_writer(csv_lw, ',', true, "\n", 8);
+
+  auto local = csv_writer.local();
+  local.write({"a"});
+  local.commit(0);
+  for (int i = 0; i < 10; i++) { local.write({"row", std::to_string(i)}); }
+  EXPECT_EQ("a\n", outstream.str());
+  local.commit(1);
+  EXPECT_EQ(11u, csv_writer.lcount());
+}
+
+TEST(CSVSharedWriterTest, SequencedCommitAfterAutoCommitThrows) {
+  std::ostringstream outstream;
+  csvio::util::CSVLineWriter csv_lw(outstream);
+  csvio::CSVSharedWriter csv_writer(csv_lw, ',', true, "\n", 8);
+
+  auto local = csv_writer.local();
+  for (int i = 0; i < 10; i++) { local.write({"row", std::to_string(i)}); }
+  EXPECT_GT(csv_writer.lcount(), 0u);
+  EXPECT_THROW(local.commit(0), std::logic_error);
+}
+
+}  // namespace
@@ -0,0 +1,114 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Matthew Guidry
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "csvio/snapshot.hpp"
+#include "gtest/gtest.h"
+
+namespace {
+
+std::vector<std::vector<std::string>> read_all(csvio::CSVSnapshotReader& reader) {
+  std::vector<std::vector<std::string>> rows;
+  while (reader.good()) { rows.push_back(reader.read().to_vector()); }
+  return rows;
+}
+
+TEST(CSVSnapshotTest, RoundTripsParsedCsv) {
+  const std::string path{"data/CSV_SNAPSHOT_TEST_001.bin"};
+  std::istringstream instream("a,b,c\n1,\"x, \"\"y\"\"\",\n\n2,\"multi\nline\",z\n3\n");
+  csvio::util::CSVLineReader csv_lr(instream);
+  ASSERT_TRUE(csvio::write_snapshot(csv_lr, path));
+
+  csvio::CSVSnapshotReader reader(path);
+  ASSERT_TRUE(reader.is_open());
+  EXPECT_EQ(std::vector<std::string>({"a", "b", "c"}), reader.get_header_names().to_vector());
+  EXPECT_EQ(4u, reader.rows());
+  const std::vector<std::vector<std::string>> expected{
+      {"1", "x, \"y\"", ""}, {"2", "multi\nline", "z"}, {"3"}};
+  EXPECT_EQ(expected, read_all(reader));
+  EXPECT_EQ(3u, reader.lcount());
+  EXPECT_EQ("multi\nline", reader.row(2)[1]);
+  EXPECT_EQ("3", reader.current()[0]);
+  EXPECT_THROW(reader.current().at(1), std::out_of_range);
+  std::remove(path.c_str());
+}
+
+TEST(CSVSnapshotTest, WriterWithoutHeader) {
+  const std::string path{"data/CSV_SNAPSHOT_TEST_002.bin"};
+  {
+    csvio::CSVSnapshotWriter writer(path);
+    writer.write(std::vector<std::string>{"x", "y"});
+    writer.write(std::vector<std::string>{});
+    writer.write(std::vector<csvio::string_view>{"zz"});
+    EXPECT_EQ(3u, writer.lcount());
+  }
+  csvio::CSVSnapshotReader reader(path);
+  ASSERT_TRUE(reader.is_open());
+  EXPECT_TRUE(reader.get_header_names().empty());
+  const std::vector<std::vector<std::string>> expected{{"x", "y"}, {}, {"zz"}};
+  EXPECT_EQ(expected, read_all(reader));
+  std::remove(path.c_str());
+}
+
+TEST(CSVSnapshotTest, EmptySnapshot) {
+  const std::string path{"data/CSV_SNAPSHOT_TEST_003.bin"};
+  EXPECT_TRUE(csvio::CSVSnapshotWriter(path).close());
+  csvio::CSVSnapshotReader reader(path);
+  EXPECT_TRUE(reader.is_open());
+  EXPECT_FALSE(reader.good());
+  EXPECT_EQ(0u, reader.rows());
+  std::remove(path.c_str());
+}
+
+TEST(CSVSnapshotTest, MissingOrTruncatedIsNotOpen) {
+  EXPECT_FALSE(csvio::CSVSnapshotReader("data/CSV_SNAPSHOT_MISSING.bin").is_open());
+
+  const std::string path{"data/CSV_SNAPSHOT_TEST_004.bin"};
+  {
+    csvio::CSVSnapshotWriter writer(path);
+    writer.write_header(std::vector<std::string>{"a"});
+    writer.write(std::vector<std::string>{"1"});
+  }
+  std::string contents;
+  {
+    std::ifstream file(path, std::ios::binary);
+    contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  }
+  {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(contents.data(), static_cast<std::streamsize>(contents.size() - 8));
+  }
+  csvio::CSVSnapshotReader reader(path);
+  EXPECT_FALSE(reader.is_open());
+  EXPECT_FALSE(reader.good());
+  std::remove(path.c_str());
+}
+
+}  // namespace
@@ -0,0 +1,168 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Matthew Guidry
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "csvio/sort.hpp"
+#include "gtest/gtest.h"
+
+namespace {
+
+using Sorter = csvio::CSVSorter<>;
+
+std::string sort_csv(const std::string& input, const std::function<void(Sorter&)>& setup) {
+  std::istringstream instream(input);
+  std::ostringstream outstream;
+  csvio::util::CSVLineReader csv_lr(instream);
+  csvio::util::CSVLineWriter csv_lw(outstream);
+  Sorter sorter(csv_lr, csv_lw, ',', true, true, "\n");
+  setup(sorter);
+  sorter.run();
+  return outstream.str();
+}
+
+TEST(CSVSorterTest, StringKeyKeepsHeaderAndQuotedNewlines) {
+  const std::string input{"name,note\nzed,\"two\nlines\"\nadam,\"a, b\"\n\nmia,x\n"};
+  const auto output = sort_csv(input, [](Sorter& sorter) { sorter.add_key("name"); });
+  EXPECT_EQ("name,note\nadam,\"a, b\"\nmia,x\nzed,\"two\nlines\"\n", output);
+}
+
+TEST(CSVSorterTest, NumericKeyDescending) {
+  const std::string input{"v\n10\n9\n\"100\"\n-1.5\n"};
+  const auto output =
+      sort_csv(input, [](Sorter& sorter) { sorter.add_key("v", csvio::NUMERIC, true); });
+  EXPECT_EQ("v\n\"100\"\n10\n9\n-1.5\n", output);
+}
+
+TEST(CSVSorterTest, NumericKeyInvalidFirst) {
+  const std::string input{"v\n2\nn/a\n1\n\n"};
+  const auto output = sort_csv(input, [](Sorter& sorter) { sorter.add_key(0, csvio::NUMERIC); });
+  EXPECT_EQ("v\nn/a\n1\n2\n", output);
+}
+
+TEST(CSVSorterTest, DateKeys) {
+  const std::string input{"d\n08/08/1962\n2/3/2001\n1999-12-31\n"};
+  const auto output = sort_csv(input, [](Sorter& sorter) { sorter.add_key("d", csvio::DATE); });
+  EXPECT_EQ("d\n08/08/1962\n1999-12-31\n2/3/2001\n", output);
+}
+
+TEST(CSVSorterTest, SeveralKeysAreStable) {
+  const std::string input{"g,v,id\nb,2,1\na,2,2\nb,1,3\na,2,4\n"};
+  const auto output = sort_csv(input, [](Sorter& sorter) {
+    sorter.add_key("g");
+    sorter.add_key("v", csvio::NUMERIC);
+  });
+  EXPECT_EQ("g,v,id\na,2,2\na,2,4\nb,1,3\nb,2,1\n", output);
+}
+
+// sort 20000 random numeric keys with little memory, compare against std::stable_sort
+void expect_spilled_sort(std::size_t fan_in, std::size_t min_runs) {
+  std::mt19937 random(42);
+  std::string input{"key,payload\n"};
+  std::vector<std::pair<long, int>> expected;
+  for (int i = 0; i < 20000; i++) {
+    const long key = static_cast<long>(random() % 5000);
+    input += std::to_string(key) + ",\"row " + std::to_string(i) + "\"\n";
+    expected.emplace_back(key, i);
+  }
+  std::stable_sort(expected.begin(), expected.end(),
+                   [](const auto& a, const auto& b) { return a.first < b.first; });
+
+  std::istringstream instream(input);
+  std::ostringstream outstream;
+  csvio::util::CSVLineReader csv_lr(instream);
+  csvio::util::CSVLineWriter csv_lw(outstream);
+  Sorter sorter(csv_lr, csv_lw, ',', true, true, "\n");
+  sorter.add_key("key", csvio::NUMERIC);
+  sorter.set_memory_limit(64 * 1024);
+  sorter.set_merge_fan_in(fan_in);
+  sorter.set_threads(4);
+  EXPECT_EQ(expected.size(), sorter.run());
+  EXPECT_LT(min_runs, sorter.spilled_runs());
+
+  std::string reference{"key,payload\n"};
+  for (const auto& [key, i] : expected) {
+    reference += std::to_string(key) + ",\"row " + std::to_string(i) + "\"\n";
+  }
+  EXPECT_EQ(reference, outstream.str());
+  EXPECT_EQ(expected.size() + 1, sorter.lcount());
+}
+
+TEST(CSVSorterTest, SpilledRunsMatchInMemorySort) {
+  expect_spilled_sort(csvio::util::default_merge_fan_in, 1);
+}
+
+TEST(CSVSorterTest, MoreRunsThanMergeFanIn) {
+  // runs are merged in several generations and passes, which must keep the sort stable
+  for (std::size_t fan_in : {2u, 3u, 5u}) { expect_spilled_sort(fan_in, fan_in); }
+}
+
+TEST(CSVSorterTest, SortFileByCity) {
+  std::ifstream infile("data/test_data.csv");
+  std::ostringstream outstream;
+  csvio::util::CSVLineReader csv_lr(infile);
+  csvio::util::CSVLineWriter csv_lw(outstream);
+  Sorter sorter(csv_lr, csv_lw);
+  sorter.add_key("city");
+  EXPECT_EQ(100u, sorter.run());
+
+  std::istringstream instream(outstream.str());
+  csvio::util::CSVLineReader out_lr(instream);
+  csvio::CSVReader<> out_reader(out_lr, ',', true);
+  std::vector<std::string> cities;
+  while (out_reader.good()) {
+    const auto& row = out_reader.read();
+    if (row.size() > 3) { cities.push_back(row[3]); }
+  }
+  EXPECT_EQ(100u, cities.size());
+  EXPECT_TRUE(std::is_sorted(cities.begin(), cities.end()));
+}
+
+TEST(LoserTreeTest, MergesSortedSources) {
+  const std::vector<std::vector<int>> sources{{1, 4, 9}, {}, {2, 3, 10, 11}, {0, 5}};
+  std::vector<std::size_t> positions(sources.size(), 0);
+  const auto less = [&](std::size_t a, std::size_t b) {
+    const bool a_done = positions[a] == sources[a].size();
+    const bool b_done = positions[b] == sources[b].size();
+    if (a_done || b_done) { return !a_done && b_done; }
+    return sources[a][positions[a]] < sources[b][positions[b]];
+  };
+
+  csvio::util::LoserTree<decltype(less)> tree(sources.size(), less);
+  std::vector<int> merged;
+  while (positions[tree.top()] != sources[tree.top()].size()) {
+    merged.push_back(sources[tree.top()][positions[tree.top()]++]);
+    tree.replay();
+  }
+  EXPECT_EQ((std::vector<int>{0, 1, 2, 3, 4, 5, 9, 10, 11}), merged);
+}
+
+}  // namespace
@@ -0,0 +1,196 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Matthew Guidry
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <memory>
+#include <random>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "csvio/split.hpp"
+#include "gtest/gtest.h"
+
+namespace {
+
+struct Shards {
+  std::vector<std::unique_ptr<std::ostringstream>> streams;
+
+  std::string operator[](std::size_t shard) const { return streams[shard]->str(); }
+};
+
+template <typename LineWriter = csvio::util::CSVLineWriter>
+std::size_t split_csv(const std::string& input, Shards& shards, csvio::SplitMode mode,
+                      std::size_t count, unsigned threads = 1,
+                      const std::vector<std::string>& keys = {}) {
+  std::istringstream instream(input);
+  csvio::util::CSVLineReader csv_lr(instream);
+  csvio::CSVSplitter<csvio::util::CSVLineReader, LineWriter> splitter(
+      csv_lr,
+      [&shards](std::size_t) {
+        shards.streams.push_back(std::make_unique<std::ostringstream>());
+        return std::make_unique<LineWriter>(*shards.streams.back());
+      },
+      mode, count, ',', true, true, "\n");
+  for (const auto& key : keys) { splitter.add_key(key); }
+  splitter.set_threads(threads);
+  const auto rows = splitter.run();
+  EXPECT_EQ(shards.streams.size(), splitter.shards());
+  return rows;
+}
+
+TEST(CSVSplitterTest, RoundRobin) {
+  Shards shards;
+  EXPECT_EQ(5u, split_csv("a,b\n1,x\n2,y\n\n3,\"z\nz\"\r\n4,w\n5,v\n", shards,
+                          csvio::ROUND_ROBIN, 3));
+  ASSERT_EQ(3u, shards.streams.size());
+  EXPECT_EQ("a,b\n1,x\n4,w\n", shards[0]);
+  EXPECT_EQ("a,b\n2,y\n5,v\n", shards[1]);
+  EXPECT_EQ("a,b\n3,\"z\nz\"\n", shards[2]);
+}
+
+TEST(CSVSplitterTest, RoundRobinCreatesEmptyShards) {
+  Shards shards;
+  EXPECT_EQ(1u, split_csv("a\n1\n", shards, csvio::ROUND_ROBIN, 3));
+  ASSERT_EQ(3u, shards.streams.size());
+  EXPECT_EQ("a\n", shards[2]);
+}
+
+TEST(CSVSplitterTest, RowLimit) {
+  Shards shards;
+  EXPECT_EQ(5u, split_csv("a\n1\n2\n3\n4\n5\n", shards, csvio::ROW_LIMIT, 2));
+  ASSERT_EQ(3u, shards.streams.size());
+  EXPECT_EQ("a\n1\n2\n", shards[0]);
+  EXPECT_EQ("a\n3\n4\n", shards[1]);
+  EXPECT_EQ("a\n5\n", shards[2]);
+}
+
+TEST(CSVSplitterTest, HashKeepsEqualKeysTogether) {
+  std::string input{"id,key\n"};
+  for (int i = 0; i < 1000; i++) {
+    const auto key = std::to_string(i % 37);
+    input += std::to_string(i) + "," + (i % 2 == 0 ? key : "\"" + key + "\"") + "\n";
+  }
+  Shards shards;
+  EXPECT_EQ(1000u, split_csv(input, shards, csvio::HASH, 4, 1, {"key"}));
+  ASSERT_EQ(4u, shards.streams.size());
+
+  std::set<std::string> seen;
+  std::size_t lines{0};
+  for (std::size_t shard = 0; shard < 4; shard++) {
+    std::istringstream instream(shards[shard]);
+    csvio::util::CSVLineReader csv_lr(instream);
+    csvio::CSVReader<> reader(csv_lr, ',', true);
+    std::set<std::string> keys;
+    while (reader.good()) {
+      const auto& row = reader.read();
+      if (row.size() != 2) { continue; }
+      keys.insert(row[1]);
+      lines++;
+    }
+    for (const auto& key : keys) { EXPECT_TRUE(seen.insert(key).second) << key; }
+  }
+  EXPECT_EQ(1000u, lines);
+  EXPECT_EQ(37u, seen.size());
+}
+
+TEST(CSVSplitterTest, ThreadsMatchSingleThread) {
+  std::mt19937 random(9);
+  std::string input{"id,key\n"};
+  for (int i = 0; i < 30000; i++) {
+    input += std::to_string(i) + ",\"k\n" + std::to_string(random() % 101) + "\"\n";
+  }
+  for (const auto mode : {csvio::HASH, csvio::ROUND_ROBIN, csvio::ROW_LIMIT}) {
+    Shards expected;
+    Shards threaded;
+    split_csv(input, expected, mode, 7, 1, {"key"});
+    split_csv<csvio::util::CSVBufferedLineWriter>(input, threaded, mode, 7, 4, {"key"});
+    ASSERT_EQ(expected.streams.size(), threaded.streams.size());
+    for (std::size_t shard = 0; shard < expected.streams.size(); shard++) {
+      EXPECT_EQ(expected[shard], threaded[shard]) << mode << " " << shard;
+    }
+  }
+}
+
+// LineWriter which throws once it is asked to write a row after the header
+class FailingLineWriter {
+public:
+  explicit FailingLineWriter(std::ostream& outstream) : m_csv_line_writer(outstream) {}
+  void writeline(csvio::string_view line) {
+    if (lcount() != 0) { throw std::runtime_error("disk full"); }
+    m_csv_line_writer.writeline(line);
+  }
+  bool good() { return m_csv_line_writer.good(); }
+  [[nodiscard]] std::size_t lcount() const { return m_csv_line_writer.lcount(); }
+
+private:
+  csvio::util::CSVLineWriter m_csv_line_writer;
+};
+
+std::string numbered_rows(int rows) {
+  std::string input{"id\n"};
+  for (int i = 0; i < rows; i++) { input += std::to_string(i) + "\n"; }
+  return input;
+}
+
+TEST(CSVSplitterTest, WriterFactoryErrorIsRethrown) {
+  const std::string input = numbered_rows(50000);
+  for (unsigned threads : {1u, 4u}) {
+    std::istringstream instream(input);
+    csvio::util::CSVLineReader csv_lr(instream);
+    std::vector<std::unique_ptr<std::ostringstream>> streams;
+    csvio::CSVSplitter<> splitter(
+        csv_lr,
+        [&streams](std::size_t shard) {
+          if (shard == 3) { throw std::runtime_error("too many open files"); }
+          streams.push_back(std::make_unique<std::ostringstream>());
+          return std::make_unique<csvio::util::CSVLineWriter>(*streams.back());
+        },
+        csvio::ROW_LIMIT, 5000, ',', true, true, "\n");
+    splitter.set_threads(threads);
+    EXPECT_THROW(splitter.run(), std::runtime_error);
+    EXPECT_EQ(3u, splitter.shards());
+  }
+}
+
+TEST(CSVSplitterTest, LineWriterErrorIsRethrown) {
+  const std::string input = numbered_rows(50000);
+  std::istringstream instream(input);
+  csvio::util::CSVLineReader csv_lr(instream);
+  std::vector<std::unique_ptr<std::ostringstream>> streams;
+  csvio::CSVSplitter<csvio::util::CSVLineReader, FailingLineWriter> splitter(
+      csv_lr,
+      [&streams](std::size_t) {
+        streams.push_back(std::make_unique<std::ostringstream>());
+        return std::make_unique<FailingLineWriter>(*streams.back());
+      },
+      csvio::HASH, 4, ',', true, true, "\n");
+  splitter.add_key("id");
+  splitter.set_threads(4);
+  EXPECT_THROW(splitter.run(), std::runtime_error);
+}
+
+}  // namespace
@@ -0,0 +1,176 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Matthew Guidry
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <list>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "csvio/csvio.hpp"
+#include "gtest/gtest.h"
+
+namespace {
+
+struct Person {
+  int id{0};
+  std::string first_name;
+  double age{0.0};
+  bool active{false};
+};
+
+}  // namespace
+
+template <>
+struct csvio::StructBinding<Person> {
+  static constexpr auto columns = std::make_tuple(
+      csvio::column("id", &Person::id), csvio::column("first_name", &Person::first_name),
+      csvio::column("age", &Person::age), csvio::column("active", &Person::active));
+};
+
+namespace {
+
+TEST(CSVStructBindingTest, WriteStructs) {
+  std::ostringstream outstream;
+  csvio::util::CSVLineWriter csv_lw(outstream);
+  csvio::CSVWriter csv_writer(csv_lw);
+
+  const std::vector<Person> people{{1, "Ann", 31.5, true}, {2, "O,Brien", 40, false}};
+  csv_writer.write_struct_header<Person>();
+  csv_writer.write_structs(people);
+
+  EXPECT_EQ("id,first_name,age,active\r\n1,Ann,31.5,true\r\n2,\"O,Brien\",40,false\r\n",
+            outstream.str());
+  EXPECT_EQ(3u, csv_writer.lcount());
+}
+
+TEST(CSVStructBindingTest, WriteStructsWithColumnEscapePolicy) {
+  std::ostringstream outstream;
+  csvio::util::CSVLineWriter csv_lw(outstream);
+  csvio::CSVWriter csv_writer(csv_lw);
+  csv_writer.set_column_escape(
+      {csvio::util::NEVER, csvio::util::ALWAYS, csvio::util::SCAN, csvio::util::ALWAYS});
+
+  csv_writer.write_struct_header<Person>();
+  csv_writer.write_struct(Person{1, "O,Brien", 40, false});
+
+  EXPECT_EQ("id,\"first_name\",age,\"active\"\r\n1,\"O,Brien\",40,\"false\"\r\n",
+            outstream.str());
+}
+
+TEST(CSVStructBindingTest, WriteStructHeaderWithColumnEscapePolicy) {
+  std::ostringstream outstream;
+  csvio::util::CSVLineWriter csv_lw(outstream);
+  csvio::CSVWriter csv_writer(csv_lw, ';');
+  csv_writer.set_column_escape({csvio::util::ALWAYS, csvio::util::NEVER});
+
+  csv_writer.write_struct_header<Person>();
+  EXPECT_EQ("\"id\";first_name;age;active\r\n", outstream.str());
+}
+
+TEST(CSVStructBindingTest, ReadByHeaderName) {
+  std::istringstream instream(
+      "active,age,first_name,id,extra\n"
+      "true,31.5,Ann,1,x\n"
+      "false,40,\"O,Brien\",2,y\n");
+  csvio::util::CSVLineReader csv_lr(instream);
+  csvio::CSVReader csv_reader(csv_lr, ',', true);
+
+  const auto people = csv_reader.read_structs<Person>();
+  ASSERT_EQ(2u, people.size());
+  EXPECT_EQ(1, people[0].id);
+  EXPECT_EQ("Ann", people[0].first_name);
+  EXPECT_DOUBLE_EQ(31.5, people[0].age);
+  EXPECT_TRUE(people[0].active);
+  EXPECT_EQ(2, people[1].id);
+  EXPECT_EQ("O,Brien", people[1].first_name);
+  EXPECT_DOUBLE_EQ(40.0, people[1].age);
+  EXPECT_FALSE(people[1].active);
+}
+
+TEST(CSVStructBindingTest, ReadPositionalList) {
+  std::istringstream instream("7,Bob,22,1\n8,Cid,,0\n");
+  csvio::util::CSVLineReader csv_lr(instream);
+  csvio::CSVReader<std::list> csv_reader(csv_lr, ',', false, false);
+
+  Person person;
+  ASSERT_TRUE(csv_reader.read_struct(person));
+  EXPECT_EQ(7, person.id);
+  EXPECT_EQ("Bob", person.first_name);
+  EXPECT_TRUE(person.active);
+
+  ASSERT_TRUE(csv_reader.read_struct(person));
+  EXPECT_EQ(8, person.id);
+  EXPECT_EQ("Cid", person.first_name);
+  EXPECT_DOUBLE_EQ(0.0, person.age);
+  EXPECT_FALSE(person.active);
+}
+
+TEST(CSVStructBindingTest, RoundTrip) {
+  std::ostringstream outstream;
+  csvio::util::CSVLineWriter csv_lw(outstream);
+  csvio::CSVWriter csv_writer(csv_lw);
+
+  std::vector<Person> people;
+  for (int i = 0; i < 50; ++i) {
+    people.push_back({i, "name \"" + std::to_string(i) + "\"", i * 0.25, i % 2 == 0});
+  }
+  csv_writer.write_struct_header<Person>();
+  csv_writer.write_structs(people);
+
+  std::istringstream instream(outstream.str());
+  csvio::util::CSVLineReader csv_lr(instream);
+  csvio::CSVReader csv_reader(csv_lr, ',', true);
+  const auto result = csv_reader.read_structs<Person>();
+
+  ASSERT_EQ(people.size(), result.size());
+  for (std::size_t i = 0; i < people.size(); ++i) {
+    EXPECT_EQ(people[i].id, result[i].id);
+    EXPECT_EQ(people[i].first_name, result[i].first_name);
+    EXPECT_DOUBLE_EQ(people[i].age, result[i].age);
+    EXPECT_EQ(people[i].active, result[i].active);
+  }
+}
+
+TEST(CSVStructBindingTest, ParseField) {
+  int i{0};
+  EXPECT_TRUE(csvio::util::parse_field("-12", i));
+  EXPECT_EQ(-12, i);
+  EXPECT_FALSE(csvio::util::parse_field("12a", i));
+
+  unsigned char u{0};
+  EXPECT_FALSE(csvio::util::parse_field("300", u));
+
+  bool b{false};
+  EXPECT_TRUE(csvio::util::parse_field("1", b));
+  EXPECT_TRUE(b);
+  EXPECT_FALSE(csvio::util::parse_field("yes", b));
+
+  char c{0};
+  EXPECT_TRUE(csvio::util::parse_field("z", c));
+  EXPECT_EQ('z', c);
+}
+
+}  // namespace
@@ -0,0 +1,121 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Matthew Guidry
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "csvio/csvio.hpp"
+#include "gtest/gtest.h"
+
+namespace {
+
+std::string transform_all(const std::string& input,
+                          const std::function<void(csvio::CSVTransform<>&)>& setup) {
+  std::istringstream instream(input);
+  std::ostringstream outstream;
+  csvio::util::CSVLineReader csv_lr(instream);
+  csvio::util::CSVLineWriter csv_lw(outstream);
+  csvio::CSVTransform<> transform(csv_lr, csv_lw);
+  setup(transform);
+  transform.run();
+  return outstream.str();
+}
+
+TEST(CSVTransformTest, PassthroughKeepsRawFields) {
+  const std::string input{"a,b,c\r\n1,\"x,y\",\"say \"\"hi\"\"\"\r\n2,z,\r\n"};
+  EXPECT_EQ(input, transform_all(input, [](auto&) {}));
+}
+
+TEST(CSVTransformTest, SelectReorderAndRename) {
+  const std::string input{"id,name,price\n1,\"Smith, J\",2.5\n2,Doe,3\n"};
+  const auto output = transform_all(input, [](auto& transform) {
+    transform.add_column("price");
+    transform.add_column("id", "key");
+  });
+  EXPECT_EQ("price,key\r\n2.5,1\r\n3,2\r\n", output);
+}
+
+TEST(CSVTransformTest, RenameWithoutSelect) {
+  const std::string input{"id,name\n1,a\n"};
+  const auto output =
+      transform_all(input, [](auto& transform) { transform.rename_column("name", "label"); });
+  EXPECT_EQ("id,label\r\n1,a\r\n", output);
+}
+
+TEST(CSVTransformTest, ConstantColumns) {
+  const std::string input{"id\n1\n\n2\n"};
+  const auto output = transform_all(input, [](auto& transform) {
+    transform.add_column("id");
+    transform.add_constant("source", "batch,7");
+  });
+  EXPECT_EQ("id,source\r\n1,\"batch,7\"\r\n2,\"batch,7\"\r\n", output);
+}
+
+TEST(CSVTransformTest, DelimiterConversionQuotesOnlyWhenNeeded) {
+  const std::string input{"a,b\n\"1,5\",x;y\n2,\"q\"\"\"\n"};
+  const auto output =
+      transform_all(input, [](auto& transform) { transform.set_output_delimiter(';'); });
+  EXPECT_EQ("a;b\r\n\"1,5\";\"x;y\"\r\n2;\"q\"\"\"\r\n", output);
+}
+
+TEST(CSVTransformTest, OutputReadsBackAsInput) {
+  std::ifstream infile("data/test_data.csv");
+  std::ostringstream outstream;
+  csvio::util::CSVLineReader csv_lr(infile);
+  csvio::util::CSVLineWriter csv_lw(outstream);
+  csvio::CSVTransform<> transform(csv_lr, csv_lw);
+  transform.set_output_delimiter('\t');
+  transform.add_column(4);
+  transform.add_column(1);
+  EXPECT_EQ(100u, transform.run());
+
+  std::istringstream instream(outstream.str());
+  csvio::util::CSVLineReader out_lr(instream);
+  csvio::CSVReader<> out_reader(out_lr, '\t', true);
+  std::vector<std::string> row;
+  while (out_reader.good()) { row = out_reader.read(); }
+  EXPECT_EQ((std::vector<std::string>{"YELLOW", "Henry"}), row);
+  EXPECT_EQ(101u, csv_lw.lcount());
+}
+
+TEST(CSVTransformTest, BufferedLineWriter) {
+  std::istringstream instream("a,b\n1,2\n3,4\n");
+  std::ostringstream outstream;
+  {
+    csvio::util::CSVLineReader csv_lr(instream);
+    csvio::util::CSVBufferedLineWriter csv_lw(outstream);
+    csvio::CSVTransform<csvio::util::CSVLineReader, csvio::util::CSVBufferedLineWriter> transform(
+        csv_lr, csv_lw, ',', true, true, "\n");
+    transform.add_column("b");
+    EXPECT_EQ(2u, transform.run());
+    EXPECT_EQ(3u, transform.lcount());
+  }
+  EXPECT_EQ("b\n2\n4\n", outstream.str());
+}
+
+}  // namespace
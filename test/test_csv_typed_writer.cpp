@@ -0,0 +1,93 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Matthew Guidry
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <cstdint>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <tuple>
+
+#include "csvio/csvio.hpp"
+#include "gtest/gtest.h"
+
+namespace {
+
+TEST(CSVTypedWriterTest, WriteVariadic) {
+  std::ostringstream outstream;
+  csvio::util::CSVLineWriter csv_lw(outstream);
+  csvio::CSVTypedWriter csv_writer(csv_lw);
+
+  csv_writer.write(42, -7LL, 1.5, true, std::string_view{"a,b"}, "plain", 'c');
+  EXPECT_EQ("42,-7,1.5,true,\"a,b\",plain,c\r\n", outstream.str());
+  EXPECT_EQ(1u, csv_writer.lcount());
+}
+
+TEST(CSVTypedWriterTest, WriteTuple) {
+  std::ostringstream outstream;
+  csvio::util::CSVLineWriter csv_lw(outstream);
+  csvio::CSVTypedWriter csv_writer(csv_lw);
+
+  csv_writer.write_header("id", "name");
+  csv_writer.write(std::make_tuple(std::uint8_t{7}, std::string{"x\"y"}));
+  csv_writer.write(std::make_pair(8, false));
+
+  EXPECT_EQ("id,name\r\n7,\"x\"\"y\"\r\n8,false\r\n", outstream.str());
+}
+
+TEST(CSVTypedWriterTest, DoublesRoundTrip) {
+  std::ostringstream outstream;
+  csvio::util::CSVLineWriter csv_lw(outstream);
+  csvio::CSVTypedWriter csv_writer(csv_lw, ',', true, "\n");
+
+  csv_writer.write(0.1, 1e300, std::numeric_limits<double>::max(), 0.30000000000000004);
+  EXPECT_EQ("0.1,1e+300,1.7976931348623157e+308,0.30000000000000004\n", outstream.str());
+}
+
+TEST(CSVTypedWriterTest, NumbersEscapedForNumericDelimiter) {
+  std::ostringstream outstream;
+  csvio::util::CSVLineWriter csv_lw(outstream);
+  csvio::CSVTypedWriter csv_writer(csv_lw, '.', true, "\n");
+
+  csv_writer.write(1.5, 2, "a");
+  EXPECT_EQ("\"1.5\".2.a\n", outstream.str());
+}
+
+TEST(CSVTypedWriterTest, RoundTripThroughReader) {
+  std::ostringstream outstream;
+  csvio::util::CSVLineWriter csv_lw(outstream);
+  csvio::CSVTypedWriter csv_writer(csv_lw, '|');
+
+  csv_writer.write(-1, 2.25, "a|b", "c\nd");
+
+  std::istringstream instream(outstream.str());
+  csvio::util::CSVLineReader csv_lr(instream);
+  csvio::CSVReader csv_reader(csv_lr, '|');
+
+  std::vector<std::string> expected{"-1", "2.25", "a|b", "c\nd"};
+  EXPECT_EQ(expected, csv_reader.read());
+}
+
+}  // namespace
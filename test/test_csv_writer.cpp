@@ -23,9 +23,14 @@
  *
  */
 
+#include <array>
+#include <cstdint>
 #include <iostream>
+#include <list>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "csvio/csvio.hpp"
@@ -63,4 +68,230 @@ TEST(CSVWriterTest, WriteVectorOfQuotedSampleStrings) {
   EXPECT_EQ(true, csv_writer.good());
 }
 
-}  // namespace
\ No newline at end of file
+TEST(CSVWriterTest, WriteAllParallelMatchesSequential) {
+  std::vector<std::vector<std::string>> rows;
+  for (int i = 0; i < 1000; i++) {
+    rows.push_back({std::to_string(i), "text, with \"quotes\"", i % 7 == 0 ? "" : "x"});
+  }
+
+  std::ostringstream expected_stream;
+  csvio::util::CSVLineWriter expected_lw(expected_stream);
+  csvio::CSVWriter<std::vector> expected_writer(expected_lw);
+  for (const auto& row : rows) { expected_writer.write(row); }
+
+  for (unsigned threads : {1u, 2u, 3u, 8u}) {
+    std::ostringstream outstream;
+    csvio::util::CSVLineWriter csv_lw(outstream);
+    csvio::CSVWriter<std::vector> csv_writer(csv_lw);
+    csv_writer.write_all(rows, threads, 37);
+    EXPECT_EQ(expected_stream.str(), outstream.str());
+    EXPECT_EQ(rows.size(), csv_writer.lcount());
+  }
+}
+
+// formats rows like the default formatter but throws on a row starting with "bad"
+struct ThrowingFormat {
+  std::string operator()(const std::vector<std::string>& row, const char delim,
+                         const std::string& terminator) {
+    if (!row.empty() && row[0] == "bad") { throw std::runtime_error("bad row"); }
+    return csvio::util::DelimJoinEscapedFormat<std::vector>{}(row, delim, terminator);
+  }
+};
+
+// LineWriter which throws once a number of lines has been written
+class FailingLineWriter {
+public:
+  explicit FailingLineWriter(std::size_t limit) : m_limit(limit) {}
+  void writeline(csvio::string_view) {
+    if (m_lines == m_limit) { throw std::runtime_error("disk full"); }
+    m_lines++;
+  }
+  bool good() { return true; }
+  [[nodiscard]] std::size_t lcount() const { return m_lines; }
+
+private:
+  std::size_t m_limit;
+  std::size_t m_lines{0};
+};
+
+TEST(CSVWriterTest, WriteAllParallelRethrowsFormatterError) {
+  std::vector<std::vector<std::string>> rows;
+  for (int i = 0; i < 1000; i++) { rows.push_back({i == 700 ? "bad" : std::to_string(i)}); }
+
+  std::ostringstream outstream;
+  csvio::util::CSVLineWriter csv_lw(outstream);
+  csvio::CSVWriter<std::vector, csvio::util::CSVLineWriter, ThrowingFormat> csv_writer(csv_lw);
+  EXPECT_THROW(csv_writer.write_all(rows, 4, 16), std::runtime_error);
+  EXPECT_LT(csv_writer.lcount(), 700u);
+}
+
+TEST(CSVWriterTest, WriteAllParallelRethrowsLineWriterError) {
+  std::vector<std::vector<std::string>> rows;
+  for (int i = 0; i < 1000; i++) { rows.push_back({std::to_string(i)}); }
+
+  FailingLineWriter line_writer(100);
+  csvio::CSVWriter<std::vector, FailingLineWriter> csv_writer(line_writer);
+  EXPECT_THROW(csv_writer.write_all(rows, 4, 16), std::runtime_error);
+  EXPECT_EQ(100u, csv_writer.lcount());
+}
+
+TEST(CSVWriterTest, WriteAllSequentialRange) {
+  const std::list<std::vector<std::string>> rows{{"a", "b"}, {}, {"c", "d"}};
+  std::ostringstream outstream;
+  csvio::util::CSVLineWriter csv_lw(outstream);
+  csvio::CSVWriter<std::vector> csv_writer(csv_lw);
+
+  csv_writer.write_all(rows, 4);
+  EXPECT_EQ("a,b\r\nc,d\r\n", outstream.str());
+  EXPECT_EQ(2u, csv_writer.lcount());
+}
+
+TEST(CSVWriterTest, WriteColumns) {
+  const std::vector<int> ids{1, 2, 3};
+  const double prices[]{1.5, -2.0, 1e-7};
+  const std::vector<std::string> names{"a", "b,c", "d\"e"};
+  const char data[] = "xyyzzz";
+  const std::uint32_t offsets[]{0, 1, 3, 6};
+  const std::vector<bool> flags{true, false, true};
+
+  std::ostringstream outstream;
+  csvio::util::CSVLineWriter csv_lw(outstream);
+  csvio::CSVWriter<std::vector> csv_writer(csv_lw);
+  csv_writer.write_header({"id", "price", "name", "code", "flag"});
+  csv_writer.write_columns(3, ids, prices, names, csvio::util::StringColumn<>(data, offsets),
+                           flags);
+
+  EXPECT_EQ(
+      "id,price,name,code,flag\r\n"
+      "1,1.5,a,x,true\r\n"
+      "2,-2,\"b,c\",yy,false\r\n"
+      "3,1e-07,\"d\"\"e\",zzz,true\r\n",
+      outstream.str());
+  EXPECT_EQ(4u, csv_writer.lcount());
+}
+
+TEST(CSVWriterTest, WriteColumnsMatchesRows) {
+  const std::vector<double> values{0.25, 1234.5, -0.125};
+  const std::vector<long> counts{10, 20, 30};
+
+  std::ostringstream column_stream;
+  csvio::util::CSVLineWriter column_lw(column_stream);
+  csvio::CSVWriter<std::vector> column_writer(column_lw, ';');
+  column_writer.write_columns(values.size(), values, counts);
+
+  std::ostringstream row_stream;
+  csvio::util::CSVLineWriter row_lw(row_stream);
+  csvio::CSVWriter<std::vector> row_writer(row_lw, ';');
+  row_writer.write({"0.25", "10"});
+  row_writer.write({"1234.5", "20"});
+  row_writer.write({"-0.125", "30"});
+
+  EXPECT_EQ(row_stream.str(), column_stream.str());
+}
+
+TEST(CSVWriterTest, WriteStringLikeRows) {
+  const std::string owned{"x\"y"};
+  const std::vector<std::string_view> views{"a", "b,c", owned};
+  const std::array<const char*, 3> pointers{"1", "2", "3"};
+
+  std::ostringstream outstream;
+  csvio::util::CSVLineWriter csv_lw(outstream);
+  csvio::CSVWriter<std::vector> csv_writer(csv_lw);
+  csv_writer.write(views);
+  csv_writer.write(pointers);
+  csv_writer.write({std::string_view("d"), std::string_view("e"), std::string_view("f")});
+
+  EXPECT_EQ("a,\"b,c\",\"x\"\"y\"\r\n1,2,3\r\nd,e,f\r\n", outstream.str());
+  EXPECT_EQ(3u, csv_writer.lcount());
+}
+
+TEST(CSVWriterTest, WriteBatchMatchesWrite) {
+  std::vector<std::array<std::string_view, 3>> rows;
+  for (int i = 0; i < 10000; i++) { rows.push_back({"left", i % 3 ? "mid" : "m,d", "right"}); }
+
+  std::ostringstream batch_stream;
+  csvio::util::CSVLineWriter batch_lw(batch_stream);
+  csvio::CSVWriter<std::vector> batch_writer(batch_lw);
+  batch_writer.write_header({"a", "b", "c"});
+  batch_writer.write_batch(rows);
+
+  std::ostringstream row_stream;
+  csvio::util::CSVLineWriter row_lw(row_stream);
+  csvio::CSVWriter<std::vector> row_writer(row_lw);
+  row_writer.write_header({"a", "b", "c"});
+  for (const auto& row : rows) { row_writer.write(row); }
+
+  EXPECT_EQ(row_stream.str(), batch_stream.str());
+  EXPECT_EQ(10001u, batch_writer.lcount());
+}
+
+TEST(CSVWriterTest, WriteBatchBufferedLineWriter) {
+  const std::vector<std::vector<std::string>> rows{{"a", "b"}, {}, {"c", "d"}, {"e", "f"}};
+
+  std::ostringstream outstream;
+  {
+    csvio::util::CSVBufferedLineWriter csv_lw(outstream);
+    csvio::CSVWriter<std::vector, csvio::util::CSVBufferedLineWriter> csv_writer(csv_lw);
+    csv_writer.write_batch(rows);
+    EXPECT_EQ(3u, csv_writer.lcount());
+  }
+
+  EXPECT_EQ("a,b\r\nc,d\r\ne,f\r\n", outstream.str());
+}
+
+TEST(CSVWriterTest, WriteBatchWarnsOnce) {
+  const std::vector<std::vector<std::string_view>> rows{{"a", "b"}, {"c"}, {"d"}, {"e", "f"}};
+
+  std::ostringstream outstream;
+  csvio::util::CSVLineWriter csv_lw(outstream);
+  csvio::CSVWriter<std::vector> csv_writer(csv_lw);
+
+  testing::internal::CaptureStderr();
+  csv_writer.write_batch(rows);
+  const std::string warnings = testing::internal::GetCapturedStderr();
+
+  EXPECT_EQ("[Warning] Column mismatch detected\n", warnings);
+  EXPECT_EQ("a,b\r\nc\r\nd\r\ne,f\r\n", outstream.str());
+}
+
+TEST(CSVWriterTest, WriteWithColumnEscapePolicy) {
+  std::ostringstream outstream;
+  csvio::util::CSVLineWriter csv_lw(outstream);
+  csvio::CSVWriter<std::vector> csv_writer(csv_lw);
+  csv_writer.set_column_escape({csvio::util::NEVER, csvio::util::SCAN});
+  csv_writer.write({"12", "x,y"});
+  csv_writer.write({"34", "z"});
+
+  EXPECT_EQ("12,\"x,y\"\r\n34,z\r\n", outstream.str());
+}
+
+TEST(CSVWriterTest, WriteAllParallelKeepsColumnEscapePolicy) {
+  std::vector<std::vector<std::string>> rows;
+  for (int i = 0; i < 1000; i++) { rows.push_back({std::to_string(i), "v"}); }
+
+  std::ostringstream outstream;
+  csvio::util::CSVLineWriter csv_lw(outstream);
+  csvio::CSVWriter<std::vector> csv_writer(csv_lw);
+  csv_writer.set_column_escape({csvio::util::NEVER, csvio::util::ALWAYS});
+  csv_writer.write_all(rows, 4, 64);
+
+  const std::string out = outstream.str();
+  EXPECT_EQ(0u, out.find("0,\"v\"\r\n1,\"v\"\r\n"));
+  EXPECT_EQ(rows.size(), csv_writer.lcount());
+}
+
+TEST(CSVWriterTest, WriteColumnsWithColumnEscapePolicy) {
+  const std::vector<int> ids{1, 2};
+  const std::vector<std::string> names{"a", "b,c"};
+  const std::vector<std::string> trusted{"x,y", "z"};
+
+  std::ostringstream outstream;
+  csvio::util::CSVLineWriter csv_lw(outstream);
+  csvio::CSVWriter<std::vector> csv_writer(csv_lw);
+  csv_writer.set_column_escape({csvio::util::ALWAYS, csvio::util::SCAN, csvio::util::NEVER});
+  csv_writer.write_columns(2, ids, names, trusted);
+
+  EXPECT_EQ("\"1\",a,x,y\r\n\"2\",\"b,c\",z\r\n", outstream.str());
+}
+
+}  // namespace
@@ -65,6 +65,50 @@ TEST(EscapeTest, EscapeStringForceEscape) {
   EXPECT_EQ("\"somevalue\"", csvio::util::escape(to_escape, ',', true));
 }
 
+TEST(EscapeTest, EscapeAppendPlainField) {
+  std::string out{"x,"};
+  csvio::util::escape_append(out, "somevalue");
+  EXPECT_EQ("x,somevalue", out);
+}
+
+TEST(EscapeTest, EscapeAppendQuotedField) {
+  std::string out{"x,"};
+  csvio::util::escape_append(out, "some\"value\"");
+  EXPECT_EQ("x,\"some\"\"value\"\"\"", out);
+}
+
+TEST(EscapeTest, EscapeAppendForceEscape) {
+  std::string out;
+  csvio::util::escape_append(out, "", ',', true);
+  EXPECT_EQ("\"\"", out);
+}
+
+TEST(EscapeTest, EscapeLongFieldsEverySpecialPosition) {
+  for (std::size_t length = 1; length < 70; length++) {
+    for (char special : {'\"', '\r', '\n', '|'}) {
+      for (std::size_t pos = 0; pos < length; pos++) {
+        std::string field(length, 'a');
+        field[pos] = special;
+
+        std::string expected{"\""};
+        for (char c : field) {
+          if (c == '\"') { expected.push_back('\"'); }
+          expected.push_back(c);
+        }
+        expected.push_back('\"');
+
+        EXPECT_EQ(expected, csvio::util::escape(field, '|'));
+      }
+    }
+    EXPECT_EQ(std::string(length, 'a'), csvio::util::escape(std::string(length, 'a'), '|'));
+  }
+}
+
+TEST(EscapeTest, EscapeAltDelimiterIgnoresComma) {
+  std::string to_escape{"some,value"};
+  EXPECT_EQ("some,value", csvio::util::escape(to_escape, '|'));
+}
+
 }  // namespace
 
 int main(int argc, char** argv) {
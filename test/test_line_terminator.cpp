@@ -0,0 +1,173 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Matthew Guidry
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "csvio/csvio.hpp"
+#include "gtest/gtest.h"
+
+namespace {
+
+/** ByteSource handing out a single byte per read, forces terminators across block boundaries */
+class OneByteSource {
+public:
+  explicit OneByteSource(std::string data) : m_data(std::move(data)) {}
+
+  std::size_t read(char* dest, std::size_t count) {
+    if (count == 0 || m_pos == m_data.size()) { return 0; }
+    *dest = m_data[m_pos++];
+    return 1;
+  }
+
+private:
+  std::string m_data;
+  std::size_t m_pos{0};
+};
+
+template <typename LineReader>
+std::vector<std::string> read_all(LineReader& reader) {
+  std::vector<std::string> lines;
+  while (reader.good()) { lines.push_back(reader.readline()); }
+  return lines;
+}
+
+std::size_t find_offset(const std::string& data, const std::string& seq) {
+  return static_cast<std::size_t>(
+      csvio::util::find_sequence(data.data(), data.data() + data.size(), seq) - data.data());
+}
+
+TEST(LineTerminatorTest, FindSequence) {
+  std::string data(100, 'a');
+  EXPECT_EQ(100u, find_offset(data, "\x01"));
+  EXPECT_EQ(100u, find_offset(data, "\r\n"));
+
+  data[40] = '\r';
+  EXPECT_EQ(100u, find_offset(data, "\r\n"));
+  data[41] = '\n';
+  EXPECT_EQ(40u, find_offset(data, "\r\n"));
+  EXPECT_EQ(40u, find_offset(data, "\r"));
+
+  data[15] = '\r';
+  data[16] = '\n';
+  EXPECT_EQ(15u, find_offset(data, "\r\n"));
+
+  data[97] = 'x';
+  data[98] = 'y';
+  data[99] = 'z';
+  EXPECT_EQ(97u, find_offset(data, "xyz"));
+  EXPECT_EQ(100u, find_offset(data, "xyzz"));
+  EXPECT_EQ(0u, find_offset(std::string("ab"), "ab"));
+  EXPECT_EQ(1u, find_offset(std::string("a"), "ab"));
+}
+
+TEST(LineTerminatorTest, SimpleReaderSOH) {
+  std::istringstream data("1,2\x01" "3,4\x01" "5,6");
+  csvio::util::CSVSimpleLineReader csv_lr(data);
+  csv_lr.set_line_terminator("\x01");
+
+  std::vector<std::string> expected{"1,2", "3,4", "5,6"};
+  EXPECT_EQ(expected, read_all(csv_lr));
+  EXPECT_EQ("\x01", csv_lr.get_line_terminator());
+}
+
+TEST(LineTerminatorTest, SimpleReaderMultiByteKeep) {
+  std::istringstream data("1,2\x01\n3\n,4\x01\n");
+  csvio::util::CSVSimpleLineReader csv_lr(data);
+  csv_lr.set_line_terminator("\x01\n", true);
+
+  std::vector<std::string> expected{"1,2\x01\n", "3\n,4\x01\n"};
+  EXPECT_EQ(expected, read_all(csv_lr));
+}
+
+TEST(LineTerminatorTest, ConformingReaderSOHWithQuotes) {
+  std::istringstream data("1,\"a\x01" "b\"\x01" "3,4\x01");
+  csvio::util::CSVLineReader csv_lr(data);
+  csv_lr.set_line_terminator("\x01");
+
+  std::vector<std::string> expected{"1,\"a\x01" "b\"", "3,4"};
+  EXPECT_EQ(expected, read_all(csv_lr));
+}
+
+TEST(LineTerminatorTest, HybridReaderSOHWithQuotes) {
+  std::istringstream data("1,\"a\x01" "b\"\x01" "3,4\x01");
+  csvio::util::CSVHybridLineReader csv_lr(data);
+  csv_lr.set_line_terminator("\x01");
+
+  std::vector<std::string> expected{"1,\"a\x01" "b\"", "3,4"};
+  EXPECT_EQ(expected, read_all(csv_lr));
+}
+
+TEST(LineTerminatorTest, DefaultsMatchIStreamBehaviour) {
+  std::istringstream simple_data("a\r\nb\r\n");
+  std::istringstream conforming_data("a\r\nb\r\n");
+  csvio::util::CSVSimpleLineReader simple(simple_data);
+  csvio::util::CSVLineReader conforming(conforming_data);
+
+  EXPECT_EQ("\n", simple.get_line_terminator());
+  EXPECT_EQ((std::vector<std::string>{"a\r", "b\r"}), read_all(simple));
+  EXPECT_EQ((std::vector<std::string>{"a\r\n", "b\r\n"}), read_all(conforming));
+}
+
+TEST(LineTerminatorTest, CRLFAcrossBlocks) {
+  const std::string data{"1,\"x\r\ny\"\r\n2,3\r\n\r4\r\n"};
+  std::vector<std::string> expected{"1,\"x\r\ny\"", "2,3", "\r4"};
+
+  csvio::util::BasicCSVLineReader<OneByteSource> conforming(data);
+  conforming.set_line_terminator("\r\n");
+  EXPECT_EQ(expected, read_all(conforming));
+
+  csvio::util::BasicCSVHybridLineReader<OneByteSource> hybrid(data);
+  hybrid.set_line_terminator("\r\n");
+  EXPECT_EQ(expected, read_all(hybrid));
+
+  csvio::util::BasicCSVSimpleLineReader<OneByteSource> simple(std::string{"1,2\r\n3\r4\r\r\n5"});
+  simple.set_line_terminator("\r\n");
+  EXPECT_EQ((std::vector<std::string>{"1,2", "3\r4\r", "5"}), read_all(simple));
+}
+
+TEST(LineTerminatorTest, KeepAcrossBlocks) {
+  csvio::util::BasicCSVHybridLineReader<OneByteSource> hybrid(std::string{"ab\x01\ncd\x01\n"});
+  hybrid.set_line_terminator("\x01\n", true);
+
+  std::vector<std::string> expected{"ab\x01\n", "cd\x01\n"};
+  EXPECT_EQ(expected, read_all(hybrid));
+}
+
+TEST(LineTerminatorTest, CSVReaderWithSOH) {
+  std::istringstream data("a,b,c\x01" "1,\"2,\x01\",3\x01");
+  csvio::util::CSVHybridLineReader csv_lr(data);
+  csv_lr.set_line_terminator("\x01");
+  csvio::CSVReader csv_reader(csv_lr, ',', true);
+
+  std::vector<std::string> expected_header{"a", "b", "c"};
+  std::vector<std::string> expected{"1", "2,\x01", "3"};
+  EXPECT_EQ(expected_header, csv_reader.get_header_names());
+  EXPECT_EQ(expected, csv_reader.read());
+  EXPECT_EQ(false, csv_reader.good());
+}
+
+}  // namespace